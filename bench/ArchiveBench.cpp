@@ -0,0 +1,62 @@
+#include "Benchmark.h"
+#include "Network.h"
+#include "SpikeArchive.h"
+#include <cstdio>
+#include <unistd.h>
+
+BENCHMARK(archive) {
+	const size_t size = 5000, steps = 2000;
+	Network net(size, "", 0.2, 30, "small-world", 4);
+	std::vector<std::vector<size_t>> spikes;
+	size_t count(0);
+	for (size_t t(0); t<steps; ++t) {
+		spikes.push_back(net.update());
+		count += spikes.back().size();
+	}
+	std::string text = "/tmp/nn_raster_bench_" + std::to_string(getpid()), path = text + ".archive";
+
+	Timer timer;																// the raster of outfile.txt, as Simulation::write_raster
+	{
+		std::ofstream file(text);
+		std::vector<char> raster(2*size + 1, ' ');
+		for (size_t i(0); i<size; ++i) raster[2*i+1] = '0';
+		raster.back() = '\n';
+		for (size_t t(0); t<steps; ++t) {
+			for (const auto& n : spikes[t]) raster[2*n+1] = '1';
+			file << t + 1;
+			file.write(raster.data(), raster.size());
+			for (const auto& n : spikes[t]) raster[2*n+1] = '0';
+		}
+	}
+	double text_wall = timer.seconds();
+	double text_bytes = std::ifstream(text, std::ios::ate | std::ios::binary).tellg();
+
+	timer.restart();
+	{
+		SpikeArchive archive = SpikeArchive::create(path, size, _Archive_Block_);
+		for (size_t t(0); t<steps; ++t) archive.write(t + 1, spikes[t]);
+	}
+	double archive_wall = timer.seconds();
+	double archive_bytes = std::ifstream(path, std::ios::ate | std::ios::binary).tellg();
+
+	SpikeArchive archive = SpikeArchive::open(path);
+	size_t window(0);
+	timer.restart();
+	archive.read(steps/2, steps/2 + 99, [&window](const size_t&, const size_t&) { ++window; });
+	double window_wall = timer.seconds();
+	bench.record("small-world", {
+		{"neurons", (double)size},
+		{"steps", (double)steps},
+		{"spikes", (double)count},
+		{"text_bytes", text_bytes},
+		{"archive_bytes", archive_bytes},
+		{"compression_ratio", text_bytes/archive_bytes},
+		{"bytes_per_spike", archive_bytes/count},
+		{"text_megabytes_per_second", text_bytes/text_wall/1e6},
+		{"text_steps_per_second", steps/text_wall},
+		{"archive_steps_per_second", steps/archive_wall},
+		{"window_spikes", (double)window},
+		{"window_ms", 1e3*window_wall}});
+	std::remove(text.c_str());
+	std::remove(path.c_str());
+}
@@ -0,0 +1,35 @@
+#include "Benchmark.h"
+#include "Autotuner.h"
+
+BENCHMARK(autotune) {
+	struct Case {std::string label, types, model;
+				 double connectivity, intensity;};
+	const std::vector<Case> cases {
+		{"poisson_quiet",  "FS:0.2", "poisson",     100, 0.5},
+		{"poisson_active", "FS:0.2", "poisson",     100, 4},
+		{"small-world",    "FS:0.2", "small-world", 100, 4},
+		{"scale-free",     "FS:0.2", "scale-free",  100, 4}};
+	for (const auto& c : cases) {
+		Network net(20000, c.types, 0.1, c.connectivity, c.model, c.intensity);
+		net.update();
+		Autotuner tuner(4, {1e-9, 1e-9, 1e-9});
+		Timer timer;
+		Configuration chosen = tuner.tune(net);
+		double tuning = timer.seconds();
+		double chosen_step(0.0), spikes(0.0);
+		for (const auto& trial : tuner.get_trials()) {
+			if (trial.configuration.to_string() == chosen.to_string()) chosen_step = trial.seconds_per_step;
+			bench.record(c.label + " " + trial.configuration.to_string(), {
+				{"ms_per_step", 1000*trial.seconds_per_step},
+				{"steps", (double)trial.steps},
+				{"equivalent", trial.equivalent ? 1.0 : 0.0}});
+		}
+		for (int t(0); t<20; ++t) spikes += net.update().size();
+		bench.record(c.label + " chosen " + chosen.to_string(), {
+			{"neurons", (double)net.get_size()},
+			{"firing_fraction", spikes/20/net.get_size()},
+			{"candidates", (double)tuner.get_trials().size()},
+			{"tuning_seconds", tuning},
+			{"speedup", tuner.get_trials().front().seconds_per_step/chosen_step}});
+	}
+}
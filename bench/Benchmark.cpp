@@ -0,0 +1,67 @@
+#include "Benchmark.h"
+#include "Random.h"
+#include <cmath>
+#include <iostream>
+
+std::vector<std::pair<std::string, Benchmark::Function>>& Benchmark::registry()
+{
+	static std::vector<std::pair<std::string, Function>> benchmarks;
+	return benchmarks;
+}
+
+int Benchmark::add(const std::string& name, Function f)
+{
+	registry().push_back({name, f});
+	return (int)registry().size();
+}
+
+void Benchmark::record(const std::string& label, const Metrics& metrics)
+{
+	records.push_back({current, label, metrics});
+	std::cerr << current << " [" << label << "]";							// progress is reported on the error stream
+	for (const auto& m : metrics) std::cerr << " " << m.first << "=" << m.second;
+	std::cerr << std::endl;
+}
+
+Benchmark::Metrics Benchmark::metrics(const Counts& counts, const Counters& counters, const double& per)
+{
+	Metrics metrics {{"ms", 1e3*counts.seconds/per}};
+	if (not counters.available()) return metrics;						// wall time only, e.g. in a container
+	metrics.push_back({"cycles", counts.cycles/per});
+	metrics.push_back({"instructions", counts.instructions/per});
+	metrics.push_back({"ipc", counts.cycles ? (double)counts.instructions/counts.cycles : 0.0});
+	metrics.push_back({"llc_misses", counts.cache_misses/per});
+	metrics.push_back({"branch_misses", counts.branch_misses/per});
+	return metrics;
+}
+
+int Benchmark::run_all(int argc, char **argv)
+{
+	Benchmark bench;
+	for (const auto& b : registry()) {
+		bool selected = (argc < 2);
+		for (int k(1); k<argc; ++k) selected = selected or (b.first.compare(0, std::string(argv[k]).size(), argv[k]) == 0);
+		if (not selected) continue;
+		bench.current = b.first;
+		b.second(bench);
+	}
+
+	std::cout << "[" << std::endl;
+	for (size_t r(0); r<bench.records.size(); ++r) {
+		const Record& rec = bench.records[r];
+		std::cout << "  {\"benchmark\": \"" << rec.benchmark << "\", \"case\": \"" << rec.label << "\", \"metrics\": {";
+		for (size_t m(0); m<rec.metrics.size(); ++m) {
+			std::cout << (m ? ", " : "") << "\"" << rec.metrics[m].first << "\": ";
+			if (std::isfinite(rec.metrics[m].second)) std::cout << rec.metrics[m].second;
+			else std::cout << "null";											// JSON has no representation for inf and nan
+		}
+		std::cout << "}}" << (r+1 < bench.records.size() ? "," : "") << std::endl;
+	}
+	std::cout << "]" << std::endl;
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	_RNG = new RandomNumbers(23948710923);
+	return Benchmark::run_all(argc, argv);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Counters.h"
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*! \class Benchmark
+ * A small benchmark harness: each benchmark is a function registered with \ref BENCHMARK,
+ * which measures what it needs and reports it with \ref record.
+ *
+ * All the records are printed at the end as a JSON array, one object per record:
+ * {"benchmark": name, "case": label, "metrics": {key: value, ...}}.
+ *
+ * The executable runs every benchmark, or only those whose name starts with one of its arguments.
+ */
+
+class Benchmark {
+public:
+	typedef std::vector<std::pair<std::string, double>> Metrics;
+	typedef void (*Function)(Benchmark&);
+
+/*! @name Registering and running
+ */
+///@{
+/*!
+ * Adds the benchmark \p f to the list of benchmarks under the name \p name
+ */
+	static int add(const std::string& name, Function f);
+/*!
+ * Runs the selected benchmarks and prints their records on the standard output
+ */
+	static int run_all(int argc, char **argv);
+///@}
+
+/*! @name Reporting
+ */
+///@{
+/*!
+ * Stores the \p metrics measured for the case \p label of the running benchmark
+ */
+	void record(const std::string& label, const Metrics& metrics);
+/*!
+ * Metrics of \p counts divided by \p per (e.g. the number of steps): the time in ms, then the cycles, instructions,
+ * instructions per cycle, cache and branch misses if the \p counters are available
+ */
+	static Metrics metrics(const Counts& counts, const Counters& counters, const double& per = 1.0);
+///@}
+
+private:
+	struct Record {std::string benchmark, label;
+				   Metrics metrics;};
+	static std::vector<std::pair<std::string, Function>>& registry();
+
+	std::string current;
+	std::vector<Record> records;
+};
+
+/*! \class Timer
+ * Wall clock measuring the time elapsed since its construction or the last \ref restart.
+ */
+class Timer {
+public:
+	Timer() : start(std::chrono::steady_clock::now()) {}
+	void restart() { start = std::chrono::steady_clock::now(); }
+/*!
+ * Elapsed time in seconds
+ */
+	double seconds() const {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+private:
+	std::chrono::steady_clock::time_point start;
+};
+
+#define BENCHMARK(_name) static void _name(Benchmark&); \
+    static int _name##_registered = Benchmark::add(#_name, _name); \
+    static void _name(Benchmark &bench)
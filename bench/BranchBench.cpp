@@ -0,0 +1,66 @@
+#include "Benchmark.h"
+#include "Network.h"
+#include <fstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+/*!
+ * Memory written by this process since it was forked (kB): its private pages, the shared ones not counting
+ */
+double private_dirty()
+{
+	std::ifstream rollup("/proc/self/smaps_rollup");
+	std::string key;
+	double kb;
+	while (rollup >> key) {
+		if (key == "Private_Dirty:" and rollup >> kb) return kb;
+	}
+	return 0;
+}
+}
+
+BENCHMARK(branches) {
+	const size_t size = 20000, burn = 300, steps = 100, branches = 4;
+	Network net(size, "FS:0.2", 0.1, 100, "small-world", 4);
+	net.update();
+	Timer timer;
+	for (size_t t(0); t<burn; ++t) net.update();
+	double burn_wall = timer.seconds();
+
+	timer.restart();
+	std::vector<pid_t> children;
+	std::vector<int> pipes;
+	for (size_t k(0); k<branches; ++k) {
+		int ends[2];
+		if (pipe(ends) != 0) return;
+		pid_t child = fork();
+		if (child == 0) {
+			close(ends[0]);
+			net.set_seed(k + 1);
+			for (size_t t(0); t<steps; ++t) net.update();
+			double written = private_dirty();
+			ssize_t sent = write(ends[1], &written, sizeof(written));
+			_exit(sent == sizeof(written) ? 0 : 1);
+		}
+		close(ends[1]);
+		children.push_back(child);
+		pipes.push_back(ends[0]);
+	}
+	double written(0);
+	for (size_t k(0); k<branches; ++k) {
+		double kb(0);
+		if (read(pipes[k], &kb, sizeof(kb)) == sizeof(kb)) written = std::max(written, kb);
+		close(pipes[k]);
+		waitpid(children[k], nullptr, 0);
+	}
+	double branch_wall = timer.seconds();
+	bench.record("small-world", {
+		{"neurons", (double)size},
+		{"links_mb", net.get_topology().synapses()*(sizeof(uint32_t) + sizeof(double))/1048576.0},
+		{"branches", (double)branches},
+		{"burn_in_seconds", burn_wall},
+		{"branches_seconds", branch_wall},
+		{"separate_runs_seconds", branches*burn_wall + branch_wall},
+		{"max_branch_private_mb", written/1024}});
+}
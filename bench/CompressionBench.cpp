@@ -0,0 +1,39 @@
+#include "Benchmark.h"
+#include "Network.h"
+#include "Random.h"
+#include <cmath>
+#include <set>
+
+// The dynamics are chaotic: single spikes soon differ from the reference, so the spike agreement
+// (fraction of identical (step, neuron) spikes) is reported along with the error on the firing rate.
+BENCHMARK(compression) {
+	const size_t size = 100000;
+	const int steps = 100;
+	for (const std::string model : {"poisson", "small-world", "spatial"}) {
+		std::set<std::pair<int, size_t>> reference;
+		for (const auto& mode : CompressedTopology::Modes) {
+			*_RNG = RandomNumbers(2024);								// same network and same noise for every mode
+			Network net((model == "poisson" ? size/10 : size), "", 0.2, 20, model, 4);
+			net.compress(mode);
+			double synapses = net.get_links().size();
+			net.compress(mode);										// reading the links decoded them
+			std::set<std::pair<int, size_t>> spikes;
+			Timer timer;
+			for (int t(0); t<steps; ++t) {
+				for (const auto& n : net.update()) spikes.insert({t, n});
+			}
+			double wall = timer.seconds();
+			if (mode == "none") reference = spikes;
+			size_t common(0);
+			for (const auto& s : spikes) common += reference.count(s);
+			bench.record(model + "/" + mode, {
+				{"neurons", (double)net.get_size()},
+				{"edges", synapses},
+				{"bytes_per_synapse", net.topology_bytes()/synapses},
+				{"steps_per_second", steps/wall},
+				{"spikes", (double)spikes.size()},
+				{"rate_error", std::fabs((double)spikes.size() - reference.size())/reference.size()},
+				{"spike_agreement", (reference.size() + spikes.size() ? 2.0*common/(reference.size() + spikes.size()) : 1.0)}});
+		}
+	}
+}
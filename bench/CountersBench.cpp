@@ -0,0 +1,33 @@
+#include "Benchmark.h"
+#include "Network.h"
+
+BENCHMARK(counters) {
+	const size_t size = 20000, steps = 50;
+	struct Case {std::string label, model, engine;};
+	const std::vector<Case> cases {
+		{"poisson_pull",     "poisson",     "pull"},
+		{"poisson_push",     "poisson",     "push"},
+		{"small-world_pull", "small-world", "pull"},
+		{"scale-free_pull",  "scale-free",  "pull"}};
+	for (const auto& c : cases) {
+		Network net(size, "FS:0.2", 0.1, 100, c.model, 4);
+		net.set_engine(c.engine);
+		net.update();
+		net.measure_phases(true);
+		std::vector<Counts> totals(Network::Phases.size());
+		double spikes(0.0);
+		for (size_t t(0); t<steps; ++t) {
+			spikes += net.update().size();
+			for (size_t p(0); p<totals.size(); ++p) totals[p] += net.get_phase_counts()[p];
+		}
+		const Counters& counters = *net.get_counters();
+		bench.record(c.label, {
+			{"neurons", (double)size},
+			{"links", (double)net.get_topology().synapses()},
+			{"firing_per_step", spikes/steps},
+			{"counters_available", counters.available() ? 1.0 : 0.0}});
+		for (size_t p(0); p<totals.size(); ++p) {						// per step
+			bench.record(c.label + " " + Network::Phases[p], Benchmark::metrics(totals[p], counters, steps));
+		}
+	}
+}
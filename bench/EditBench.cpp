@@ -0,0 +1,45 @@
+#include "Benchmark.h"
+#include "Network.h"
+
+BENCHMARK(editing) {
+	const size_t size = 20000, steps = 100;
+	Network net(size, "", 0.2, 30, "small-world", 4);
+	net.set_compaction_threshold(1u << 30);									// compacted by hand below
+	auto run = [&net]() {
+		Timer timer;
+		for (size_t t(0); t<steps; ++t) net.update();
+		return steps/timer.seconds();
+	};
+	double plain = run();
+
+	RandomNumbers rng(3);
+	Timer timer;
+	size_t edits(0);
+	for (size_t k(0); k<20000; ++k) {
+		size_t post = rng.uniform_int(0, size - 1), pre = rng.uniform_int(0, size - 1);
+		edits += (k % 2 ? net.add_link(post, pre, 2.0) : net.set_intensity(post, pre, 1.0) or net.remove_link(post, (post + 1) % size));
+	}
+	double edit_wall = timer.seconds();
+	double with_delta = run();
+
+	const Link& links = net.get_links();										// merges the edits
+	timer.restart();
+	Topology rebuilt;															// what a change of the map used to cost
+	rebuilt.build(links, size);
+	double rebuild_wall = timer.seconds();
+	for (size_t k(0); k<20000; ++k) net.add_link(rng.uniform_int(0, size - 1), rng.uniform_int(0, size - 1), 2.0);
+	timer.restart();
+	net.compact();
+	double compact_wall = timer.seconds();
+	double compacted = run();
+	bench.record("small-world", {
+		{"neurons", (double)size},
+		{"links", (double)net.get_topology().synapses()},
+		{"edits", (double)edits},
+		{"microseconds_per_edit", 1e6*edit_wall/20000},
+		{"steps_per_second", plain},
+		{"steps_per_second_with_delta", with_delta},
+		{"steps_per_second_compacted", compacted},
+		{"rebuild_ms", 1e3*rebuild_wall},
+		{"compaction_ms", 1e3*compact_wall}});
+}
@@ -0,0 +1,67 @@
+#include "Benchmark.h"
+#include "Footprint.h"
+#include "Network.h"
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+/*!
+ * Peak resident memory added by building \p parameters and running a few steps, measured in a child process
+ * so that each case starts from the same memory
+ */
+double measure(const Footprint_parameters& p, const double& intensity)
+{
+	int ends[2];
+	if (pipe(ends) != 0) return 0;
+	pid_t child = fork();
+	if (child == 0) {
+		close(ends[0]);
+		Memory::reset_peak();
+		size_t before = Memory::peak_resident();
+		{
+			Network net(p.neurons, p.n_types, 0.1, p.connectivity, p.model, intensity, p.wiring);
+			net.compress(p.bits == 16 ? "q16" : p.bits == 8 ? "q8" : "none");
+			for (int t(0); t<10; ++t) net.update();
+		}
+		double added = (double)(Memory::peak_resident() - before);
+		ssize_t written = write(ends[1], &added, sizeof(added));
+		_exit(written == sizeof(added) ? 0 : 1);
+	}
+	close(ends[1]);
+	double added(0);
+	if (read(ends[0], &added, sizeof(added)) != sizeof(added)) added = 0;
+	close(ends[0]);
+	waitpid(child, nullptr, 0);
+	return added;
+}
+}
+
+BENCHMARK(footprint) {
+	struct Case {std::string label, model;
+				 bool rows;
+				 int bits;};
+	const std::vector<Case> cases {
+		{"poisson_map",        "poisson",     false, 0},
+		{"poisson_rows",       "poisson",     true,  0},
+		{"poisson_rows_16bit", "poisson",     true,  16},
+		{"small-world",        "small-world", false, 0},
+		{"scale-free",         "scale-free",  false, 0},
+		{"types",              "types",       false, 0}};
+	for (const auto& c : cases) {
+		Footprint_parameters p;
+		p.neurons = 20000;
+		p.n_types = "FS:0.2";
+		p.connectivity = 100;
+		p.model = c.model;
+		p.wiring.rows = c.rows;
+		p.bits = c.bits;
+		p.raster = false;
+		Footprint estimate = Footprint::estimate(p);
+		double measured = measure(p, 4);
+		bench.record(c.label, {
+			{"links", Footprint::expected_links(p)},
+			{"estimated_mb", estimate.peak()/1048576.0},
+			{"measured_mb", measured/1048576.0},
+			{"ratio", measured > 0 ? estimate.peak()/measured : 0.0}});
+	}
+}
@@ -0,0 +1,41 @@
+#include "Benchmark.h"
+#include "Network.h"
+#include <thread>
+
+BENCHMARK(generators) {
+	const double connectivity = 30.0;
+	std::vector<unsigned int> thread_counts {1};
+	if (std::thread::hardware_concurrency() > 1) thread_counts.push_back(std::thread::hardware_concurrency());
+
+	for (const auto& model : Generator::Models) {
+		for (size_t size : {10000, 100000, 1000000}) {
+			for (const auto& threads : thread_counts) {
+				Wiring_parameters wiring;
+				wiring.threads = threads;
+				Topology topology;
+				Timer timer;
+				Generator(size, connectivity, 1.0, wiring).generate(model, topology);
+				double wall = timer.seconds();
+				bench.record(model, {
+					{"neurons", (double)size},
+					{"threads", (double)threads},
+					{"edges", (double)topology.synapses()},
+					{"seconds", wall},
+					{"edges_per_second", topology.synapses()/wall}});
+			}
+		}
+	}
+
+	// the random models of Network::random_connect, for comparison
+	for (size_t size : {1000, 4000}) {
+		Timer timer;
+		Network net(size, "", 0.1, connectivity, "poisson", 1.0);
+		double wall = timer.seconds();
+		bench.record("poisson", {
+			{"neurons", (double)size},
+			{"threads", 1.0},
+			{"edges", (double)net.get_links().size()},
+			{"seconds", wall},
+			{"edges_per_second", net.get_links().size()/wall}});
+	}
+}
@@ -0,0 +1,85 @@
+#include "Benchmark.h"
+#include "Neuron.h"
+
+namespace {
+
+/*
+ * Trajectory of a single neuron driven by a constant current, integrated with the same
+ * step/reset logic as Network::update. The potential is sampled every millisecond.
+ * With substeps > 1, every step is integrated by that many RK4 sub-steps instead of \p method:
+ * this gives the exact solution on the same time grid, including the one-step reset latency.
+ */
+struct Trajectory {std::vector<double> potential;
+				   std::vector<double> spikes;};
+
+Trajectory integrate(const std::string& type, Integrator method, double dt, double duration, double current, int substeps = 1)
+{
+	Trajectory traj;
+	Neuron n(type, 0.);
+	int steps = (int)std::ceil(duration/dt);
+	int per_ms = std::max(1, (int)std::round(1.0/dt));
+	for (int t(1); t<=steps; ++t) {
+		if (n.firing()) {
+			traj.spikes.push_back(t*dt);
+			n.reset();
+		} else {
+			n.set_current(current);
+			if (substeps > 1) for (int k(0); k<substeps and not n.firing(); ++k) n.equation(dt/substeps, Integrator::RK4);
+			else n.equation(dt, method);
+		}
+		if (t % per_ms == 0) traj.potential.push_back(std::fmin(n.get_potential(), _Discharge_Threshold_));
+	}
+	return traj;
+}
+
+double rms_error(const Trajectory& ref, const Trajectory& traj)
+{
+	double sq = 0.0;
+	size_t samples = std::min(ref.potential.size(), traj.potential.size());
+	for (size_t k(0); k<samples; ++k) sq += std::pow(ref.potential[k]-traj.potential[k], 2);
+	return std::sqrt(sq/samples);
+}
+
+double spike_shift(const Trajectory& ref, const Trajectory& traj)
+{
+	double shift = 0.0;
+	size_t spikes = std::min(ref.spikes.size(), traj.spikes.size());
+	for (size_t k(0); k<spikes; ++k) shift += std::abs(ref.spikes[k]-traj.spikes[k]);
+	return spikes ? shift/spikes : 0.0;
+}
+
+}
+
+BENCHMARK(integrators) {
+	const double duration = 1000.0;
+	const double current = 10.0;
+	// errors are measured against the exact solution on the same time grid, and against a 1 us RK4 reference
+	const std::vector<std::pair<std::string, Integrator>> methods {
+		{"euler", Integrator::Euler}, {"rk2", Integrator::RK2}, {"rk4", Integrator::RK4}, {"adaptive", Integrator::Adaptive}};
+
+	for (const std::string type : {"RS", "FS"}) {
+		Trajectory fine = integrate(type, Integrator::RK4, 0.001, duration, current);
+		for (const auto& method : methods) {
+			for (double dt : {0.1, 0.25, 0.5, 1.0, 2.0}) {
+				Timer timer;
+				int runs = 0;
+				Trajectory traj;
+				do {
+					traj = integrate(type, method.second, dt, duration, current);
+					++runs;
+				} while (timer.seconds() < 0.05);
+				double wall = timer.seconds();
+				Trajectory grid = integrate(type, method.second, dt, duration, current, 1000);
+
+				bench.record(type + "/" + method.first, {
+					{"dt_ms", dt},
+					{"simulated_ms_per_wall_s", runs*duration/wall},
+					{"rms_potential_error_mV", rms_error(grid, traj)},
+					{"mean_spike_time_error_ms", spike_shift(grid, traj)},
+					{"spike_count_error", (double)traj.spikes.size() - (double)grid.spikes.size()},
+					{"rms_potential_error_vs_fine_step_mV", rms_error(fine, traj)},
+					{"spike_count_error_vs_fine_step", (double)traj.spikes.size() - (double)fine.spikes.size()}});
+			}
+		}
+	}
+}
@@ -0,0 +1,61 @@
+#include "Benchmark.h"
+#include "MeanField.h"
+#include "PopulationRates.h"
+#include <cmath>
+
+BENCHMARK(mean_field) {
+	const size_t size = 10000, steps = 500;
+	struct Case {std::string label, types, model;
+				 double connectivity, intensity;};
+	const std::vector<Case> cases {
+		{"poisson",        "",                   "poisson",        30, 4},
+		{"poisson_FS",     "FS:0.2",             "poisson",        30, 4},
+		{"over-dispersed", "FS:0.2,IB:0.1",      "over-dispersed", 30, 4},
+		{"small-world",    "FS:0.2",             "small-world",    30, 4},
+		{"types",          "FS:0.2,LTS:0.1",     "types",          30, 4}};
+	for (const auto& c : cases) {
+		Timer timer;
+		Network net(size, c.types, 0.2, c.connectivity, c.model, c.intensity);
+		PopulationRates full(Network::type_blocks(c.types, size), steps, _Time_Step_);
+		for (size_t t(1); t<=steps; ++t) {
+			full.add(net.update());
+			full.step((int)t, nullptr);
+		}
+		double full_wall = timer.seconds();
+
+		timer.restart();
+		MeanField field(size, c.types, 0.2, c.connectivity, c.model, c.intensity);
+		PopulationRates approximate(field.get_types(), steps, _Time_Step_);
+		for (size_t t(1); t<=steps; ++t) {
+			const std::vector<double>& firing = field.update();
+			for (size_t k(0); k<firing.size(); ++k) approximate.add(k, firing[k]);
+			approximate.step((int)t, nullptr);
+		}
+		double field_wall = timer.seconds();
+
+		std::vector<double> exact = full.mean_rates(), rates = approximate.mean_rates();
+		double error(0.0), total(0.0);
+		std::vector<std::pair<std::string, double>> values {{"neurons", (double)size}, {"steps", (double)steps}};
+		for (size_t k(0); k<exact.size(); ++k) {
+			const Type_block& type = full.get_types()[k];
+			values.push_back({type.name + "_rate_full", exact[k]});
+			values.push_back({type.name + "_rate_mean_field", rates[k]});
+			error += std::fabs(rates[k] - exact[k])*(type.last - type.first);
+			total += exact[k]*(type.last - type.first);
+		}
+		values.push_back({"relative_error", (total > 0 ? error/total : 0.0)});
+		values.push_back({"full_seconds", full_wall});
+		values.push_back({"mean_field_seconds", field_wall});
+		values.push_back({"speedup", full_wall/field_wall});
+		bench.record(c.label, values);
+	}
+
+	// the cost of a step does not depend on the size of the network
+	Timer timer;
+	MeanField field(10000000, "FS:0.2", 0.2, 1000, "poisson", 0.1);
+	for (size_t t(0); t<steps; ++t) field.update();
+	bench.record("ten_million_neurons", {
+		{"neurons", 1e7},
+		{"connectivity", 1000},
+		{"steps_per_second", steps/timer.seconds()}});
+}
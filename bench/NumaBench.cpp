@@ -0,0 +1,45 @@
+#include "Benchmark.h"
+#include "Network.h"
+#include <thread>
+
+// Fraction of the pages of links (senders and intensities) on the memory node of the thread computing them
+static double local_fraction(const std::vector<Network::Placement>& placement)
+{
+	double local(0.0), total(0.0);
+	for (const auto& part : placement) {
+		for (const auto *pages : {&part.links, &part.intensities}) {
+			for (size_t k(0); k + 1<pages->size(); ++k) {
+				total += (*pages)[k];
+				if ((int)k == part.node) local += (*pages)[k];
+			}
+		}
+	}
+	return (total > 0 ? local/total : 0.0);
+}
+
+BENCHMARK(numa) {
+	const size_t size = 200000;
+	const int steps = 20;
+	const unsigned int threads = std::max(2u, std::thread::hardware_concurrency());
+	for (bool huge : {false, true}) {
+		for (bool first_touch : {false, true}) {
+			Memory::set_huge_pages(huge);
+			*_RNG = RandomNumbers(5);
+			Network net(size, "", 0.2, 30, "small-world", 4);
+			net.set_threads(threads);
+			if (first_touch) net.place();
+			net.update();
+			Timer timer;
+			for (int t(0); t<steps; ++t) net.update();
+			double wall = timer.seconds();
+			double bytes = (double)net.get_topology().synapses()*(sizeof(uint32_t) + sizeof(double));
+			bench.record(std::string(first_touch ? "first-touch" : "constructor") + (huge ? "/huge-pages" : ""), {
+				{"neurons", (double)size},
+				{"threads", (double)threads},
+				{"steps_per_second", steps/wall},
+				{"link_gigabytes_per_second", bytes*steps/wall/1e9},
+				{"local_link_pages", local_fraction(net.placement())}});
+		}
+	}
+	Memory::set_huge_pages(false);
+}
@@ -0,0 +1,40 @@
+#include "Benchmark.h"
+#include "Network.h"
+#include <cmath>
+
+/*!
+ * Mean distance between the index of a neuron and the indices of its inputs
+ */
+static double index_distance(const Topology& topology)
+{
+	double distance(0.0);
+	for (size_t n(0); n<topology.size(); ++n) {
+		for (const auto& pre : topology.inputs(n)) distance += std::fabs((double)pre - (double)n);
+	}
+	return (topology.synapses() ? distance/topology.synapses() : 0.0);
+}
+
+BENCHMARK(orderings) {
+	const size_t size = 100000;
+	const int steps = 100;
+	for (const std::string model : {"small-world", "spatial"}) {
+		for (const auto& method : Ordering::Methods) {
+			Network net(size, "", 0.2, 20, model, 4);
+			net.reorder(Ordering::random(size));				// the worst case: no locality left
+			Timer timer;
+			net.reorder(method);
+			double ordering = timer.seconds();
+			const Topology& topology = net.get_topology();
+			timer.restart();
+			for (int t(0); t<steps; ++t) net.update();
+			double wall = timer.seconds();
+			bench.record(model + "/" + method, {
+				{"neurons", (double)size},
+				{"edges", (double)topology.synapses()},
+				{"ordering_seconds", ordering},
+				{"lines_per_link", Ordering::lines_per_link(topology)},
+				{"index_distance", index_distance(topology)},
+				{"steps_per_second", steps/wall}});
+		}
+	}
+}
@@ -0,0 +1,21 @@
+#include "Benchmark.h"
+#include "Network.h"
+
+BENCHMARK(plasticity) {
+	const int steps = 100;
+	for (size_t size : {10000, 100000}) {
+		for (bool plastic : {false, true}) {
+			Network net(size, "", 0.2, 20, "small-world", 4);
+			if (plastic) net.set_plasticity(Plasticity_parameters());
+			double spikes(0.0);
+			Timer timer;
+			for (int t(0); t<steps; ++t) spikes += net.update().size();
+			double wall = timer.seconds();
+			bench.record(plastic ? "stdp" : "fixed", {
+				{"neurons", (double)size},
+				{"steps_per_second", steps/wall},
+				{"spikes_per_step", spikes/steps},
+				{"updates_per_spike", (spikes > 0 ? net.plastic_updates()/spikes : 0.0)}});
+		}
+	}
+}
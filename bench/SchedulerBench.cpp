@@ -0,0 +1,36 @@
+#include "Benchmark.h"
+#include "Network.h"
+#include <algorithm>
+#include <thread>
+
+BENCHMARK(scheduler) {
+	const size_t size = 20000;
+	const int steps = 50;
+	const unsigned int threads = std::max(4u, std::thread::hardware_concurrency());
+	for (const std::string model : {"constant", "poisson", "over-dispersed", "small-world", "scale-free", "spatial"}) {
+		for (bool stealing : {false, true}) {
+			*_RNG = RandomNumbers(3);
+			Network net(size, "", 0.2, 30, model, 4);
+			net.set_threads(threads, stealing);
+			net.update();
+			Timer timer;
+			for (int t(0); t<steps; ++t) net.update();
+			double wall = timer.seconds();
+
+			double busiest(0.0), busy(0.0), idle(0.0), steals(0.0);
+			for (const auto& s : net.thread_statistics()) {
+				busiest = std::max(busiest, s.busy);
+				busy += s.busy;
+				idle += s.idle;
+				steals += s.steals;
+			}
+			bench.record(model + (stealing ? "/stealing" : "/static"), {
+				{"neurons", (double)size},
+				{"threads", (double)threads},
+				{"steps_per_second", steps/wall},
+				{"imbalance", busiest*threads/busy},					// 1 when the work is evenly spread
+				{"idle_fraction", idle/(busy + idle)},
+				{"steals_per_step", steals/(steps + 1)}});
+		}
+	}
+}
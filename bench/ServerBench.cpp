@@ -0,0 +1,54 @@
+#include "Benchmark.h"
+#include "Server.h"
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+BENCHMARK(server) {
+	const size_t size = 2000;
+	const int jobs = 40;
+	std::string path = "/tmp/nn_server_bench_" + std::to_string(getpid());
+	Server server(path, 0);
+	std::thread serving([&server] { server.serve(); });
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	std::strcpy(address.sun_path, path.c_str());
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	connect(fd, (sockaddr*)&address, sizeof(address));
+	std::string buffer;
+	auto exchange = [&](const std::string& request, const std::string& last) {	// sends a request and reads the replies up to last
+		send(fd, request.data(), request.size(), 0);
+		char chunk[4096];
+		while (buffer.find(last) == std::string::npos) {
+			ssize_t got = recv(fd, chunk, sizeof(chunk), 0);
+			if (got <= 0) break;
+			buffer.append(chunk, got);
+		}
+		buffer.clear();
+	};
+	exchange("build net number=" + std::to_string(size) + " model=small-world seed=3\n", "ok build");
+
+	for (int steps : {10, 100, 1000}) {
+		Timer timer;															// a new network for each job, as one process per job does
+		for (int k(0); k<jobs/10; ++k) {
+			*_RNG = RandomNumbers(3);
+			Network network(size, "", _Delta_, _Connectivity_, "small-world", _Intensity_);
+			for (int t(0); t<steps; ++t) network.update();
+		}
+		double cold = timer.seconds()/(jobs/10);
+		timer.restart();
+		for (int k(0); k<jobs; ++k) exchange("run net outputs=count steps=" + std::to_string(steps) + "\n", "done");
+		double warm = timer.seconds()/jobs;
+		bench.record(std::to_string(steps) + " steps", {
+			{"neurons", (double)size},
+			{"steps", (double)steps},
+			{"cold_job_ms", 1e3*cold},
+			{"warm_job_ms", 1e3*warm},
+			{"speedup", cold/warm}});
+	}
+	exchange("shutdown\n", "ok shutdown");
+	serving.join();
+	close(fd);
+}
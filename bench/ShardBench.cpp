@@ -0,0 +1,44 @@
+#include "Benchmark.h"
+#include "Shards.h"
+#include <cstdio>
+#include <unistd.h>
+
+BENCHMARK(shards) {
+	const size_t size = 20000, steps = 300;
+	Network net(size, "RS:0.4,FS:0.2,IB:0.2,LTS:0.1,CH:0.1", 0.2, 30, "poisson", 4);
+	std::vector<std::vector<size_t>> spikes;
+	for (size_t t(0); t<steps; ++t) spikes.push_back(net.update());
+	std::string raster = "/tmp/nn_shard_bench_" + std::to_string(getpid()), sample = raster + ".sample";
+
+	for (const size_t shards : {1, 2, 4, 8}) {
+		Timer timer;
+		{
+			ShardedOutput output(net, shards, raster, sample);
+			for (size_t t(0); t<steps; ++t) output.write(t + 1, spikes[t]);
+			output.close();
+		}
+		double wall = timer.seconds();
+		double bytes(0);
+		for (size_t k(0); k<shards; ++k) bytes += std::ifstream(raster + ".shard" + std::to_string(k), std::ios::ate | std::ios::binary).tellg();
+
+		size_t lines(0);
+		std::string line;
+		timer.restart();
+		ShardReader reader(raster);
+		while (reader.next(line)) ++lines;
+		double merge_wall = timer.seconds();
+		bench.record(std::to_string(shards) + " shards", {
+			{"neurons", (double)size},
+			{"steps", (double)steps},
+			{"shards", (double)shards},
+			{"raster_bytes", bytes},
+			{"steps_per_second", steps/wall},
+			{"megabytes_per_second", bytes/wall/1e6},
+			{"merged_lines", (double)lines},
+			{"merge_megabytes_per_second", bytes/merge_wall/1e6}});
+		for (size_t k(0); k<shards; ++k) {
+			std::remove((raster + ".shard" + std::to_string(k)).c_str());
+			std::remove((sample + ".shard" + std::to_string(k)).c_str());
+		}
+	}
+}
@@ -0,0 +1,42 @@
+#include "Benchmark.h"
+#include "Stimulus.h"
+#include <cstdio>
+#include <unistd.h>
+
+BENCHMARK(stimulus) {
+	const size_t steps = 100000;
+	for (size_t scheduled : {10, 1000, 100000}) {						// pulses of 10 neurons over 20 steps, spread over the run
+		Stimulus stimulus;
+		for (size_t k(0); k<scheduled; ++k) stimulus.pulse(10*(k%100), 10*(k%100) + 10, 1 + k*steps/scheduled, 20, 5.0);
+		double sum(0.0);
+		size_t active(0);
+		Timer timer;
+		for (size_t t(1); t<=steps; ++t) {
+			stimulus.inject(t, [&sum](const size_t&, const double& current) { sum += current; });
+			active += stimulus.active_stimuli();
+		}
+		double wall = timer.seconds();
+		bench.record(std::to_string(scheduled) + " pulses", {
+			{"scheduled", (double)scheduled},
+			{"mean_active", (double)active/steps},
+			{"ns_per_step", 1e9*wall/steps},
+			{"ns_per_active_stimulus", 1e9*wall/std::max<size_t>(active, 1)}});
+	}
+
+	std::string path = "/tmp/nn_train_bench_" + std::to_string(getpid());
+	{
+		std::ofstream file(path);
+		for (size_t t(1); t<=steps; ++t) for (size_t n(0); n<10; ++n) file << t << ' ' << (t*7 + n*131)%10000 << '\n';
+	}
+	Stimulus stimulus;
+	stimulus.train(path, 5.0);
+	size_t spikes(0);
+	Timer timer;
+	for (size_t t(1); t<=steps; ++t) stimulus.inject(t, [&spikes](const size_t&, const double&) { ++spikes; });
+	double wall = timer.seconds();
+	bench.record("spike train", {
+		{"spikes", (double)spikes},
+		{"spikes_per_second", spikes/wall},
+		{"ns_per_step", 1e9*wall/steps}});
+	std::remove(path.c_str());
+}
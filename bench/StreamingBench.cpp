@@ -0,0 +1,26 @@
+#include "Benchmark.h"
+#include "Network.h"
+#include <unistd.h>
+
+BENCHMARK(streaming) {
+	const size_t size = 100000;
+	const int steps = 20;
+	const std::string path = "/tmp/nn_streaming_bench." + std::to_string(getpid());
+	for (double budget : {0.0, 64.0, 8.0, 1.0}) {						// MB of links kept in memory, 0 for all the links
+		Network net(size, "", 0.2, 20, "small-world", 4);
+		if (budget > 0.0) net.stream(path, (size_t)(budget*1024*1024));
+		double wait(0.0);
+		Timer timer;
+		for (int t(0); t<steps; ++t) {
+			net.update();
+			wait += net.get_io_wait();
+		}
+		double wall = timer.seconds();
+		bench.record(budget > 0.0 ? std::to_string((int)budget) + "MB" : "memory", {
+			{"neurons", (double)size},
+			{"link_bytes", (double)net.topology_bytes()},
+			{"steps_per_second", steps/wall},
+			{"io_wait_per_step", wait/steps},
+			{"io_wait_fraction", wait/wall}});
+	}
+}
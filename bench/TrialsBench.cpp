@@ -0,0 +1,30 @@
+#include "Benchmark.h"
+#include "Trials.h"
+
+BENCHMARK(trials) {
+	const size_t size = 10000;
+	const int steps = 50;
+	for (size_t lanes : {1, 8, 32, 128}) {
+		Network net(size, "", 0.2, 30, "small-world", 4);
+		double separate(0.0);
+		for (size_t k(0); k<std::min<size_t>(lanes, 8); ++k) {			// separate runs, extrapolated beyond 8 trials
+			*_RNG = RandomNumbers(k + 1);
+			Network alone(size, "", 0.2, 30, "small-world", 4);
+			Timer timer;
+			for (int t(0); t<steps; ++t) alone.update();
+			separate += timer.seconds();
+		}
+		separate *= (double)lanes/std::min<size_t>(lanes, 8);
+
+		Trials trials(net, lanes);
+		Timer timer;
+		for (int t(0); t<steps; ++t) trials.update();
+		double together = timer.seconds();
+		bench.record(std::to_string(lanes) + " trials", {
+			{"neurons", (double)size},
+			{"trials", (double)lanes},
+			{"trial_neuron_steps_per_second", lanes*size*steps/together},
+			{"separate_trial_neuron_steps_per_second", lanes*size*steps/separate},
+			{"speedup", separate/together}});
+	}
+}
@@ -0,0 +1,39 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifndef NDEBUG
+
+namespace {
+	std::atomic<size_t> allocations(0);
+}
+
+void* operator new(size_t size)
+{
+	++allocations;
+	if (void* p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	++allocations;
+	if (void* p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+bool AllocationCounter::enabled() { return true; }
+size_t AllocationCounter::count() { return allocations.load(); }
+
+#else
+
+bool AllocationCounter::enabled() { return false; }
+size_t AllocationCounter::count() { return 0; }
+
+#endif
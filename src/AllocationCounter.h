@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+
+/*! \class AllocationCounter
+ * Counts the calls to the global operator new, in order to check that the simulation
+ * loop does not allocate memory once it is running.
+ *
+ * The counting replacement of operator new is only compiled in debug builds (NDEBUG not defined);
+ * in other builds \ref enabled returns false and \ref count always returns 0.
+ */
+
+class AllocationCounter {
+public:
+/*!
+ * True if the allocations are counted in this build
+ */
+	static bool enabled();
+/*!
+ * Number of allocations since the start of the program
+ */
+	static size_t count();
+};
@@ -0,0 +1,168 @@
+#include "Autotuner.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+const size_t Autotuner::Min_steps;
+const size_t Autotuner::Max_steps;
+const unsigned long Autotuner::Seed;
+
+namespace {
+double since(const std::chrono::steady_clock::time_point& begin)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+}
+
+std::string Configuration::to_string() const
+{
+	return engine + " " + std::to_string(threads) + " " + (stealing ? "stealing" : "static") + " " + layout;
+}
+
+Configuration Configuration::parse(const std::string& text)
+{
+	Configuration configuration;
+	std::istringstream words(text);
+	std::string partition;
+	if (not (words >> configuration.engine >> configuration.threads >> partition >> configuration.layout)
+		or Network::Engines.count(configuration.engine) == 0 or configuration.threads == 0
+		or (partition != "stealing" and partition != "static")
+		or std::find(Ordering::Methods.begin(), Ordering::Methods.end(), configuration.layout) == Ordering::Methods.end())
+		throw std::runtime_error("Invalid configuration " + text + ".");
+	configuration.stealing = (partition == "stealing");
+	return configuration;
+}
+
+void Configuration::apply(Network& network) const
+{
+	network.set_engine(engine);
+	std::vector<uint32_t> ids(network.get_size());
+	bool reordered(false);
+	for (size_t n(0); n<network.get_size(); ++n) {
+		ids[n] = (uint32_t)network.internal_id(n);
+		reordered = reordered or ids[n] != n;
+	}
+	if (reordered) network.reorder(ids);
+	network.reorder(layout);
+	network.set_threads(threads, stealing);
+}
+
+Autotuner::Autotuner(const double& budget, const Tolerances& tolerances, const unsigned int& threads)
+: budget(budget), tolerances(tolerances), threads(threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads)
+{
+	if (budget < 0) throw std::runtime_error("The time of the autotuner cannot be negative.");
+}
+
+std::vector<Configuration> Autotuner::candidates(const unsigned int& threads)
+{
+	std::vector<Configuration> candidates {{"pull", 1, true, "none"}, {"push", 1, true, "none"}};
+	std::vector<unsigned int> counts;
+	for (unsigned int t(2); t<threads; t *= 2) counts.push_back(t);
+	if (threads > 1) counts.push_back(threads);
+	for (const auto& t : counts) {
+		candidates.push_back({"pull", t, true, "none"});
+		candidates.push_back({"pull", t, false, "none"});
+	}
+	return candidates;
+}
+
+Autotuner::Trial Autotuner::run(Network& network, const Configuration& configuration)
+{
+	configuration.apply(network);
+	network.reset();
+	network.set_seed(Seed);
+	std::vector<std::vector<size_t>> fired;
+	fired.push_back(network.update());									// builds the chunks or the transposed links, not timed
+	auto begin = std::chrono::steady_clock::now();
+	size_t timed(0);
+	while (steps > 0 ? timed < steps : timed < Min_steps or (timed < Max_steps and since(begin) < slice)) {
+		fired.push_back(network.update());
+		++timed;
+	}
+	Trial trial {configuration, since(begin)/timed, timed, true};
+
+	std::vector<double> final(3*network.get_size());
+	for (size_t n(0); n<network.get_size(); ++n) {
+		final[3*n] = network.get_potential(n);
+		final[3*n + 1] = network.get_recovery(n);
+		final[3*n + 2] = network.get_current(n);
+	}
+	if (steps == 0) {													// the baseline
+		steps = timed;
+		spikes.swap(fired);
+		state.swap(final);
+		return trial;
+	}
+	trial.equivalent = (fired == spikes);
+	for (size_t n(0); n<network.get_size() and trial.equivalent; ++n) {
+		trial.equivalent = std::abs(final[3*n] - state[3*n]) <= tolerances.potential
+						   and std::abs(final[3*n + 1] - state[3*n + 1]) <= tolerances.recovery
+						   and std::abs(final[3*n + 2] - state[3*n + 2]) <= tolerances.current;
+	}
+	return trial;
+}
+
+Configuration Autotuner::tune(Network& network)
+{
+	trials.clear();
+	spikes.clear();
+	state.clear();
+	steps = 0;
+	auto begin = std::chrono::steady_clock::now();
+	std::vector<Configuration> first = candidates(threads);
+	slice = budget/(first.size() + Ordering::Methods.size() - 1);
+
+	auto fits = [&]() {													// a trial is expected to take at most as long as the baseline
+		return trials.empty() or since(begin) + steps*trials.front().seconds_per_step <= budget;
+	};
+	auto fastest = [this]() {
+		const Trial* best = &trials.front();
+		for (const auto& trial : trials) {
+			if (trial.equivalent and trial.seconds_per_step < best->seconds_per_step) best = &trial;
+		}
+		return best->configuration;
+	};
+	for (const auto& configuration : first) {
+		if (not fits()) break;
+		trials.push_back(run(network, configuration));
+	}
+	Configuration best = fastest();
+	for (const auto& layout : Ordering::Methods) {						// the orders of the neurons, with the fastest engine and threads
+		if (layout == "none" or not fits()) continue;
+		Configuration configuration = best;
+		configuration.layout = layout;
+		trials.push_back(run(network, configuration));
+	}
+	best = fastest();
+	best.apply(network);
+	network.reset();
+	network.clear_seed();
+	spikes.clear();
+	state.clear();
+	return best;
+}
+
+bool Autotuner::lookup(const std::string& path, const std::string& signature, Configuration& configuration)
+{
+	std::ifstream cache(path);
+	bool found(false);
+	for (std::string line; std::getline(cache, line); ) {
+		size_t tab = line.find('\t');
+		if (tab == std::string::npos or line.compare(0, tab, signature) != 0 or tab != signature.size()) continue;
+		try {
+			configuration = Configuration::parse(line.substr(tab + 1));
+			found = true;
+		} catch (std::runtime_error&) {}								// a line written by another version is ignored
+	}
+	return found;
+}
+
+bool Autotuner::store(const std::string& path, const std::string& signature, const Configuration& configuration)
+{
+	std::ofstream cache(path, std::ios_base::app);
+	cache << signature << '\t' << configuration.to_string() << '\n';
+	return bool(cache);
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Validation.h"
+#include <string>
+#include <vector>
+
+/*! \struct Configuration
+ * Way a \ref Network runs, as chosen by the \ref Autotuner: its \ref Engine (one of \ref Network::Engines), its number of threads
+ * and the partition of the rows between them (see \ref Network::set_threads), and the order of its neurons (one of \ref Ordering::Methods).
+ */
+struct Configuration {
+	Configuration(const std::string& engine = "pull", const unsigned int& threads = 1, const bool& stealing = true, const std::string& layout = "none")
+	: engine(engine), threads(threads), stealing(stealing), layout(layout) {}
+	std::string engine;
+	unsigned int threads;
+	bool stealing;
+	std::string layout;
+/*!
+ * Text of the configuration, e.g. "pull 4 stealing rcm", read back by \ref parse
+ */
+	std::string to_string() const;
+	static Configuration parse(const std::string& text);
+/*!
+ * Gives the configuration to \p network; reordered neurons are put back in the order of their ids before the \ref layout is applied
+ */
+	void apply(Network& network) const;
+};
+
+/*! \class Autotuner
+ * Chooses the fastest \ref Configuration of a built \ref Network by timing a few steps of each candidate on it, within a time budget.
+ *
+ * Each trial starts from the initial state of the network (see \ref Network::reset) and draws its noise from the same seed, so that
+ * all the candidates run the same steps. The first candidate (pull, one thread, neurons in the order of their ids) is the baseline:
+ * it runs steps until it has used its share of the budget, and the others run as many, if they can end within the budget
+ * at the speed of the baseline. A candidate is kept only if it is
+ * equivalent to the baseline: the same neurons fire at every step, and the states at the end agree within the \ref Tolerances.
+ * The engines and threads are tried first, then the orders of the neurons with the fastest of them.
+ *
+ * The network is then given the fastest candidate, put back in its initial state, its noise drawn from the global generator again.
+ * The choice can be kept in a cache file, one line per network signature, to be read by the next runs (see \ref lookup and \ref store).
+ */
+
+class Autotuner {
+public:
+/*!
+ * Time per step of a candidate, and whether it ran the same steps as the baseline
+ */
+	struct Trial {Configuration configuration;
+				  double seconds_per_step;
+				  size_t steps;
+				  bool equivalent;};
+/*!
+ * \param budget: time the trials may take (s); the baseline always runs
+ * \param tolerances: largest differences of the final states accepted
+ * \param threads: largest number of threads tried, 0 for one per core
+ */
+	Autotuner(const double& budget, const Tolerances& tolerances, const unsigned int& threads = 0);
+/*!
+ * Runs the trials on \p network and gives it the fastest equivalent configuration, which is returned
+ */
+	Configuration tune(Network& network);
+/*!
+ * Trials of the last \ref tune, in the order they ran
+ */
+	const std::vector<Trial>& get_trials() const { return trials; }
+/*!
+ * Engines and threads tried first, the baseline first: pull and push with one thread, then pull with 2, 4, ... and \p threads
+ * threads, with and without stealing
+ */
+	static std::vector<Configuration> candidates(const unsigned int& threads);
+
+/*! @name Cache of the choices
+ * The file holds lines "signature<TAB>configuration"; the last line of a signature is the one read.
+ */
+///@{
+/*!
+ * Reads the configuration chosen for \p signature in the file \p path into \p configuration; false if there is none
+ */
+	static bool lookup(const std::string& path, const std::string& signature, Configuration& configuration);
+/*!
+ * Adds the \p configuration chosen for \p signature to the file \p path; false if it cannot be written
+ */
+	static bool store(const std::string& path, const std::string& signature, const Configuration& configuration);
+///@}
+
+/*!
+ * Bounds of the number of timed steps of a trial, and seed of the noise of the trials
+ */
+	static const size_t Min_steps = 3, Max_steps = 200;
+	static const unsigned long Seed = 1;
+
+private:
+/*!
+ * Times \p configuration on \p network over \ref steps steps (as many as its share of the budget allows if there are none yet),
+ * and compares them with the baseline
+ */
+	Trial run(Network& network, const Configuration& configuration);
+
+	double budget;
+	Tolerances tolerances;
+	unsigned int threads;
+	std::vector<Trial> trials;
+/*!
+ * Time given to each trial, number of steps timed, and the steps of the baseline: its firing neurons, then its final state
+ */
+	double slice = 0.0;
+	size_t steps = 0;
+	std::vector<std::vector<size_t>> spikes;
+	std::vector<double> state;
+};
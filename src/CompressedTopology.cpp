@@ -0,0 +1,107 @@
+#include "CompressedTopology.h"
+#include <cmath>
+
+const std::vector<std::string> CompressedTopology::Modes {"none", "q16", "q8"};
+
+namespace {
+
+void put_delta(std::vector<uint8_t>& bytes, uint32_t delta)
+{
+	while (delta >= 0x80) {
+		bytes.push_back((uint8_t)(delta | 0x80));
+		delta >>= 7;
+	}
+	bytes.push_back((uint8_t)delta);
+}
+
+template<class Code>
+void quantize(const View<double>& weights, const double& scale, std::vector<Code>& codes)
+{
+	for (const auto& w : weights) codes.push_back((Code)std::lround(scale > 0.0 ? w/scale : 0.0));
+}
+
+}
+
+template<class Code>
+double CompressedTopology::decode_sum(const Code *codes, const uint8_t *p, const size_t& count, const double *drive)
+{
+	double sum(0.0);
+	uint32_t pre(0);
+	for (size_t k(0); k<count; ++k) {
+		pre += get_delta(p);
+		sum += codes[k]*drive[pre];
+	}
+	return sum;
+}
+
+CompressedTopology::CompressedTopology() : bits(0), start(1, 0), offset(1, 0)
+{}
+
+CompressedTopology::CompressedTopology(const Topology& topology, const int& bits)
+: bits(bits), start(1, 0), offset(1, 0)
+{
+	if (bits != 8 and bits != 16) throw std::runtime_error("Intensities can only be quantized on 8 or 16 bits.");
+	const double levels = (bits == 8 ? INT8_MAX : INT16_MAX);
+	start.reserve(topology.size() + 1);
+	offset.reserve(topology.size() + 1);
+	scale.reserve(topology.size());
+	deltas.reserve(topology.synapses());
+	if (bits == 8) codes8.reserve(topology.synapses());
+	else codes16.reserve(topology.synapses());
+
+	for (size_t n(0); n<topology.size(); ++n) {
+		uint32_t previous(0);
+		for (const auto& m : topology.inputs(n)) {
+			put_delta(deltas, m - previous);
+			previous = m;
+		}
+		double largest(0.0);
+		for (const auto& w : topology.intensities(n)) largest = std::max(largest, std::fabs(w));
+		scale.push_back(largest/levels);
+		if (bits == 8) quantize(topology.intensities(n), scale.back(), codes8);
+		else quantize(topology.intensities(n), scale.back(), codes16);
+		start.push_back(start.back() + topology.degree(n));
+		offset.push_back(deltas.size());
+	}
+	deltas.shrink_to_fit();
+}
+
+int CompressedTopology::bits_of(const std::string& mode)
+{
+	if (mode == "q8") return 8;
+	if (mode == "q16") return 16;
+	if (mode != "none") throw std::runtime_error("Unknown compression " + mode + ".");
+	return 0;
+}
+
+Topology CompressedTopology::expand() const
+{
+	Array<size_t> rows(start.begin(), start.end());
+	Array<uint32_t> pre;
+	Array<double> weight;
+	pre.reserve(synapses());
+	weight.reserve(synapses());
+	for (size_t n(0); n<size(); ++n) {
+		for_each(n, [&](const uint32_t& m, const double& w) {
+			pre.push_back(m);
+			weight.push_back(w);
+		});
+	}
+	Topology topology;
+	topology.assign(std::move(rows), std::move(pre), std::move(weight));
+	return topology;
+}
+
+double CompressedTopology::row_sum(const size_t& n, const double *drive) const
+{
+	const uint8_t *p = deltas.data() + offset[n];
+	size_t count = start[n+1] - start[n];
+	if (bits == 8) return scale[n]*decode_sum(codes8.data() + start[n], p, count, drive);
+	return scale[n]*decode_sum(codes16.data() + start[n], p, count, drive);
+}
+
+size_t CompressedTopology::bytes() const
+{
+	return (start.size() + offset.size())*sizeof(size_t) + deltas.size() + scale.size()*sizeof(double)
+		   + codes8.size()*sizeof(int8_t) + codes16.size()*sizeof(int16_t);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Topology.h"
+
+/*! \class CompressedTopology
+ * Compressed, read-only copy of a \ref Topology, for networks whose links do not fit in memory as plain rows.
+ *
+ * Within each row:
+ * - the sending neurons are stored as the differences between consecutive (sorted) indices, each in a variable
+ *   number of bytes (7 bits per byte, the high bit telling that another byte follows): neighbouring neurons take one byte,
+ * - the intensities are quantized to signed integers of \ref bits bits, multiplied back by a per-row \ref scale.
+ *
+ * The links are decoded on the fly by \ref row_sum, so the simulation reads a few bytes per link instead of twelve.
+ * Available modes (\ref Modes): "none" (no compression), "q16" and "q8".
+ */
+
+class CompressedTopology {
+public:
+	static const std::vector<std::string> Modes;
+
+/*! @name Building
+ */
+///@{
+	CompressedTopology();
+/*!
+ * Compresses \p topology with \p bits bits per intensity (8 or 16)
+ */
+	CompressedTopology(const Topology& topology, const int& bits);
+/*!
+ * Number of bits per intensity of the mode \p mode, 0 for "none"; throws for a mode which is not one of \ref Modes
+ */
+	static int bits_of(const std::string& mode);
+/*!
+ * Decodes the rows back into a \ref Topology (with the quantized intensities)
+ */
+	Topology expand() const;
+///@}
+
+/*! @name Reading
+ */
+///@{
+	bool empty() const { return bits == 0; }
+	size_t size() const { return start.size() - 1; }
+	size_t synapses() const { return start.back(); }
+	size_t degree(const size_t& n) const { return start[n+1] - start[n]; }
+/*!
+ * Calls \p f (sending neuron, intensity) for each link received by neuron \p n
+ */
+	template<class F> void for_each(const size_t& n, F f) const;
+/*!
+ * Sum of the intensities of the links received by neuron \p n, each multiplied by the \p drive of its sending neuron
+ */
+	double row_sum(const size_t& n, const double *drive) const;
+/*!
+ * Memory used by the rows, in bytes
+ */
+	size_t bytes() const;
+///@}
+
+private:
+/*!
+ * Reads the difference at \p p and moves \p p past it
+ */
+	static uint32_t get_delta(const uint8_t *&p);
+	template<class Code> static double decode_sum(const Code *codes, const uint8_t *p, const size_t& count, const double *drive);
+
+	int bits;
+/*!
+ * First link of each row, as in \ref Topology
+ */
+	std::vector<size_t> start;
+/*!
+ * Position in \ref deltas of the first byte of each row
+ */
+	std::vector<size_t> offset;
+	std::vector<uint8_t> deltas;
+	std::vector<double> scale;
+/*! @name Quantized intensities
+ * Only the vector matching \ref bits is used.
+ */
+///@{
+	std::vector<int8_t> codes8;
+	std::vector<int16_t> codes16;
+///@}
+};
+
+inline uint32_t CompressedTopology::get_delta(const uint8_t *&p)
+{
+	uint32_t delta = *p++;
+	if (delta < 0x80) return delta;									// most links: neighbouring neurons
+	delta &= 0x7f;
+	for (int shift(7); ; shift += 7) {
+		uint32_t byte = *p++;
+		delta |= (byte & 0x7f) << shift;
+		if (byte < 0x80) return delta;
+	}
+}
+
+template<class F>
+void CompressedTopology::for_each(const size_t& n, F f) const
+{
+	const uint8_t *p = deltas.data() + offset[n];
+	uint32_t pre(0);
+	for (size_t k(start[n]); k<start[n+1]; ++k) {
+		pre += get_delta(p);
+		f(pre, scale[n]*(bits == 8 ? codes8[k] : codes16[k]));
+	}
+}
@@ -0,0 +1,84 @@
+#include "Counters.h"
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+const std::vector<std::string> Counters::Names {"cycles", "instructions", "llc_misses", "branch_misses"};
+
+namespace {
+const uint64_t Events[] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+double now()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+Counts Counts::operator-(const Counts& earlier) const
+{
+	Counts difference;
+	difference.seconds = seconds - earlier.seconds;
+	difference.cycles = cycles - earlier.cycles;
+	difference.instructions = instructions - earlier.instructions;
+	difference.cache_misses = cache_misses - earlier.cache_misses;
+	difference.branch_misses = branch_misses - earlier.branch_misses;
+	return difference;
+}
+
+Counts& Counts::operator+=(const Counts& other)
+{
+	seconds += other.seconds;
+	cycles += other.cycles;
+	instructions += other.instructions;
+	cache_misses += other.cache_misses;
+	branch_misses += other.branch_misses;
+	return *this;
+}
+
+Counters::Counters()
+{
+	for (const auto& event : Events) {
+		perf_event_attr attributes;
+		std::memset(&attributes, 0, sizeof(attributes));
+		attributes.size = sizeof(attributes);
+		attributes.type = PERF_TYPE_HARDWARE;
+		attributes.config = event;
+		attributes.disabled = events.empty();							// the group starts once it is complete
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv = 1;
+		attributes.read_format = PERF_FORMAT_GROUP;
+		int fd = (int)syscall(SYS_perf_event_open, &attributes, 0, -1, events.empty() ? -1 : events.front(), 0);
+		if (fd < 0) {
+			reason = std::string("perf_event_open: ") + std::strerror(errno);
+			for (const auto& opened : events) close(opened);
+			events.clear();
+			return;
+		}
+		events.push_back(fd);
+	}
+	ioctl(events.front(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(events.front(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+Counters::~Counters()
+{
+	for (const auto& fd : events) close(fd);
+}
+
+Counts Counters::read() const
+{
+	Counts counts;
+	counts.seconds = now();
+	if (events.empty()) return counts;
+	uint64_t values[1 + sizeof(Events)/sizeof(Events[0])];				// the number of events, then their values
+	if (::read(events.front(), values, sizeof(values)) != (ssize_t)sizeof(values)) return counts;
+	counts.cycles = values[1];
+	counts.instructions = values[2];
+	counts.cache_misses = values[3];
+	counts.branch_misses = values[4];
+	return counts;
+}
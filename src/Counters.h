@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*!
+ * Wall time and hardware events of a piece of work: cycles, instructions retired, misses of the last level cache
+ * and mispredicted branches. The events are 0 when the \ref Counters are not available.
+ */
+struct Counts {
+	double seconds = 0.0;
+	uint64_t cycles = 0, instructions = 0, cache_misses = 0, branch_misses = 0;
+
+	Counts operator-(const Counts& earlier) const;
+	Counts& operator+=(const Counts& other);
+};
+
+/*! \class Counters
+ * Hardware performance counters of the calling thread, read with the Linux perf_event_open interface.
+ *
+ * The four events of \ref Counts are opened as one group when the object is built, and count from then on in user space,
+ * in the thread which built it only: the threads of a \ref WorkPool are not counted, except the calling one, which runs its share.
+ * The difference of two \ref read gives the events in between.
+ *
+ * Inside containers or with a restrictive kernel.perf_event_paranoid, or on machines without these events, the counters are not
+ * \ref available: \ref read then only gives the wall time, and \ref why tells the reason.
+ */
+
+class Counters {
+public:
+	Counters();
+	~Counters();
+	Counters(const Counters&) = delete;
+	Counters& operator=(const Counters&) = delete;
+
+	bool available() const { return not events.empty(); }
+/*!
+ * Reason why the counters are not available, empty if they are
+ */
+	const std::string& why() const { return reason; }
+/*!
+ * Wall time and events counted since the counters were opened
+ */
+	Counts read() const;
+/*!
+ * Names of the events of \ref Counts, as written in the outputs: cycles, instructions, llc_misses, branch_misses
+ */
+	static const std::vector<std::string> Names;
+
+private:
+/*!
+ * File descriptors of the events, the first one leading the group; empty if they could not be opened
+ */
+	std::vector<int> events;
+	std::string reason;
+};
@@ -0,0 +1,98 @@
+#include "Footprint.h"
+#include "Network.h"
+#include <cmath>
+
+namespace {
+const double Map_link = 64;												// node of the map: tree pointers, key and intensity
+const double Row_link = sizeof(uint32_t) + sizeof(double);
+
+/*!
+ * Bytes of a link compressed with \p bits bits: the difference with the previous sender, then the intensity
+ */
+double compressed_link(const Footprint_parameters& p, const double& links, const int& bits)
+{
+	double gap = (links > 0 ? p.neurons/(links/p.neurons) : 1.0);
+	if (p.model == "small-world") gap = 1;
+	else if (p.model == "spatial") gap = std::sqrt((double)p.neurons);
+	double delta = (gap < 128 ? 1 : gap < 16384 ? 2 : gap < 2097152 ? 3 : 4);
+	return delta + bits/8;
+}
+}
+
+double Footprint::expected_links(const Footprint_parameters& p)
+{
+	double n = p.neurons, degree = (p.neurons > 1 ? std::min(std::floor(p.connectivity), n - 1) : 0.0);
+	if (p.model == "poisson" or p.model == "over-dispersed") return n*std::min(p.connectivity, n - 1);
+	if (p.model == "scale-free") return 2*std::max(1.0, std::floor(degree/2))*n;
+	if (p.model == "types") {
+		double links(0.0), probability = (p.neurons > 1 ? std::min(1.0, p.connectivity/(n - 1)) : 0.0);
+		std::vector<Type_block> blocks = Network::type_blocks(p.n_types, p.neurons);
+		for (const auto& post : blocks) {
+			for (const auto& pre : blocks) {
+				const Connectivity_matrix::Entry* entry = p.wiring.matrix.find(pre.name, post.name);
+				links += (entry ? entry->probability : probability)*(pre.last - pre.first)*(post.last - post.first);
+			}
+		}
+		return links;
+	}
+	return n*degree;
+}
+
+Footprint Footprint::estimate(const Footprint_parameters& p)
+{
+	Footprint footprint;
+	double n = p.neurons, l = expected_links(p);
+	double rows = l*Row_link + (n + 1)*sizeof(size_t);
+	bool random = not Generator::is_structured(p.model);
+	bool streamed = (p.stream_budget > 0);
+	bool map = random and not p.wiring.rows and not streamed;
+
+	// neurons, step buffers (drive, noise, firing neurons and ids, rows of the edits)
+	footprint.neurons = (size_t)(n*(sizeof(Neuron) + 4*sizeof(double) + 3*sizeof(void*)));
+
+	double building;
+	if (streamed) {														// the block being written, and the chunks being generated
+		building = (random ? 0.5 : 1.5)*p.stream_budget + 2*(n + 1)*sizeof(size_t);
+		if (random) building += n*sizeof(size_t);						// order in which the senders are drawn
+		else if (p.model == "scale-free") building += 8*l;				// list of the edges, then the senders of all the links
+	}
+	else if (map) building = l*Map_link + rows + n*sizeof(size_t);			// the rows are copied from the map
+	else if (random) {
+		double spread = n*(p.connectivity + (p.model == "over-dispersed" ? p.connectivity*p.connectivity : 0.0));
+		building = (l + 6*std::sqrt(spread))*Row_link + (n + 1)*sizeof(size_t) + n*sizeof(size_t);
+	}
+	else if (p.model == "scale-free") building = 13.5*l;					// list of the edges, then the rows
+	else if (p.model == "types") building = 1.8*rows;					// buffers of the chunks, then the rows
+	else building = rows;
+
+	double stored = rows + (map or p.reference ? l*Map_link : 0.0);
+	if (p.push) stored += rows;										// the transposed rows
+	if (p.bits > 0) {
+		stored = l*compressed_link(p, l, p.bits) + 3*n*sizeof(size_t);
+		building = std::max(building, rows + stored);
+	}
+	else if (streamed) stored = p.stream_budget + 2*n*sizeof(size_t);
+	if (p.reorder) building = std::max(building, 2*rows + (map ? l*Map_link : 0.0));
+	if (p.plasticity) stored += l*(sizeof(size_t) + sizeof(uint32_t)) + n*(sizeof(size_t) + 4*sizeof(double));
+	if (p.trials > 1) stored += n*(4*sizeof(double) + p.trials*5*sizeof(double));
+	if (p.validate) {													// the reference network, built once the first one is
+		building = stored + std::max(building, rows + l*Map_link);
+		stored = 2*stored + l*Map_link;
+		footprint.neurons *= 2;
+	}
+	footprint.building = (size_t)building;
+	footprint.links = (size_t)stored;
+
+	double outputs = (p.raster ? 2*n : 0.0) + (p.shards > 0 ? 2*n : 0.0);
+	if (p.archive_block > 0) outputs += 2*n/100*(p.archive_block + p.steps);	// a block, and the steps of each neuron
+	if (p.ring_slots > 0) outputs += p.ring_slots*(sizeof(uint32_t)*n + 64);
+	footprint.outputs = (size_t)outputs;
+	return footprint;
+}
+
+void Footprint::print(std::ostream *outstr) const
+{
+	auto mb = [](const size_t& bytes) { return (bytes + (1 << 19)) >> 20; };
+	*outstr << mb(peak()) << " MB (neurons " << mb(neurons) << ", building " << mb(building) << ", links " << mb(links)
+			<< ", outputs " << mb(outputs) << ")";
+}
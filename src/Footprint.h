@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Generator.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*! \struct Footprint_parameters
+ * What decides the memory of a run: the network (\p neurons, \p n_types, \p connectivity, \p model, \p wiring),
+ * the storage of its links and the engine, and the outputs written.
+ * - bits: bits of the compressed intensities, 0 for plain links; stream_budget: memory of the streamed links (bytes), 0 if not streamed,
+ * - reference: the map of the links is kept for the reference engine; push: their transposed rows are kept for the push engine,
+ * - validate: a second network runs alongside,
+ * - raster: lines of the output file are written; shards, archive_block (0 without archive), steps, ring_slots (0 without ring).
+ */
+struct Footprint_parameters {
+	size_t neurons = 0;
+	std::string n_types, model = "poisson";
+	double connectivity = _Connectivity_;
+	Wiring_parameters wiring;
+	int bits = 0;
+	size_t stream_budget = 0;
+	bool reference = false, push = false, validate = false, plasticity = false, reorder = false;
+	size_t trials = 1;
+	bool raster = true;
+	size_t shards = 0, archive_block = 0, steps = 0, ring_slots = 0;
+};
+
+/*! \class Footprint
+ * Memory a run is expected to need, computed from its parameters before the network is built.
+ *
+ * - \ref neurons: the neurons and the buffers of a step (drive, noise, firing neurons), per neuron,
+ * - \ref building: the links while they are generated: the map (about 64 bytes a link) and the rows (12 bytes a link) for the
+ *   random models, the rows and the buffers of the generator for the structured ones, and the copies made when the links
+ *   are reordered or compressed; streamed links are written to their file as they are generated, a few chunks at a time,
+ * - \ref links: the links while the network runs, as they are stored, with the plasticity and trial states,
+ * - \ref outputs: raster lines, spike archive, shared memory ring.
+ *
+ * The peak is the neurons and outputs, plus the largest of \ref building and \ref links. The number of links is the mean
+ * of the model; the archive assumes a spike per neuron every hundred steps. Compare with \ref Memory::peak_resident to calibrate.
+ */
+
+class Footprint {
+public:
+	static Footprint estimate(const Footprint_parameters& parameters);
+/*!
+ * Mean number of links of the network
+ */
+	static double expected_links(const Footprint_parameters& parameters);
+
+	size_t peak() const { return neurons + std::max(building, links) + outputs; }
+/*!
+ * Writes the peak and its parts in MB on \p outstr, e.g. "1520 MB (neurons 30, building 1490, links 240, outputs 2)"
+ */
+	void print(std::ostream *outstr) const;
+
+	size_t neurons = 0, building = 0, links = 0, outputs = 0;
+};
@@ -0,0 +1,320 @@
+#include "Generator.h"
+#include "Neuron.h"
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+const std::vector<std::string> Generator::Models {"small-world", "scale-free", "spatial", "types"};
+
+Connectivity_matrix Connectivity_matrix::parse(const std::string& spec)
+{
+	Connectivity_matrix matrix;
+	std::ifstream file(spec);
+	std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (not file.is_open()) {												// entries given directly
+		text = spec;
+		std::replace(text.begin(), text.end(), ',', '\n');
+		std::replace(text.begin(), text.end(), ':', ' ');
+	}
+	std::istringstream lines(text);
+	for (std::string line; std::getline(lines, line); ) {
+		if (line.find_first_not_of(" \t") == std::string::npos or line[line.find_first_not_of(" \t")] == '#') continue;
+		std::istringstream fields(line);
+		std::string pair;
+		double probability, intensity;
+		size_t arrow;
+		if (not (fields >> pair >> probability >> intensity) or (arrow = pair.find("->")) == std::string::npos)
+			throw std::runtime_error("Invalid entry of the connectivity matrix: " + line);
+		matrix.set(pair.substr(0, arrow), pair.substr(arrow + 2), probability, intensity);
+	}
+	return matrix;
+}
+
+void Connectivity_matrix::set(const std::string& pre, const std::string& post, const double& probability, const double& intensity)
+{
+	if (not Neuron::Neuron_types.count(pre) or not Neuron::Neuron_types.count(post))
+		throw std::runtime_error("Unknown type in the connectivity matrix: " + pre + "->" + post);
+	if (probability < 0 or probability > 1 or intensity < 0)
+		throw std::runtime_error("Invalid probability or intensity in the connectivity matrix for " + pre + "->" + post);
+	entries[{pre, post}] = {probability, intensity};
+}
+
+const Connectivity_matrix::Entry* Connectivity_matrix::find(const std::string& pre, const std::string& post) const
+{
+	auto entry = entries.find({pre, post});
+	return (entry == entries.end() ? nullptr : &entry->second);
+}
+
+bool Generator::is_structured(const std::string& model)
+{
+	return std::find(Models.begin(), Models.end(), model) != Models.end();
+}
+
+Generator::Generator(const size_t& size, const double& connectivity, const double& intensity, const Wiring_parameters& wiring)
+	: size(size), degree(size > 1 ? std::min((size_t)std::floor(connectivity), size - 1) : 0),
+	  connectivity(connectivity), intensity(intensity), wiring(wiring)
+{
+	if (this->wiring.threads == 0) this->wiring.threads = std::max(1u, std::thread::hardware_concurrency());
+	// one seed per chunk, drawn in order: the result does not depend on the number of threads
+	for (size_t first(0); first<size; first+=Chunk) seeds.push_back((unsigned long)_RNG->uniform_int(1, 2147483647));
+}
+
+void Generator::generate(const std::string& model, Topology& topology)
+{
+	if (model == "small-world") small_world(topology);
+	else if (model == "scale-free") scale_free(topology);
+	else if (model == "spatial") spatial(topology);
+	else if (model == "types") block_types(topology);
+	else throw std::runtime_error("Unknown connectivity model " + model);
+}
+
+void Generator::generate(const std::string& model, const StreamedTopology::Row& row, const size_t& budget)
+{
+	// chunks generated together: one per thread, as long as their links expected fit in the budget
+	double chunk_bytes = Chunk*std::max(1.0, connectivity)*(sizeof(uint32_t) + sizeof(double));
+	size_t wave = std::max<size_t>(1, std::min<size_t>(wiring.threads, (size_t)(budget/chunk_bytes)));
+	if (model == "scale-free") {
+		Array<size_t> start;
+		Array<uint32_t> pre;
+		attach(start, pre);
+		std::vector<double> weight;
+		for (size_t begin(0); begin<seeds.size(); begin += wave) {
+			size_t end = std::min(seeds.size(), begin + wave), first = start[begin*Chunk];
+			weight.resize(start[std::min(size, end*Chunk)] - first);
+			for_each_chunk(begin, end, [&](size_t first_row, size_t last_row, RandomNumbers& rng) {
+				for (size_t n(first_row); n<last_row; ++n) {
+					std::sort(pre.begin() + start[n], pre.begin() + start[n+1]);
+					for (size_t k(start[n]); k<start[n+1]; ++k) weight[k - first] = rng.uniform_double(0, 2*intensity);
+				}
+			});
+			for (size_t n(begin*Chunk); n<std::min(size, end*Chunk); ++n) {
+				row(n, View<uint32_t>(pre.data() + start[n], start[n+1] - start[n]), View<double>(weight.data() + start[n] - first, start[n+1] - start[n]));
+			}
+		}
+		return;
+	}
+	for (size_t begin(0); begin<seeds.size(); begin += wave) {
+		size_t end = std::min(seeds.size(), begin + wave);
+		Topology rows;
+		if (model == "small-world") small_world(rows, begin, end);
+		else if (model == "spatial") spatial(rows, begin, end);
+		else if (model == "types") block_types(rows, begin, end);
+		else throw std::runtime_error("Unknown connectivity model " + model);
+		for (size_t n(0); n<rows.size(); ++n) row(begin*Chunk + n, rows.inputs(n), rows.intensities(n));
+	}
+}
+
+template<class F> void Generator::for_each_chunk(const size_t& begin, const size_t& end, F fill)
+{
+	std::atomic<size_t> next(begin);
+	auto work = [&]() {
+		for (size_t c = next++; c<end; c = next++) {
+			RandomNumbers rng(seeds[c]);
+			fill(c*Chunk, std::min(size, (c+1)*Chunk), rng);
+		}
+	};
+	std::vector<std::thread> threads;
+	for (unsigned int t(1); t<std::min<size_t>(wiring.threads, end - begin); ++t) threads.push_back(std::thread(work));
+	work();
+	for (auto& t : threads) t.join();
+}
+
+template<class F> void Generator::remove_duplicates(const size_t& row, uint32_t* first, uint32_t* last, RandomNumbers& rng, F redraw)
+{
+	for (bool clean(false); not clean; ) {
+		std::sort(first, last);
+		clean = true;
+		for (uint32_t* p(first); p<last; ++p) {
+			if (*p == row or (p > first and *p == *(p-1))) {
+				*p = redraw(row, rng);
+				clean = false;
+			}
+		}
+	}
+}
+
+void Generator::small_world(Topology& topology)
+{
+	small_world(topology, 0, seeds.size());
+}
+
+void Generator::small_world(Topology& rows, const size_t& begin, const size_t& end)
+{
+	size_t first = begin*Chunk, count = std::min(size, end*Chunk) - first;
+	Array<size_t> start(count + 1);
+	for (size_t n(0); n<=count; ++n) start[n] = n*degree;			// every neuron receives exactly degree links
+	Array<uint32_t> pre(count*degree);
+	Array<double> weight(count*degree);
+
+	auto random_neuron = [this](const size_t&, RandomNumbers& rng) { return (uint32_t)rng.uniform_int(0, (int)size - 1); };
+	for_each_chunk(begin, end, [&](size_t first_row, size_t last_row, RandomNumbers& rng) {
+		for (size_t n(first_row); n<last_row; ++n) {
+			uint32_t* row = &pre[start[n - first]];
+			for (size_t k(0); k<degree; ++k) {
+				// k-th closest neighbour on the ring, alternating sides: n+1, n-1, n+2, n-2...
+				size_t distance = k/2 + 1;
+				size_t neighbour = (k % 2 == 0 ? (n + distance) % size : (n + size - distance % size) % size);
+				row[k] = (rng.uniform_double() < wiring.rewiring ? random_neuron(n, rng) : (uint32_t)neighbour);
+			}
+			remove_duplicates(n, row, row + degree, rng, random_neuron);
+			for (size_t k(start[n - first]); k<start[n - first + 1]; ++k) weight[k] = rng.uniform_double(0, 2*intensity);
+		}
+	});
+	rows.assign(std::move(start), std::move(pre), std::move(weight));
+}
+
+void Generator::attach(Array<size_t>& start, Array<uint32_t>& pre)
+{
+	// preferential attachment, sequential: every link appears twice in the list of ends,
+	// so that picking a uniform element of the list picks a neuron proportionally to its degree
+	size_t m = std::max<size_t>(1, degree/2);
+	std::vector<std::pair<uint32_t, uint32_t>> edges;
+	std::vector<uint32_t> ends;
+	edges.reserve(m*size);
+	ends.reserve(2*m*size);
+	RandomNumbers rng(seeds.empty() ? 1 : seeds[0]);
+	std::vector<uint32_t> targets;
+	for (size_t n(std::min(m, size)); n<size; ++n) {
+		targets.clear();
+		while (targets.size() < std::min(m, n)) {
+			uint32_t t = (ends.empty() ? (uint32_t)targets.size() : ends[rng.uniform_int(0, (int)ends.size() - 1)]);
+			if (std::find(targets.begin(), targets.end(), t) == targets.end()) targets.push_back(t);
+		}
+		for (const auto& t : targets) {
+			edges.push_back({(uint32_t)n, t});
+			ends.push_back((uint32_t)n);
+			ends.push_back(t);
+		}
+	}
+	std::vector<uint32_t>().swap(ends);
+
+	// counting sort of both directions of every edge into rows
+	start.assign(size + 1, 0);
+	for (const auto& e : edges) {
+		++start[e.first + 1];
+		++start[e.second + 1];
+	}
+	for (size_t n(0); n<size; ++n) start[n+1] += start[n];
+	pre.resize(start[size]);
+	std::vector<size_t> fill(start.begin(), start.end() - 1);
+	for (const auto& e : edges) {
+		pre[fill[e.first]++] = e.second;
+		pre[fill[e.second]++] = e.first;
+	}
+}
+
+void Generator::scale_free(Topology& topology)
+{
+	Array<size_t> start;
+	Array<uint32_t> pre;
+	attach(start, pre);
+	Array<double> weight(start[size]);
+	for_each_chunk(0, seeds.size(), [&](size_t first, size_t last, RandomNumbers& rng) {
+		for (size_t n(first); n<last; ++n) {
+			std::sort(pre.begin() + start[n], pre.begin() + start[n+1]);
+			for (size_t k(start[n]); k<start[n+1]; ++k) weight[k] = rng.uniform_double(0, 2*intensity);
+		}
+	});
+	topology.assign(std::move(start), std::move(pre), std::move(weight));
+}
+
+void Generator::spatial(Topology& topology)
+{
+	spatial(topology, 0, seeds.size());
+}
+
+void Generator::spatial(Topology& rows, const size_t& begin, const size_t& end)
+{
+	// neuron n is at (n % side, n / side) on a torus of side x lines cells, the last line being possibly incomplete
+	size_t side = std::max<size_t>(1, (size_t)std::ceil(std::sqrt((double)size)));
+	size_t lines = (size + side - 1)/side;
+	size_t first = begin*Chunk, count = std::min(size, end*Chunk) - first;
+	Array<size_t> start(count + 1);
+	for (size_t n(0); n<=count; ++n) start[n] = n*degree;
+	Array<uint32_t> pre(count*degree);
+	Array<double> weight(count*degree);
+
+	const double sigma = wiring.sigma;
+	auto nearby_neuron = [&](const size_t& n, RandomNumbers& rng) {
+		for (int attempt(0); attempt<1000; ++attempt) {
+			long dx = std::lround(rng.normal(0, sigma)), dy = std::lround(rng.normal(0, sigma));
+			long x = ((long)(n % side) + dx) % (long)side, y = ((long)(n / side) + dy) % (long)lines;
+			size_t m = (size_t)((x < 0 ? x + side : x) + (y < 0 ? y + lines : y)*side);
+			if (m < size and m != n) return (uint32_t)m;
+		}
+		return (uint32_t)rng.uniform_int(0, (int)size - 1);		// the neighbourhood is too small for the connectivity
+	};
+	for_each_chunk(begin, end, [&](size_t first_row, size_t last_row, RandomNumbers& rng) {
+		for (size_t n(first_row); n<last_row; ++n) {
+			uint32_t* row = &pre[start[n - first]];
+			for (size_t k(0); k<degree; ++k) row[k] = nearby_neuron(n, rng);
+			remove_duplicates(n, row, row + degree, rng, nearby_neuron);
+			for (size_t k(start[n - first]); k<start[n - first + 1]; ++k) weight[k] = rng.uniform_double(0, 2*intensity);
+		}
+	});
+	rows.assign(std::move(start), std::move(pre), std::move(weight));
+}
+
+void Generator::block_types(Topology& topology)
+{
+	block_types(topology, 0, seeds.size());
+}
+
+void Generator::block_types(Topology& rows, const size_t& begin, const size_t& end)
+{
+	std::vector<Type_block> blocks(types);
+	if (blocks.empty()) blocks.push_back({"", 0, size});
+	// links[post][pre]: probability and intensity of the links from block pre to block post
+	double probability = (size > 1 ? std::min(1.0, connectivity/(size - 1)) : 0.0);
+	std::vector<std::vector<Connectivity_matrix::Entry>> links(blocks.size());
+	for (size_t post(0); post<blocks.size(); ++post) {
+		for (const auto& pre : blocks) {
+			const Connectivity_matrix::Entry* entry = wiring.matrix.find(pre.name, blocks[post].name);
+			links[post].push_back(entry ? *entry : Connectivity_matrix::Entry{probability, intensity});
+		}
+	}
+
+	// the rows of each chunk are generated into their own buffers, then copied at their place once the degrees are known
+	size_t first = begin*Chunk, count = std::min(size, end*Chunk) - first;
+	Array<size_t> start(count + 1, 0);
+	std::vector<std::vector<uint32_t>> chunk_pre(end - begin);
+	std::vector<std::vector<double>> chunk_weight(end - begin);
+	for_each_chunk(begin, end, [&](size_t first_row, size_t last_row, RandomNumbers& rng) {
+		std::vector<uint32_t>& row = chunk_pre[first_row/Chunk - begin];
+		std::vector<double>& weight = chunk_weight[first_row/Chunk - begin];
+		size_t post(0);
+		for (size_t n(first_row); n<last_row; ++n) {
+			while (post + 1 < blocks.size() and n >= blocks[post].last) ++post;
+			size_t before = row.size();
+			for (size_t b(0); b<blocks.size(); ++b) {
+				const Connectivity_matrix::Entry& entry = links[post][b];
+				if (entry.probability <= 0) continue;
+				// each neuron of the block is picked with the given probability: the gap to the next one is geometric
+				double log_q = std::log(1.0 - entry.probability);
+				for (size_t m(blocks[b].first); m<blocks[b].last; ++m) {
+					if (entry.probability < 1) {
+						double gap = std::floor(std::log(1.0 - rng.uniform_double())/log_q);
+						if (gap >= (double)(blocks[b].last - m)) break;
+						m += (size_t)gap;
+					}
+					if (m == n) continue;
+					row.push_back((uint32_t)m);
+					weight.push_back(rng.uniform_double(0, 2*entry.intensity));
+				}
+			}
+			start[n - first + 1] = row.size() - before;
+		}
+	});
+	for (size_t n(0); n<count; ++n) start[n+1] += start[n];
+	Array<uint32_t> pre(start[count]);
+	Array<double> weight(start[count]);
+	for_each_chunk(begin, end, [&](size_t first_row, size_t, RandomNumbers&) {
+		size_t c = first_row/Chunk - begin;
+		std::copy(chunk_pre[c].begin(), chunk_pre[c].end(), pre.begin() + start[first_row - first]);
+		std::copy(chunk_weight[c].begin(), chunk_weight[c].end(), weight.begin() + start[first_row - first]);
+		std::vector<uint32_t>().swap(chunk_pre[c]);
+		std::vector<double>().swap(chunk_weight[c]);
+	});
+	rows.assign(std::move(start), std::move(pre), std::move(weight));
+}
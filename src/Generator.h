@@ -0,0 +1,148 @@
+#pragma once
+
+#include "Topology.h"
+#include "StreamedTopology.h"
+#include "Random.h"
+#include <map>
+#include <string>
+
+/*! \class Connectivity_matrix
+ * Probability and mean intensity of the links from the neurons of each type to the neurons of each type, used by the "types" model.
+ *
+ * It is written as entries "PRE->POST:probability:intensity" separated by commas, e.g. "FS->RS:0.3:8,RS->FS:0.02:2",
+ * or as a file with one entry "PRE->POST probability intensity" per line, the lines starting with # being skipped.
+ * The pairs of types not given keep the probability connectivity/(size-1) and the intensity of the other models.
+ */
+class Connectivity_matrix {
+public:
+	struct Entry {double probability, intensity;};
+/*!
+ * Reads the matrix from the file \p spec if there is one with this name, from the entries of \p spec otherwise.
+ * Throws a std::runtime_error on unknown types, probabilities outside [0, 1] or negative intensities.
+ */
+	static Connectivity_matrix parse(const std::string& spec);
+	void set(const std::string& pre, const std::string& post, const double& probability, const double& intensity);
+/*!
+ * Entry of the links from the type \p pre to the type \p post, nullptr if not given
+ */
+	const Entry* find(const std::string& pre, const std::string& post) const;
+	bool empty() const { return entries.empty(); }
+
+private:
+	std::map<std::pair<std::string, std::string>, Entry> entries;
+};
+
+/*! \struct Type_block
+ * The neurons \p first to \p last -1, all of type \p name: the \ref Network lays out the neurons of each type contiguously
+ */
+struct Type_block {std::string name;
+				   size_t first, last;};
+
+/*! \struct Wiring_parameters
+ * Parameters of the structured connectivity models, in addition to the connectivity and intensity:
+ * - rewiring: probability to rewire each link of the small-world model,
+ * - sigma: standard deviation, in grid units, of the distance between connected neurons in the spatial model,
+ * - threads: number of threads generating the links, 0 for one per core,
+ * - matrix: links between each pair of types of the "types" model,
+ * - rows: the random models write their links directly as rows (\ref Network::connect_rows), without the map,
+ * - stream: file to which the links are written as they are generated, keeping about stream_budget bytes of them in memory
+ *   (see \ref Network::stream), empty to build them in memory.
+ */
+struct Wiring_parameters {
+	Wiring_parameters() : rewiring(_Rewiring_), sigma(_Sigma_), threads(0), rows(false), stream_budget(0) {}
+	double rewiring, sigma;
+	unsigned int threads;
+	bool rows;
+	std::string stream;
+	size_t stream_budget;
+	Connectivity_matrix matrix;
+};
+
+/*! \class Generator
+ * Generates structured networks directly in the compact \ref Topology, in a time proportional to the number of links:
+ * - "small-world": Watts-Strogatz ring lattice, each neuron receiving the inputs of its \p connectivity closest
+ *   neighbours on the ring, each of these links being rewired to a random neuron with probability \ref Wiring_parameters::rewiring,
+ * - "scale-free": Barabasi-Albert preferential attachment, each new neuron being linked in both directions
+ *   to \p connectivity /2 neurons picked with a probability proportional to their degree,
+ * - "spatial": neurons laid out on a 2D torus grid, each one receiving \p connectivity inputs from neurons
+ *   at a normally distributed distance of standard deviation \ref Wiring_parameters::sigma,
+ * - "types": each neuron receives a link from each neuron of type PRE with the probability of \ref Wiring_parameters::matrix
+ *   for its pair of types, with its intensity. A row is generated block of senders by block of senders (see \ref set_types):
+ *   the gaps between the senders picked are drawn from a geometric law, in a time proportional to the number of links
+ *   rather than to the size of the blocks, and the senders come out sorted, grouped by type.
+ *
+ * Rows are generated by chunks of \ref Chunk neurons, distributed over the threads. Each chunk has its own
+ * random generator, seeded from the global one: the network only depends on the seed, not on the number of threads.
+ * The preferential attachment is sequential by nature; only its conversion to rows and the intensities are parallel.
+ *
+ * The intensity of each link is picked uniformly between 0 and 2* \p intensity, as for the random models of the \ref Network.
+ */
+
+class Generator {
+public:
+/*!
+ * Prepares the generation of a network of \p size neurons
+ */
+	Generator(const size_t& size, const double& connectivity, const double& intensity, const Wiring_parameters& wiring);
+/*!
+ * Names of the structured models
+ */
+	static const std::vector<std::string> Models;
+/*!
+ * True if \p model is generated by this class rather than by \ref Network::random_connect
+ */
+	static bool is_structured(const std::string& model);
+/*!
+ * Generates the model \p model into \p topology
+ */
+	void generate(const std::string& model, Topology& topology);
+/*!
+ * Generates the same links, calling \p row for each row in order, without the whole \p topology in memory: the chunks are
+ * generated a few at a time, their links taking at most about \p budget bytes. The scale-free model keeps the sending neurons
+ * of all the links, which the preferential attachment needs, but not their intensities.
+ */
+	void generate(const std::string& model, const StreamedTopology::Row& row, const size_t& budget);
+/*!
+ * Layout of the types of the neurons, needed by the "types" model
+ */
+	void set_types(const std::vector<Type_block>& blocks) { types = blocks; }
+
+	void small_world(Topology& topology);
+	void scale_free(Topology& topology);
+	void spatial(Topology& topology);
+	void block_types(Topology& topology);
+
+/*!
+ * Number of neurons whose rows are generated together by one thread
+ */
+	static const size_t Chunk = 4096;
+
+private:
+/*!
+ * Calls \p fill(first, last, rng) for each chunk of rows [first, last), in parallel, from the chunk \p begin to the chunk \p end -1
+ */
+	template<class F> void for_each_chunk(const size_t& begin, const size_t& end, F fill);
+/*! @name Rows of some chunks
+ * Generate the rows of the chunks \p begin to \p end -1 into \p rows, whose row k is the row of the neuron \p begin * \ref Chunk + k
+ */
+///@{
+	void small_world(Topology& rows, const size_t& begin, const size_t& end);
+	void spatial(Topology& rows, const size_t& begin, const size_t& end);
+	void block_types(Topology& rows, const size_t& begin, const size_t& end);
+///@}
+/*!
+ * Preferential attachment of the scale-free model: \p start and \p pre are the rows of all the neurons, not sorted yet
+ */
+	void attach(Array<size_t>& start, Array<uint32_t>& pre);
+/*!
+ * Sorts the rows, and replaces the links that are duplicated or loops by calling \p redraw(row, rng) until there are none
+ */
+	template<class F> void remove_duplicates(const size_t& row, uint32_t* first, uint32_t* last, RandomNumbers& rng, F redraw);
+
+	size_t size;
+	size_t degree;
+	double connectivity, intensity;
+	Wiring_parameters wiring;
+	std::vector<Type_block> types;
+	std::vector<unsigned long> seeds;
+};
@@ -0,0 +1,111 @@
+#include "MeanField.h"
+#include <cmath>
+
+MeanField::MeanField(const size_t& number, const std::string& n_types, const double& d, const double& connectivity, const std::string& model,
+					 const double& intensity, const Wiring_parameters& wiring, const size_t& samples)
+	: types(Network::type_blocks(n_types, number)), samples(samples), rng((unsigned long)_RNG->uniform_int(1, 2147483647))
+{
+	if (samples == 0) throw std::runtime_error("The mean field needs at least one sample neuron of each type.");
+	size_t T = types.size();
+	weight.assign(T*T, intensity);
+	for (size_t post(0); post<T; ++post) {
+		for (size_t pre(0); pre<T; ++pre) {
+			const Connectivity_matrix::Entry* entry = wiring.matrix.find(types[pre].name, types[post].name);
+			if (model == "types" and entry) weight[post*T + pre] = entry->intensity;
+		}
+	}
+	for (const auto& w : weight) square.push_back(4.0*w*w/3.0);			// uniform in [0, 2w]
+
+	in.assign(T*samples*T, 0.0);
+	for (size_t k(0); k<T; ++k) {
+		for (size_t i(0); i<samples; ++i) {
+			neurons.push_back(Neuron(types[k].name, d));
+			draw_inputs(k, number, connectivity, model, wiring, &in[(k*samples + i)*T]);
+		}
+		excitatory.push_back(Neuron::Neuron_types.at(types[k].name).excit);
+	}
+	fraction.assign(T, 0.0);
+	firing.assign(T, 0.0);
+}
+
+void MeanField::draw_inputs(const size_t& post, const size_t& number, const double& connectivity, const std::string& model,
+							const Wiring_parameters& wiring, double *counts) const
+{
+	size_t T = types.size();
+	double degree = (number > 1 ? std::min(std::floor(connectivity), (double)(number - 1)) : 0.0);
+	if (model == "types") {
+		double probability = (number > 1 ? std::min(1.0, connectivity/(number - 1)) : 0.0);
+		for (size_t pre(0); pre<T; ++pre) {
+			const Connectivity_matrix::Entry* entry = wiring.matrix.find(types[pre].name, types[post].name);
+			double p = (entry ? entry->probability : probability);
+			size_t senders = types[pre].last - types[pre].first - (pre == post ? 1 : 0);
+			counts[pre] = (p > 0 ? _RNG->poisson(p*senders) : 0.0);			// binomial with many senders and a small probability
+		}
+		return;
+	}
+	if (model == "spatial") {
+		counts[post] = degree;
+		return;
+	}
+	double k = degree, local(0.0);
+	if (model == "small-world") local = (1.0 - wiring.rewiring)*degree;
+	else if (model == "scale-free") {
+		// degrees of the preferential attachment: at least m, P(k > x) = (m/x)^2, hence a mean of 2m
+		double m = std::max(1.0, std::floor(degree/2));
+		k = std::min(std::floor(m/std::sqrt(1.0 - _RNG->uniform_double())), (double)(number - 1));
+	}
+	else if (not Generator::is_structured(model)) k = std::min<double>(Network::calculate_connections(connectivity, model), number - 1);
+	for (size_t pre(0); pre<T; ++pre) counts[pre] = (k - local)*(types[pre].last - types[pre].first)/number;
+	counts[post] += local;
+}
+
+void MeanField::set_integrator(const std::string& method, const double& step)
+{
+	if (step <= 0) throw std::runtime_error("The time step must be positive.");
+	integrator = Neuron::Integrators.at(method);
+	dt = step;
+}
+
+const std::vector<double>& MeanField::update()
+{
+	size_t T = types.size();
+	for (size_t k(0); k<T; ++k) {										// fraction of each population firing at the beginning of the step
+		size_t count(0);
+		for (size_t i(k*samples); i<(k+1)*samples; ++i) count += neurons[i].firing();
+		fraction[k] = (double)count/samples;
+		firing[k] = fraction[k]*(types[k].last - types[k].first);
+	}
+	for (size_t k(0); k<T; ++k) {
+		for (size_t i(k*samples); i<(k+1)*samples; ++i) {
+			Neuron& neuron = neurons[i];
+			if (neuron.firing()) {
+				neuron.reset();
+				continue;
+			}
+			// each input fires with probability r and sends sign*w: mean r*sign*w, variance (r*E[w^2] - r^2*w^2)*sign^2
+			double synaptic(0.0), spread(0.0);
+			const double *counts = &in[i*T];
+			for (size_t pre(0); pre<T; ++pre) {
+				if (fraction[pre] == 0.0 or counts[pre] == 0.0) continue;
+				double sign = (excitatory[pre] ? 0.5 : -1.0), r = fraction[pre], w = weight[k*T + pre];
+				synaptic += counts[pre]*r*sign*w;
+				spread += counts[pre]*(r*square[k*T + pre] - r*r*w*w)*sign*sign;
+			}
+			if (spread > 0) synaptic += std::sqrt(spread)*rng.normal(0, 1);
+			double noise = rng.normal(0, 1);
+			double current = (excitatory[k] ? 5.0*noise : 2.0*noise);
+			if (dt != _Time_Step_) current /= std::sqrt(dt);
+			neuron.set_current(current + synaptic/dt);
+			neuron.equation(dt, integrator);
+		}
+	}
+	return firing;
+}
+
+double MeanField::inputs(const size_t& post, const size_t& pre) const
+{
+	size_t T = types.size();
+	double sum(0.0);
+	for (size_t i(post*samples); i<(post+1)*samples; ++i) sum += in[i*T + pre];
+	return sum/samples;
+}
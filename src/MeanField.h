@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Network.h"
+#include <string>
+#include <vector>
+
+/*! \class MeanField
+ * Approximation of a \ref Network giving the firing rate of each type of neuron, without simulating every neuron nor any link.
+ *
+ * It is built from the parameters of the \ref Network: each type is represented by a population of \p samples neurons,
+ * whose parameters are drawn as those of the network (margin \p d). Each sample receives, from each type S, the number of
+ * inputs k_S a neuron of its type would receive in the network, drawn with the connectivity model:
+ * - "constant", "poisson", "over-dispersed": the number of inputs of the model, spread over the types by their proportions,
+ * - "scale-free": a number of inputs of the power law of the preferential attachment, with the same mean,
+ * - "small-world": the ring neighbours are mostly of the same type (the types having contiguous ids), the rewired links
+ *   spread over the types by their proportions,
+ * - "spatial": all the inputs come from the same type, the neighbours on the grid having close ids,
+ * - "types": k_S drawn from the probability of the \ref Connectivity_matrix, with its intensity.
+ *
+ * In a large network the inputs of a neuron are many independent senders. At each step, each sample receives the mean of the sum
+ * of its k_S inputs from each type, k_S r_S w sign_S, plus a gaussian fluctuation with the variance of this sum: r_S is the fraction
+ * of the samples of type S firing at the beginning of the step, w the intensity of the links, uniform in [0, 2*intensity],
+ * sign_S 0.5 for an excitatory type and -1 for an inhibitory one, as in \ref Network::update. The noise is the one of the network.
+ *
+ * A step costs the number of samples: it does not depend on the size of the network, nor on its connectivity.
+ * The correlations between the inputs of the neurons (shared senders, local structure) are left out.
+ */
+
+class MeanField {
+public:
+/*!
+ * Populations of \p samples neurons of each type of the \ref Network built with the same parameters
+ */
+	MeanField(const size_t& number, const std::string& n_types, const double& d, const double& connectivity, const std::string& model,
+			  const double& intensity, const Wiring_parameters& wiring = Wiring_parameters(), const size_t& samples = _Mean_Field_Samples_);
+
+	void set_integrator(const std::string& method, const double& step);
+	double get_time_step() const { return dt; }
+/*!
+ * Performs one step.
+ * \return the number of neurons of each type of the network firing at the beginning of the step, expected from the fraction of the samples firing
+ */
+	const std::vector<double>& update();
+
+/*!
+ * Neurons of each type in the network, with contiguous ids
+ */
+	const std::vector<Type_block>& get_types() const { return types; }
+	size_t get_samples() const { return samples; }
+/*!
+ * Mean number of inputs of the samples of type \p post from the neurons of type \p pre
+ */
+	double inputs(const size_t& post, const size_t& pre) const;
+
+private:
+/*!
+ * Draws into \p counts the number of inputs from each type of one sample neuron of type \p post
+ */
+	void draw_inputs(const size_t& post, const size_t& number, const double& connectivity, const std::string& model,
+					 const Wiring_parameters& wiring, double *counts) const;
+
+	std::vector<Type_block> types;
+	size_t samples;
+	std::vector<Neuron> neurons;										///< samples of type k: k*samples to (k+1)*samples -1
+	std::vector<char> excitatory;
+/*!
+ * in[i*T + S]: inputs of sample i from type S, weight[k*T + S] and square[k*T + S]: mean and mean square intensity
+ * of the links from type S to type k, T being the number of types
+ */
+	std::vector<double> in, weight, square;
+	std::vector<double> fraction, firing;
+	RandomNumbers rng;
+	Integrator integrator = Integrator::Euler;
+	double dt = _Time_Step_;
+};
@@ -0,0 +1,150 @@
+#include "Memory.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sched.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+bool Memory::huge_pages = false;
+
+void *Memory::allocate(const size_t& bytes)
+{
+	if (bytes < Huge_page) return ::operator new(bytes);
+	size_t mapped = (bytes + Huge_page - 1)/Huge_page*Huge_page;
+	void *p = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);	// pages are given on first write
+	if (p == MAP_FAILED) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+	if (huge_pages) madvise(p, mapped, MADV_HUGEPAGE);
+#endif
+	return p;
+}
+
+void Memory::release(void *p, const size_t& bytes)
+{
+	if (bytes < Huge_page) ::operator delete(p);
+	else munmap(p, (bytes + Huge_page - 1)/Huge_page*Huge_page);
+}
+
+std::vector<size_t> Memory::pages_per_node(const void *p, const size_t& bytes)
+{
+	std::vector<size_t> nodes;
+#ifdef SYS_move_pages
+	const size_t page = sysconf(_SC_PAGESIZE);
+	uintptr_t first = reinterpret_cast<uintptr_t>(p)/page*page;
+	size_t count = (reinterpret_cast<uintptr_t>(p) + bytes - first + page - 1)/page;
+	std::vector<void*> pages(count);
+	std::vector<int> status(count);
+	for (size_t k(0); k<count; ++k) pages[k] = reinterpret_cast<void*>(first + k*page);
+	if (count == 0 or syscall(SYS_move_pages, 0, count, pages.data(), nullptr, status.data(), 0) != 0) return nodes;
+	int highest(-1);
+	for (const auto& s : status) highest = std::max(highest, s);
+	nodes.assign(highest + 2, 0);
+	for (const auto& s : status) {
+		if (s >= 0) ++nodes[s];
+		else ++nodes.back();											// not allocated yet (or not readable)
+	}
+#endif
+	return nodes;
+}
+
+int Memory::current_node()
+{
+#ifdef SYS_getcpu
+	unsigned int cpu, node;
+	if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) return (int)node;
+#endif
+	return -1;
+}
+
+bool Memory::pin(const int& core)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(core, &set);
+	return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+std::vector<int> Memory::parse_cores(const std::string& list)
+{
+	std::vector<int> cores;
+	std::stringstream ss(list);
+	std::string item;
+	while (std::getline(ss, item, ',')) {
+		size_t dash = item.find('-');
+		try {
+			int first = std::stoi(item.substr(0, dash));
+			int last = (dash == std::string::npos ? first : std::stoi(item.substr(dash + 1)));
+			if (first < 0 or last < first) throw std::invalid_argument(item);
+			for (int c(first); c<=last; ++c) cores.push_back(c);
+		} catch (std::logic_error&) {
+			throw std::runtime_error("Invalid list of cores: " + list);
+		}
+	}
+	return cores;
+}
+
+namespace {
+/*!
+ * Value of the field \p key of a /proc file of "key: value kB" lines, in bytes; 0 if missing
+ */
+size_t proc_field(const std::string& path, const std::string& key)
+{
+	std::ifstream file(path);
+	std::string line;
+	while (std::getline(file, line)) {
+		if (line.compare(0, key.size(), key) == 0 and line.size() > key.size() and line[key.size()] == ':') {
+			return 1024*(size_t)std::strtoull(line.c_str() + key.size() + 1, nullptr, 10);
+		}
+	}
+	return 0;
+}
+
+size_t read_bytes(const std::string& path)
+{
+	std::ifstream file(path);
+	std::string value;
+	if (not (file >> value) or value == "max") return 0;
+	return (size_t)std::strtoull(value.c_str(), nullptr, 10);
+}
+}
+
+size_t Memory::available()
+{
+	size_t free = proc_field("/proc/meminfo", "MemAvailable");
+	size_t limit = read_bytes("/sys/fs/cgroup/memory.max"), used = read_bytes("/sys/fs/cgroup/memory.current");
+	if (limit == 0) {															// control groups v1
+		limit = read_bytes("/sys/fs/cgroup/memory/memory.limit_in_bytes");
+		used = read_bytes("/sys/fs/cgroup/memory/memory.usage_in_bytes");
+		if (limit >= ((size_t)1 << 60)) limit = 0;								// no limit
+	}
+	if (limit > 0) {
+		size_t left = (limit > used ? limit - used : 0);
+		free = (free > 0 ? std::min(free, left) : left);
+	}
+	return free;
+}
+
+size_t Memory::peak_resident()
+{
+	size_t peak = proc_field("/proc/self/status", "VmHWM");
+	if (peak > 0) return peak;
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) return 1024*(size_t)usage.ru_maxrss;
+	return 0;
+}
+
+bool Memory::reset_peak()
+{
+	std::ofstream clear("/proc/self/clear_refs");
+	clear << "5";
+	clear.close();
+	return not clear.fail();
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*! \class Memory
+ * Placement of the large arrays of the simulation on multi-socket (NUMA) machines.
+ *
+ * Linux gives a page the memory node of the thread that first writes it. The \ref Array of the simulation
+ * therefore do not write their elements when they are resized: each thread fills the part it will compute,
+ * and these pages end up on its own node. Large arrays can also be backed by huge pages (\ref set_huge_pages),
+ * and the threads can be pinned to chosen cores (\ref pin).
+ */
+
+class Memory {
+public:
+/*!
+ * Size from which arrays are mapped directly, aligned on huge pages
+ */
+	static const size_t Huge_page = 2*1024*1024;
+
+/*! @name Allocation
+ */
+///@{
+	static void *allocate(const size_t& bytes);
+	static void release(void *p, const size_t& bytes);
+/*!
+ * Asks for huge pages for the arrays allocated from now on (transparent huge pages)
+ */
+	static void set_huge_pages(const bool& enabled) { huge_pages = enabled; }
+///@}
+
+/*! @name Placement
+ */
+///@{
+/*!
+ * Number of pages of the \p bytes bytes at \p p on each memory node, the last element counting the pages
+ * that are not allocated yet. Empty when the system does not tell the node of a page.
+ */
+	static std::vector<size_t> pages_per_node(const void *p, const size_t& bytes);
+/*!
+ * Memory node of the core running the calling thread, -1 if unknown
+ */
+	static int current_node();
+/*!
+ * Pins the calling thread to the core \p core. Returns false if it is not possible.
+ */
+	static bool pin(const int& core);
+/*!
+ * Reads a list of cores such as "0,2,4-7"; throws a std::runtime_error if it is not valid
+ */
+	static std::vector<int> parse_cores(const std::string& list);
+///@}
+
+/*! @name Accounting
+ */
+///@{
+/*!
+ * Memory the process can still use (bytes): the memory available on the machine, or what is left under the limit
+ * of its control group if it is lower. 0 if unknown.
+ */
+	static size_t available();
+/*!
+ * Largest resident memory of the process so far (bytes), 0 if unknown
+ */
+	static size_t peak_resident();
+/*!
+ * Starts the count of \ref peak_resident again from the current resident memory. Returns false if it is not possible.
+ */
+	static bool reset_peak();
+///@}
+
+private:
+	static bool huge_pages;
+};
+
+/*! \class PageAllocator
+ * Allocator of the \ref Array: elements are left uninitialized by resize (default initialization), so that
+ * the first write to each page is done by the thread that uses it; memory comes from \ref Memory::allocate.
+ */
+template<class T>
+class PageAllocator {
+public:
+	typedef T value_type;
+	PageAllocator() {}
+	template<class U> PageAllocator(const PageAllocator<U>&) {}
+
+	T *allocate(size_t n) { return static_cast<T*>(Memory::allocate(n*sizeof(T))); }
+	void deallocate(T *p, size_t n) { Memory::release(p, n*sizeof(T)); }
+	template<class U> void construct(U *p) { ::new((void*)p) U; }
+	template<class U, class... Args> void construct(U *p, Args&&... args) { ::new((void*)p) U(std::forward<Args>(args)...); }
+
+	template<class U> bool operator==(const PageAllocator<U>&) const { return true; }
+	template<class U> bool operator!=(const PageAllocator<U>&) const { return false; }
+};
+
+/*!
+ * Large array of the simulation, see \ref PageAllocator
+ */
+template<class T> using Array = std::vector<T, PageAllocator<T>>;
@@ -3,57 +3,40 @@
 Network::Network()
 {}
 
-Network::Network(const size_t& number,const std::string& n_types, const double& d, const double& connectivity, const std::string& model, const double& intensity)
+Network::Network(const size_t& number,const std::string& n_types, const double& d, const double& connectivity, const std::string& model, const double& intensity,
+				 const Wiring_parameters& wiring)
 {
 	// Fonction that extract types proportions from a given n_types string
 	extract_types(n_types, number);
 
-	// Calculation of the number of Neurons of each type
-	int nb_RS  = (int)floor(number*types_proportions["RS"]);
-	int nb_IB  = (int)floor(number*types_proportions["IB"]);
-	int nb_FS  = (int)floor(number*types_proportions["FS"]);
-	int nb_LTS = (int)floor(number*types_proportions["LTS"]);
-	int nb_CH  = (int)floor(number*types_proportions["CH"]);
-
-	// creation of the good number of each type of neurons
-	int start = 0;
-	int stop = nb_RS;
-
-	for (int i(start); i<stop; ++i) {
-		Neuron n("RS", d);
-		neurons.push_back(n);
-	}
-	start += nb_RS;
-	stop += nb_IB;
-
-	for (int i(start); i<stop; ++i) {
-		Neuron n("IB", d);
-		neurons.push_back(n);
-	}
-	start += nb_IB;
-	stop += nb_FS;
-
-	for (int i(start); i<stop; ++i) {
-		Neuron n("FS", d);
-		neurons.push_back(n);
+	// creation of the good number of each type of neurons, the types having contiguous ids
+	std::vector<Type_block> blocks = type_blocks(n_types, number);
+	for (const auto& block : blocks) {
+		for (size_t i(block.first); i<block.last; ++i) neurons.push_back(Neuron(block.name, d));
 	}
-	start += nb_FS;
-	stop += nb_LTS;
 
-	for (int i(start); i<stop; ++i) {
-		Neuron n("LTS", d);
-		neurons.push_back(n);
+	// Creation of all links between neurons
+	if (wiring.stream.length()) {										// written to the file as they are drawn
+		streamed.reset(new StreamedTopology(get_size(), [&](const StreamedTopology::Row& row) {
+			if (Generator::is_structured(model)) {
+				Generator generator(get_size(), connectivity, intensity, wiring);
+				generator.set_types(blocks);
+				generator.generate(model, row, wiring.stream_budget);
+			}
+			else random_rows(connectivity, intensity, model, row);
+		}, wiring.stream, wiring.stream_budget));
+		links_stale = true;
+		finalize();
 	}
-	start += nb_LTS;
-	stop += nb_CH;
-
-	for (int i(start); i<stop; ++i) {
-		Neuron n("CH", d);
-		neurons.push_back(n);
+	else if (Generator::is_structured(model)) {
+		Generator generator(get_size(), connectivity, intensity, wiring);
+		generator.set_types(blocks);
+		generator.generate(model, topology);
+		links_stale = true;
+		finalize();
 	}
-
-	// Creation of all links between neurons
-	random_connect(connectivity, intensity, model);
+	else if (wiring.rows) connect_rows(connectivity, intensity, model);
+	else random_connect(connectivity, intensity, model);
 }
 
 void Network::extract_types(std::string n_types, int number)
@@ -87,6 +70,20 @@ void Network::extract_types(std::string n_types, int number)
 	}
 }
 
+std::vector<Type_block> Network::type_blocks(const std::string& n_types, const size_t& number)
+{
+	Network shape;
+	shape.extract_types(n_types, (int)number);
+	std::vector<Type_block> blocks;
+	size_t first(0);
+	for (const auto& type : {"RS", "IB", "FS", "LTS", "CH"}) {
+		size_t count = (size_t)floor(number*shape.types_proportions[type]);
+		if (count > 0) blocks.push_back({type, first, first + count});
+		first += count;
+	}
+	return blocks;
+}
+
 int Network::calculate_connections(double connectivity, std::string model)
 {
 	if(model == "constant") return (int)std::floor(connectivity);
@@ -104,9 +101,17 @@ int Network::calculate_connections(double connectivity, std::string model)
 bool Network::add_link(const size_t& n_r, const size_t& n_s, double i)
 {
 	if((n_r>=get_size()) or (n_s>=get_size()) or (n_r==n_s)) return false;			// check that the neurons exist and that the two neurons are not actually the same neuron.
+	if (not topology_dirty) {											// the topology is built: the link goes to the delta
+		double w;
+		if (is_removed(n_r) or is_removed(n_s) or find_link(internal_id(n_r), internal_id(n_s), w)) return false;
+		edit_link(internal_id(n_r), internal_id(n_s), true, i);
+		return true;
+	}
+	if (links_stale) materialize_links();
 	if (not links.count({n_r,n_s}))										// check that the map doesn't already contains a link for these neurons.
 	{
 		links[{n_r,n_s}] = i;
+		topology_dirty = true;
 		return true;
 	}else return false;
 }
@@ -136,8 +141,215 @@ void Network::random_connect(const double& connectivity, const double &i, const
 	}
 }
 
+void Network::random_rows(const double& connectivity, const double &i, const std::string &model, const StreamedTopology::Row& emit)
+{
+	size_t size = get_size();
+	std::vector<size_t> index(size);
+	for (size_t k(0); k<size; ++k) index[k] = k;
+	std::vector<std::pair<uint32_t, double>> row;
+	std::vector<uint32_t> pre;
+	std::vector<double> weight;
+	for (size_t j(0); j<size; ++j) {
+		_RNG->shuffle(index);
+		int link_number = calculate_connections(connectivity, model);
+		row.clear();
+		for (size_t m(0); m<size and (int)row.size()<link_number; ++m) {
+			double w = _RNG->uniform_double(0, 2*i);							// drawn even for the neuron itself, as by add_link
+			if (index[m] != j) row.push_back({(uint32_t)index[m], w});
+		}
+		std::sort(row.begin(), row.end());
+		pre.clear();
+		weight.clear();
+		for (const auto& link : row) {
+			pre.push_back(link.first);
+			weight.push_back(link.second);
+		}
+		emit(j, View<uint32_t>(pre.data(), pre.size()), View<double>(weight.data(), weight.size()));
+	}
+}
+
+void Network::connect_rows(const double& connectivity, const double &i, const std::string &model)
+{
+	size_t size = get_size();
+	// the links of the random models: their mean number, and a margin of six standard deviations for the spread of the degrees
+	double expected = size*connectivity, spread = size*(connectivity + (model == "over-dispersed" ? connectivity*connectivity : 0.0));
+	Array<size_t> start(size + 1, 0);
+	Array<uint32_t> pre;
+	Array<double> weight;
+	pre.reserve((size_t)(expected + 6*std::sqrt(spread)));
+	weight.reserve(pre.capacity());
+	random_rows(connectivity, i, model, [&](const size_t& j, const View<uint32_t>& senders, const View<double>& intensities) {
+		pre.insert(pre.end(), senders.begin(), senders.end());
+		weight.insert(weight.end(), intensities.begin(), intensities.end());
+		start[j+1] = pre.size();
+	});
+	topology.assign(std::move(start), std::move(pre), std::move(weight));
+	links_stale = true;
+	finalize();
+}
+
+bool Network::remove_link(const size_t& n_r, const size_t& n_s)
+{
+	double w;
+	if (n_r >= get_size() or n_s >= get_size()) return false;
+	if (topology_dirty) finalize();
+	if (not find_link(internal_id(n_r), internal_id(n_s), w)) return false;
+	edit_link(internal_id(n_r), internal_id(n_s), false, 0.0);
+	return true;
+}
+
+bool Network::set_intensity(const size_t& n_r, const size_t& n_s, const double& i)
+{
+	double w;
+	if (n_r >= get_size() or n_s >= get_size()) return false;
+	if (topology_dirty) finalize();
+	if (not find_link(internal_id(n_r), internal_id(n_s), w)) return false;
+	edit_link(internal_id(n_r), internal_id(n_s), true, i);
+	return true;
+}
+
+size_t Network::add_neuron(const std::string& type, const double& d)
+{
+	if (not Neuron::Neuron_types.count(type)) throw std::runtime_error("Unknown neuron type " + type + ".");
+	if (topology_dirty) finalize();
+	finish_compaction();												// the topology gets a new row
+	expand();
+	size_t n = get_size();
+	neurons.push_back(Neuron(type, d));
+	if (not external_of.empty()) {										// reordered neurons: the new one is stored last
+		external_of.push_back((uint32_t)n);
+		internal_of.push_back((uint32_t)n);
+	}
+	topology.add_rows(1);
+	outgoing_stale = true;
+	delta.resize(get_size());
+	if (not removed.empty()) removed.push_back(0);
+	drive.push_back(0.0);
+	noise.push_back(0.0);
+	firing_neurons.reserve(get_size());
+	firing_ids.reserve(get_size());
+	chunks.clear();
+	if (plasticity) plasticity.reset(new Plasticity(plasticity->get_parameters(), topology));
+	return n;
+}
+
+void Network::remove_neuron(const size_t& n)
+{
+	if (n >= get_size()) throw std::runtime_error("Unknown neuron " + std::to_string(n) + ".");
+	if (topology_dirty) finalize();
+	if (removed.empty()) removed.assign(get_size(), 0);
+	size_t i = internal_id(n);
+	removed[i] = 1;
+	neurons[i].set_potential(-65);										// it does not fire at the next step either
+	neurons[i].set_current(0.0);
+	last_removal = ++edits;
+}
+
+bool Network::find_link(const size_t& i, const size_t& s, double& w) const
+{
+	if (const TopologyDelta::Edit* edit = delta.find(i, (uint32_t)s)) {
+		w = edit->weight;
+		return edit->present;
+	}
+	if (compressed.empty() and not streamed) {							// the rows are sorted
+		View<uint32_t> inputs = topology.inputs(i);
+		const uint32_t *found = std::lower_bound(inputs.begin(), inputs.end(), (uint32_t)s);
+		if (found == inputs.end() or *found != s) return false;
+		w = topology.intensities(i)[found - inputs.begin()];
+		return true;
+	}
+	bool present(false);
+	for_each_base_input(i, [&](const uint32_t& m, const double& weight) {
+		if (m == s) {
+			present = true;
+			w = weight;
+		}
+	});
+	return present;
+}
+
+void Network::edit_link(const size_t& i, const size_t& s, const bool& present, const double& w)
+{
+	double base_weight(0.0);
+	const TopologyDelta::Edit* edit = delta.find(i, (uint32_t)s);
+	bool in_base = (edit ? edit->in_base : false);
+	if (edit) base_weight = (edit->present ? edit->weight : 0.0) - edit->change;
+	else {
+		delta.resize(get_size());
+		in_base = find_link(i, s, base_weight);
+	}
+	delta.set(i, (uint32_t)s, present, w, in_base, base_weight, ++edits);
+	links_stale = true;													// the map is rebuilt from the merged topology
+	// a background merge only reads the plain rows, which the plasticity changes at every step
+	if (delta.size() >= threshold and not compaction.valid() and not plasticity and compressed.empty() and not streamed) {
+		compaction_edits = edits;
+		const Topology& base = topology;
+		compaction = std::async(std::launch::async, [&base](const TopologyDelta& changes, const std::vector<char>& lesions) {
+			return TopologyDelta::merge(base, changes, lesions);
+		}, delta, removed);
+	}
+}
+
+void Network::finish_compaction()
+{
+	if (compaction.valid()) install(compaction.get(), compaction_edits);
+}
+
+void Network::install(Topology&& merged, const uint64_t& sequence)
+{
+	topology = std::move(merged);
+	delta.rebase(topology, sequence);
+	merged_edits = sequence;
+	chunks.clear();
+	outgoing_stale = true;
+	links_stale = true;
+	if (plasticity) plasticity.reset(new Plasticity(plasticity->get_parameters(), topology));
+}
+
+void Network::compact()
+{
+	if (topology_dirty) finalize();
+	finish_compaction();
+	if (delta.empty() and last_removal <= merged_edits) return;
+	expand();
+	install(TopologyDelta::merge(topology, delta, removed), edits);
+}
+
+void Network::materialize_links()
+{
+	compact();
+	expand();
+	links = (internal_of.empty() ? topology.to_links() : topology.permuted(internal_of).to_links());
+	links_stale = false;
+}
+
+void Network::finalize()
+{
+	if (not links_stale) {												// otherwise the topology was generated directly
+		topology.build(links, get_size());
+		if (not external_of.empty()) topology = topology.permuted(external_of);
+		compressed = CompressedTopology();
+		streamed.reset();
+		if (plasticity) plasticity.reset(new Plasticity(plasticity->get_parameters(), topology));
+	}
+	chunks.clear();
+	outgoing_stale = true;
+	firing_neurons.clear();
+	firing_neurons.reserve(get_size());
+	firing_ids.clear();
+	firing_ids.reserve(get_size());
+	drive.assign(get_size(), 0.0);
+	noise.assign(get_size(), 0.0);
+	sample_neurons.clear();
+	for (const auto& type : types_proportions) {
+		if(not (type.second == 0.0)) sample_neurons.push_back(find_first_neuron(type.first));
+	}
+	topology_dirty = false;
+}
+
 std::vector<std::pair<size_t, double>> Network::find_neighbours(const size_t &n)
 {
+	if (links_stale) materialize_links();
 	std::vector<std::pair<size_t, double>> neighbours;
 	std::pair<size_t, int> key_low(n, 0);								// creating the first possible key corresponding to the neuron n
 	std::pair<size_t, int> key_up(n, get_size());						// creating the last possible key corresponding to the neuron n
@@ -151,13 +363,116 @@ std::vector<std::pair<size_t, double>> Network::find_neighbours(const size_t &n)
 }
 
 
+void Network::reorder(const std::string& method)
+{
+	std::vector<uint32_t> order = Ordering::compute(method, get_topology());
+	if (not order.empty()) reorder(order);
+}
+
+void Network::reorder(const std::vector<uint32_t>& order)
+{
+	compact();															// the edits are merged first
+	expand();
+	std::vector<Neuron> placed;
+	placed.reserve(get_size());
+	std::vector<uint32_t> external(get_size());
+	for (size_t i(0); i<get_size(); ++i) {
+		placed.push_back(neurons[order[i]]);
+		external[i] = (uint32_t)external_id(order[i]);
+	}
+	neurons.swap(placed);
+	if (not removed.empty()) {
+		std::vector<char> moved(get_size());
+		for (size_t i(0); i<get_size(); ++i) moved[i] = removed[order[i]];
+		removed.swap(moved);
+	}
+	topology = topology.permuted(order);
+	chunks.clear();
+	outgoing_stale = true;
+	if (plasticity) plasticity.reset(new Plasticity(plasticity->get_parameters(), topology));
+	external_of.swap(external);
+	internal_of.resize(get_size());
+	for (size_t i(0); i<get_size(); ++i) internal_of[external_of[i]] = (uint32_t)i;
+}
+
+void Network::compress(const std::string& mode)
+{
+	int bits = CompressedTopology::bits_of(mode);
+	compact();															// the edits are merged first
+	expand();
+	if (bits == 0) return;
+	if (plasticity) throw std::runtime_error("Plastic links cannot be compressed.");
+	compressed = CompressedTopology(topology, bits);
+	topology = Topology();												// releases the plain rows and the map
+	Link().swap(links);
+	links_stale = true;
+}
+
+void Network::stream(const std::string& path, const size_t& budget)
+{
+	compact();															// the edits are merged first
+	expand();
+	if (plasticity) throw std::runtime_error("Plastic links cannot be streamed from a file.");
+	streamed.reset(new StreamedTopology(topology, path, budget));
+	topology = Topology();
+	Link().swap(links);
+	links_stale = true;
+}
+
+void Network::set_plasticity(const Plasticity_parameters& parameters)
+{
+	if ((parameters.max_weight < 0) or (parameters.tau_plus <= 0) or (parameters.tau_minus <= 0))
+		throw std::runtime_error("Invalid plasticity parameters.");
+	compact();															// the edits are merged first
+	expand();
+	plasticity.reset(new Plasticity(parameters, topology));
+	Link().swap(links);													// the map is rebuilt from the changed intensities when needed
+	links_stale = true;
+}
+
+void Network::set_stimulus(std::unique_ptr<Stimulus> stimulus, const size_t& start)
+{
+	if (stimulus) stimulus->check(get_size());
+	if (start > steps) throw std::runtime_error("A stimulus cannot start after the next step.");
+	this->stimulus = std::move(stimulus);
+	stimulus_start = start;
+}
+
+void Network::expand()
+{
+	if (not compressed.empty()) {
+		topology = compressed.expand();
+		compressed = CompressedTopology();
+		outgoing_stale = true;
+	}
+	if (streamed) {
+		topology = streamed->load();
+		streamed.reset();
+		outgoing_stale = true;
+	}
+}
+
+size_t Network::topology_bytes()
+{
+	if (topology_dirty) finalize();
+	if (streamed) return streamed->bytes();
+	return (compressed.empty() ? topology.bytes() : compressed.bytes()) + (engine == Engine::Push ? outgoing.bytes() : 0);
+}
+
+size_t Network::degree(const size_t& i) const
+{
+	size_t base = (streamed ? streamed->degree(i) : (compressed.empty() ? topology.degree(i) : compressed.degree(i)));
+	return (delta.empty() ? base : base + delta.degree_change(i));
+}
+
 double Network::valence(const size_t &n)
 {
+	if (topology_dirty) finalize();
 	double valence = 0.0;
-	for (const auto& link: find_neighbours(n)) {
-		if (neurons[link.first].get_params().excit) valence += link.second;
-		else valence -= link.second;
-	}
+	for_each_input(internal_id(n), [&](const uint32_t& m, const double& w) {
+		if (neurons[m].get_params().excit) valence += w;
+		else valence -= w;
+	});
 	return valence;
 }
 
@@ -172,86 +487,340 @@ bool Network::is_type(const std::string& type) const
 
 size_t Network::find_first_neuron(const std::string& type) const
 {
-	for (size_t i(0); i<get_size(); ++i) {
-		if (neurons[i].get_type() == type) return i;
+	for (size_t n(0); n<get_size(); ++n) {
+		if (neurons[internal_id(n)].get_type() == type) return n;
 	}
 	return 0;
 }
 
 
+void Network::set_integrator(const std::string& method, const double& step)
+{
+	if (step <= 0) throw std::runtime_error("The time step must be positive.");
+	integrator = Neuron::Integrators.at(method);
+	dt = step;
+}
+
+const std::map<std::string, Engine> Network::Engines {
+	{"pull",      Engine::Pull},
+	{"push",      Engine::Push},
+	{"reference", Engine::Reference}
+};
+
+void Network::set_engine(const std::string& name)
+{
+	if (Engines.count(name) == 0) throw std::runtime_error("Unknown engine " + name + ".");
+	engine = Engines.at(name);
+	if (engine != Engine::Push) {										// the transposed links are only kept for the push engine
+		outgoing = Topology();
+		Array<double>().swap(pushed);
+		outgoing_stale = true;
+	}
+}
+
+void Network::reset()
+{
+	if (topology_dirty) finalize();
+	for (auto& neuron : neurons) {										// the state given by the Neuron constructor
+		neuron.set_potential(-65);
+		neuron.set_recovery(neuron.get_params().b*neuron.get_potential());
+		neuron.set_current(0.0);
+	}
+	if (plasticity) plasticity.reset(new Plasticity(plasticity->get_parameters(), topology));
+	if (stimulus) stimulus->rewind();
+	steps = 0;
+	stimulus_start = 0;
+}
+
+double Network::noise_current(const size_t &n)
+{
+	double noise = (rng ? rng.get() : _RNG)->normal(0,1);					    // external noise is picked at random
+	double current = (neurons[n].get_params().excit ? 5.0*noise : 2.0*noise);
+	if (dt != _Time_Step_) current /= std::sqrt(dt);					// white noise: its variance scales with 1/dt
+	return current;
+}
+
 double Network::total_current(const size_t &n)
 {
-	double current(0.0);
-	double noise = _RNG->normal(0,1);								    // external noise is picked at random
-	if (neurons[n].get_params().excit) current = 5.0*noise;
-	else current = 2.0*noise;
-	for (const auto& neighbour : find_neighbours(n)) {
-		if (neurons[neighbour.first].firing()) {					    // check if neighbour is firing and thus sending a signal to neuron n
-			if (neurons[neighbour.first].get_params().excit) {
-					current+= neighbour.second*0.5;						// if firing and excitatory -> add half of the intensity of current
+	if (topology_dirty) finalize();
+	double current = noise_current(internal_id(n));
+	double synaptic(0.0);
+	for_each_input(internal_id(n), [&](const uint32_t& m, const double& w) {
+		if (neurons[m].firing()) {									    // check if neighbour is firing and thus sending a signal to neuron n
+			if (neurons[m].get_params().excit) {
+					synaptic+= w*0.5;									// if firing and excitatory -> add half of the intensity of current
 				}
-			else current-=  neighbour.second;							// if firing and inhibitory -> substract the intensity of the current
+			else synaptic-=  w;											// if firing and inhibitory -> substract the intensity of the current
+		}
+	});
+
+	return current + synaptic/dt;
+}
+
+double Network::synaptic_current(const View<uint32_t>& inputs, const View<double>& intensities) const
+{
+	double synaptic(0.0);
+	for (size_t k(0); k<inputs.size(); ++k) synaptic += intensities[k]*drive[inputs[k]];
+	return synaptic;
+}
+
+void Network::integrate_rows(const size_t& first, const size_t& last)
+{
+	if (not compressed.empty()) {
+		for (size_t i(first); i<last; ++i) {
+			if (drive[i] != 0.0 or (not removed.empty() and removed[i])) continue;
+			double synaptic = compressed.row_sum(i, drive.data());				// decoded on the fly
+			if (not delta.empty()) synaptic += delta.correction(i, drive.data());
+			neurons[i].set_current(noise[i] + synaptic/dt);
+			neurons[i].equation(dt, integrator);
 		}
 	}
+	else {
+		for (size_t i(first); i<last; ++i) integrate(i, topology.inputs(i), topology.intensities(i));
+	}
+}
 
-	return current;
+void Network::integrate_links()
+{
+	if (links_stale) materialize_links();
+	Link::const_iterator link = links.begin();
+	for (size_t n(0); n<get_size(); ++n) {								// the links are sorted by receiving neuron
+		double synaptic(0.0);
+		for (; link != links.end() and link->first.first == n; ++link) synaptic += link->second*drive[internal_id(link->first.second)];
+		size_t i = internal_id(n);
+		if (drive[i] != 0.0 or (not removed.empty() and removed[i])) continue;
+		neurons[i].set_current(noise[i] + synaptic/dt);
+		neurons[i].equation(dt, integrator);
+	}
 }
 
-std::vector<size_t> Network::update()
+void Network::integrate_pushed()
 {
-	std::vector<size_t> firing_neurons(0);					// creation of a temporary vector to store firing neurons and to update them after the others
+	if (outgoing_stale) {
+		outgoing = topology.transpose();
+		outgoing_stale = false;
+	}
+	pushed.assign(get_size(), 0.0);
+	for (const auto& m : firing_neurons) {								// in the order of the senders, as the rows sum them
+		View<uint32_t> targets = outgoing.inputs(m);
+		View<double> intensities = outgoing.intensities(m);
+		for (size_t k(0); k<targets.size(); ++k) pushed[targets[k]] += intensities[k]*drive[m];
+	}
 	for (size_t i(0); i<get_size(); ++i) {
-		if(neurons[i].firing()) {
-			firing_neurons.push_back(i);					// pushes firing neurons into the temporary vector
+		if (drive[i] != 0.0 or (not removed.empty() and removed[i])) continue;
+		double synaptic = pushed[i];
+		if (not delta.empty()) synaptic += delta.correction(i, drive.data());
+		neurons[i].set_current(noise[i] + synaptic/dt);
+		neurons[i].equation(dt, integrator);
+	}
+}
+
+void Network::set_threads(const unsigned int& threads, const bool& stealing)
+{
+	pool.reset(threads == 1 ? nullptr : new WorkPool(threads));
+	if (pool and pool->size() == 1) pool.reset();
+	this->stealing = stealing;
+	chunks.clear();
+}
+
+bool Network::pin_threads(const std::vector<int>& cores)
+{
+	if (pool) return pool->pin(cores);
+	return cores.empty() or Memory::pin(cores[0]);
+}
+
+void Network::place()
+{
+	if (topology_dirty) finalize();
+	finish_compaction();
+	if (not pool or not compressed.empty() or streamed) return;
+	if (chunks.empty()) make_chunks();
+	topology.place(chunks, *pool);
+	Array<double> placed_drive(get_size()), placed_noise(get_size());
+	pool->run(chunks.size() - 1, [&](const size_t& c) {
+		std::fill(placed_drive.begin() + chunks[c], placed_drive.begin() + chunks[c+1], 0.0);
+		std::fill(placed_noise.begin() + chunks[c], placed_noise.begin() + chunks[c+1], 0.0);
+	}, false);
+	drive.swap(placed_drive);
+	noise.swap(placed_noise);
+}
+
+std::vector<Network::Placement> Network::placement()
+{
+	std::vector<Placement> placement;
+	if (topology_dirty) finalize();
+	if (not pool or not compressed.empty() or streamed) return placement;
+	if (chunks.empty()) make_chunks();
+	size_t tasks = chunks.size() - 1;
+	std::vector<int> nodes(pool->size());
+	pool->run(pool->size(), [&](const size_t& w) { nodes[w] = Memory::current_node(); }, false);
+	for (unsigned int w(0); w<pool->size(); ++w) {						// the chunks of thread w, as dealt by WorkPool::run
+		size_t first = chunks[tasks*w/pool->size()], last = chunks[tasks*(w+1)/pool->size()];
+		if (first == last) continue;
+		size_t links = topology.first_link(last) - topology.first_link(first);
+		placement.push_back({first, last, nodes[w],
+							 Memory::pages_per_node(topology.inputs(first).data(), links*sizeof(uint32_t)),
+							 Memory::pages_per_node(topology.intensities(first).data(), links*sizeof(double)),
+							 Memory::pages_per_node(neurons.data() + first, (last - first)*sizeof(Neuron))});
+	}
+	return placement;
+}
+
+void Network::print_placement(std::ostream *outstr)
+{
+	std::vector<Placement> parts = placement();
+	for (size_t w(0); w<parts.size(); ++w) {
+		*outstr << "# partition " << w << "\trows " << parts[w].first << "-" << parts[w].last << "\tnode " << parts[w].node;
+		for (const auto& part : {std::make_pair("links", &parts[w].links), std::make_pair("intensities", &parts[w].intensities),
+								 std::make_pair("neurons", &parts[w].neurons)}) {
+			*outstr << "\t" << part.first << " pages per node";
+			for (size_t k(0); k<part.second->size(); ++k) *outstr << (k + 1 == part.second->size() ? " absent:" : " ") << (*part.second)[k];
 		}
-		else {
-			neurons[i].set_current(total_current(i));
-			neurons[i].equation();
+		*outstr << '\n';
+	}
+}
+
+void Network::make_chunks()
+{
+	chunks.assign(1, 0);
+	if (not stealing) {												// static partition: as many neurons for each thread
+		for (unsigned int w(1); w<=pool->size(); ++w) chunks.push_back(get_size()*w/pool->size());
+		return;
+	}
+	// a neuron costs its integration, about as much as Row_cost links, plus its links
+	const size_t Row_cost = 8;
+	size_t total(0);
+	for (size_t i(0); i<get_size(); ++i) total += degree(i) + Row_cost;
+	size_t target = std::max<size_t>(total/(Chunks_per_thread*pool->size()), 1);
+	size_t load(0);
+	for (size_t i(0); i<get_size(); ++i) {
+		load += degree(i) + Row_cost;
+		if (load >= target) {
+			chunks.push_back(i + 1);
+			load = 0;
+		}
+	}
+	if (chunks.back() != get_size()) chunks.push_back(get_size());
+}
+
+void Network::integrate(const size_t& i, const View<uint32_t>& inputs, const View<double>& intensities)
+{
+	if (drive[i] != 0.0 or (not removed.empty() and removed[i])) return;
+	double synaptic = synaptic_current(inputs, intensities);
+	if (not delta.empty()) synaptic += delta.correction(i, drive.data());	// links edited since the topology was built
+	neurons[i].set_current(noise[i] + synaptic/dt);
+	neurons[i].equation(dt, integrator);
+}
+
+const std::vector<std::string> Network::Phases {"drive", "noise", "integrate", "reset"};
+
+void Network::measure_phases(const bool& measure)
+{
+	counters.reset(measure ? new Counters() : nullptr);
+	phase_counts.assign(measure ? Phases.size() : 0, Counts());
+}
+
+void Network::lap(const size_t& phase)
+{
+	if (not counters) return;
+	Counts now = counters->read();
+	phase_counts[phase] = now - phase_end;
+	phase_end = now;
+}
+
+const std::vector<size_t>& Network::update()
+{
+	if (topology_dirty) finalize();
+	if (compaction.valid() and compaction.wait_for(std::chrono::seconds(0)) == std::future_status::ready) finish_compaction();
+	if (plasticity and (not delta.empty() or last_removal > merged_edits)) compact();	// the plasticity changes the rows in place
+	if (counters) phase_end = counters->read();
+	firing_neurons.clear();											// the buffers keep their capacity from one step to the next
+	for (size_t i(0); i<get_size(); ++i) {
+		if(neurons[i].firing()) {
+			firing_neurons.push_back(i);								// firing neurons are updated after the others
+			drive[i] = (neurons[i].get_params().excit ? 0.5 : -1.0);
 		}
+		else drive[i] = 0.0;
+	}
+	lap(0);
+	for (size_t n(0); n<get_size(); ++n) {							// noise is drawn in the order of the ids, whatever the storage order
+		size_t i = internal_id(n);
+		if (drive[i] == 0.0) noise[i] = noise_current(i);
+	}
+	if (stimulus) stimulus->inject(steps + 1 - stimulus_start, [this](const size_t& n, const double& current) { noise[internal_id(n)] += current; });
+	lap(1);
+	if (engine == Engine::Reference) integrate_links();
+	else if (engine == Engine::Push and compressed.empty() and not streamed and not plasticity) integrate_pushed();
+	else if (streamed) {
+		io_wait = streamed->stream([this](const size_t& i, const View<uint32_t>& inputs, const View<double>& intensities) {
+			integrate(i, inputs, intensities);
+		});
+	}
+	else if (pool) {
+		if (chunks.empty()) make_chunks();
+		pool->run(chunks.size() - 1, [this](const size_t& c) { integrate_rows(chunks[c], chunks[c+1]); }, stealing);
 	}
-	if(not firing_neurons.empty()) {								// the firing neurons are then updated
-		for(const auto& n : firing_neurons) neurons[n].reset();
+	else integrate_rows(0, get_size());
+	lap(2);
+	for(const auto& n : firing_neurons) neurons[n].reset();			// the firing neurons are then updated
+	if (plasticity and not firing_neurons.empty()) {
+		plasticity->spike(firing_neurons, steps, dt, topology);
+		links_stale = true;
 	}
-	return firing_neurons;
+	lap(3);
+	++steps;
+	if (external_of.empty()) return firing_neurons;
+
+	firing_ids.clear();
+	for (const auto& n : firing_neurons) firing_ids.push_back(external_of[n]);
+	std::sort(firing_ids.begin(), firing_ids.end());
+	return firing_ids;
 }
 
 void Network::print_parameters(std::ostream *outstr)
 {
+    if (topology_dirty) finalize();
     // Print of the header
     *outstr << "Type" << "\t"
 		    << "a" << "\t" << "b" << "\t" << "c" << "\t" << "d" << "\t" 
 		    << "Inhibitory" << "\t" << "degree" << "\t" << "valence"
 		    << std::endl;
-    for (size_t i(0); i<get_size(); ++i) {
+    for (size_t n(0); n<get_size(); ++n) {
 		  // Print the parameters
-		  *outstr << neurons[i].params_to_print()
-		  << "\t" << find_neighbours(i).size()
-		  << "\t" << valence(i)
+		  *outstr << neurons[internal_id(n)].params_to_print()
+		  << "\t" << degree(internal_id(n))
+		  << "\t" << valence(n)
 		  << std::endl;
       }
 }
 
-void Network::print_sample(const int& t, std::ostream *outstr)
+void Network::print_links(std::ostream *outstr)
 {
+	for (const auto& link : get_links()) *outstr << link.first.first << '\t' << link.first.second << '\t' << link.second << '\n';
+}
+
+void Network::print_sample(const int& t, std::ostream *outstr, const size_t& first, const size_t& last)
+{
+	  if (topology_dirty) finalize();
 	  *outstr << t ;
-	  for (const auto& type : types_proportions){
-		  if(not (type.second == 0.0)) print_properties(type.first, outstr);
-	  }
-      *outstr << std::endl;
+	  for (size_t k(first); k<std::min(last, sample_neurons.size()); ++k) print_properties(sample_neurons[k], outstr);
+      *outstr << '\n';
 }
 
-void Network::print_properties(const std::string& type, std::ostream *outstr)
+void Network::print_properties(const size_t& n, std::ostream *outstr)
 {
-	size_t n = find_first_neuron(type);
-	*outstr << neurons[n].variables_to_print();
+	neurons[internal_id(n)].print_variables(outstr);
 }
 
-void Network::header_sample(std::ostream *outstr)
+void Network::header_sample(std::ostream *outstr, const size_t& first, const size_t& last)
 {
+	size_t k(0);														// index of the sample neuron of each type present
 	for (const auto& type : types_proportions){
-		  if(not (type.second == 0.0)) *outstr << "\t" << type.first<< ".v"
-											   << "\t" << type.first << ".u"
-											   << "\t" << type.first << ".I";
+		  if (type.second == 0.0) continue;
+		  if (k >= first and k < last) *outstr << "\t" << type.first<< ".v"
+											 << "\t" << type.first << ".u"
+											 << "\t" << type.first << ".I";
+		  ++k;
 	  }
       *outstr << std::endl;
 }
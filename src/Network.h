@@ -1,20 +1,53 @@
 #pragma once
 
 #include "Neuron.h"
+#include "Generator.h"
+#include "Ordering.h"
+#include "CompressedTopology.h"
+#include "StreamedTopology.h"
+#include "TopologyDelta.h"
+#include "Plasticity.h"
+#include "Stimulus.h"
+#include "WorkPool.h"
+#include "Counters.h"
+#include <cstdint>
+#include <future>
+#include <memory>
+
+/*! \enum Engine
+ * Ways for \ref Network::update to gather the signals received by the neurons:
+ * - Pull: each neuron sums its inputs from the compact (possibly compressed, streamed or multi-threaded) links,
+ * - Push: each firing neuron adds its signal to the neurons it sends links to, from a transposed copy of the links, in the calling
+ *   thread. A step then costs the links of the firing neurons instead of all the links, faster when few neurons fire. The sums
+ *   are made in the same order as Pull, so the results are the same to the last bit. Compressed, streamed or plastic links are pulled.
+ * - Reference: each neuron sums its inputs by walking the map of links, in the order of the ids, in the calling thread.
+ *   It is the historical engine, slow but simple, kept to validate the others (see \ref Validation).
+ */
+enum class Engine {Pull, Push, Reference};
 
 /*! \class Network
  * A neuron network is a set of \ref Neuron and their connections.
  * Each \ref Neuron sends and receives signal from several other ones, thus creating a network.
  *
- * Neurons are identified by their index in the vector \ref neurons.
+ * Neurons are identified by their index in the order of construction. By default it is also their index
+ * in the vector \ref neurons, but \ref reorder can store them in another order to improve the locality
+ * of the \ref topology: all the methods of the class still take and return the original ids (external ids),
+ * while \ref neurons and \ref topology are indexed by internal ids (see \ref internal_id and \ref external_id).
  *
  * Links between \ref neurons are directional links listed in the map \ref links : the first
  * element of the map is the pair of neurons implicated in the link (first=receiving neuron,
  * second=sending neuron) and the second element is the intensity of connection.
+ *
+ * The structured models of \ref Generator write their links directly into the compact \ref topology: the map
+ * is then only built if it is accessed.
+ *
+ * Before running, the links are copied into the compact \ref topology. The buffers used at each step are
+ * allocated at the same time, so that \ref update does not allocate memory once the network is running.
+ *
+ * Once the topology is built, the network can be edited between steps (see "Editing the network"): the changed links
+ * are kept in the \ref delta, used by the next step, and merged into the \ref topology once they are many.
  */
 
-typedef std::map<std::pair<size_t, size_t>, double> Link;
-
 class Network {
 public:
 
@@ -34,8 +67,10 @@ public:
  * \param connectivity: average number of connection for a neuron
  * \param model: dispersion model to pick number of connection at random
  * \param intensity: average intensity of connections
+ * \param wiring: parameters of the structured models, and the file to which the links are streamed as they are drawn, if any
  */
-	Network(const size_t& number,const std::string& n_types, const double& d, const double& connectivity, const std::string& model, const double& intensity);
+	Network(const size_t& number,const std::string& n_types, const double& d, const double& connectivity, const std::string& model, const double& intensity,
+			const Wiring_parameters& wiring = Wiring_parameters());
 
 /*!
  * Allows to extract from a string the proportion of each specific type of \ref Neuron
@@ -43,20 +78,42 @@ public:
  * \param number: total number of \ref Neuron in the \ref Network
  */
 	void extract_types(std::string n_types, int number);
+/*!
+ * Neurons of each type (with at least one neuron) in a network of \p number neurons with the proportions \p n_types,
+ * in the order in which the constructor lays them out: RS, IB, FS, LTS, CH
+ */
+	static std::vector<Type_block> type_blocks(const std::string& n_types, const size_t& number);
 ///@}
 
 /*! @name Getters/setters
  */
 ///@{
 /*!
- * Provide access to the set of \ref Neuron.
+ * Provide access to the set of \ref Neuron, in the internal order.
  */
-	std::vector<Neuron> get_neurons() const { return neurons ; }
+	const std::vector<Neuron>& get_neurons() const { return neurons ; }
 	
 /*!
  * Provides access to the set of \ref links.
  */
-	Link get_links() const { return links ; }
+	const Link& get_links() { if (links_stale) materialize_links(); return links ; }
+/*!
+ * Provides access to the compact \ref topology, built from \ref links if they changed. It uses internal ids.
+ * A compressed topology is decoded back first (see \ref compress), and the edits are merged (see \ref compact).
+ */
+	const Topology& get_topology() { compact(); expand(); return topology; }
+/*!
+ * Memory used by the links during the simulation, in bytes
+ */
+	size_t topology_bytes();
+/*!
+ * Time spent waiting for the links read from the file during the last \ref update, in seconds (see \ref stream)
+ */
+	double get_io_wait() const { return io_wait; }
+/*!
+ * Provides access to the first \ref Neuron of each type present in the network, whose state is recorded by \ref print_sample
+ */
+	const std::vector<size_t>& get_sample_neurons() { if (topology_dirty) finalize(); return sample_neurons; }
 
 /*!
  * Provides access to the \ref noises
@@ -65,22 +122,103 @@ public:
 /*!
  * Provides access to the potential of neuron \p n
  */
-	double get_potential(const size_t& n) const { return neurons[n].get_potential(); }
+	double get_potential(const size_t& n) const { return neurons[internal_id(n)].get_potential(); }
 /*!
  * Provides access to the recovery of neuron \p n
  */
-	double get_recovery(const size_t& n) const { return neurons[n].get_recovery(); }
+	double get_recovery(const size_t& n) const { return neurons[internal_id(n)].get_recovery(); }
 /*!
  * Provides access to the current of neuron \p n
  */
-	double get_current(const size_t& n) const { return neurons[n].get_current(); }
+	double get_current(const size_t& n) const { return neurons[internal_id(n)].get_current(); }
 	size_t get_size() const { return neurons.size(); }
 /*!
  * Allows the test program to modify the potential of a \ref Neuron in the network
  * \param n (size_t): neuron to change potential
  * \param pot (double): new potential value
  */
-	void set_neuron_potential(const size_t &n, const double& pot) { neurons[n].set_potential(pot); }
+	void set_neuron_potential(const size_t &n, const double& pot) { neurons[internal_id(n)].set_potential(pot); }
+/*!
+ * Number of chunks of rows per thread of the \ref pool: enough for the threads to even out their load by stealing
+ */
+	static const size_t Chunks_per_thread = 16;
+/*!
+ * Computes the rows of \ref update with \p threads threads (0 for one per core). The rows are split into chunks holding
+ * about as many links, run by a \ref WorkPool; without \p stealing, each thread gets as many neurons (static partition).
+ * The results do not depend on the number of threads.
+ */
+	void set_threads(const unsigned int& threads, const bool& stealing = true);
+/*!
+ * Pins the threads of \ref update to \p cores (see \ref WorkPool::pin)
+ */
+	bool pin_threads(const std::vector<int>& cores);
+/*!
+ * Moves the links and the step buffers into memory first written by the thread computing them, i.e. onto its memory node.
+ * To be called once the links are final; it does nothing with a single thread or with compressed or streamed links.
+ */
+	void place();
+/*!
+ * Memory placement of the rows of one thread: node of the thread, and number of pages on each node (see \ref Memory::pages_per_node)
+ */
+	struct Placement {size_t first, last;
+					  int node;
+					  std::vector<size_t> links, intensities, neurons;};
+/*!
+ * Placement of the rows of each thread, empty with a single thread or with compressed or streamed links
+ */
+	std::vector<Placement> placement();
+/*!
+ * Prints the \ref placement
+ */
+	void print_placement(std::ostream *outstr);
+/*!
+ * Busy and idle time of each thread of \ref update, empty with a single thread
+ */
+	std::vector<WorkPool::Statistics> thread_statistics() const { return (pool ? pool->statistics() : std::vector<WorkPool::Statistics>()); }
+/*!
+ * Index in \ref neurons of the neuron of id \p n
+ */
+	size_t internal_id(const size_t& n) const { return internal_of.empty() ? n : internal_of[n]; }
+/*!
+ * Id of the neuron stored at index \p i of \ref neurons
+ */
+	size_t external_id(const size_t& i) const { return external_of.empty() ? i : external_of[i]; }
+/*!
+ * Chooses the numerical scheme used by \ref update and the length of one time step.
+ * \param method (std::string): name of the scheme, one of the keys of \ref Neuron::Integrators
+ * \param step (double): length of a time step in milliseconds
+ */
+	void set_integrator(const std::string& method, const double& step);
+/*!
+ * Names of the available \ref Engine, as given on the command line.
+ */
+	static const std::map<std::string, Engine> Engines;
+/*!
+ * Chooses the \ref Engine of \ref update, one of the keys of \ref Engines
+ */
+	void set_engine(const std::string& name);
+/*!
+ * Draws the noise of \ref update from a generator of its own seeded with \p seed, instead of the global one,
+ * so that several networks can run at the same time in different threads
+ */
+	void set_seed(const unsigned long& seed) { rng.reset(new RandomNumbers(seed)); }
+/*!
+ * Draws the noise from the global generator again, as before \ref set_seed
+ */
+	void clear_seed() { rng.reset(); }
+/*!
+ * Puts the neurons back in their initial state (as built by the constructor) and the step counter to 0.
+ * The intensities changed by the plasticity are kept, its traces start again from 0, and the \ref stimulus starts again from its step 1.
+ */
+	void reset();
+/*!
+ * Provides access to the length of a time step \ref dt
+ */
+	double get_time_step() const { return dt; }
+/*!
+ * Number of steps performed since the network was built or \ref reset
+ */
+	size_t get_steps() const { return steps; }
  ///@}
  
 /*! @name Linking neurons
@@ -91,14 +229,20 @@ public:
  * \param connectivity (double): mean connectivity of the chosen model
  * \param model (std::string): chosen model
  */	
-	int calculate_connections(double connectivity, std::string model);
+	static int calculate_connections(double connectivity, std::string model);
 /*!
- * Creates a new link in the map \ref links.
+ * Creates a new link in the map \ref links, or in the \ref delta once the \ref topology is built.
  * \param n_r (size_t): receiving neuron,
  * \param n_s (size_t): sending neuron,
  * \param i (double): link intensity.
+ * \return false if the link exists, if it is a loop or if a neuron does not exist or was removed
  */
     bool add_link(const size_t& n_r, const size_t& n_s, double i);
+/*!
+ * Builds the compact \ref topology from \ref links and allocates the buffers used by \ref update.
+ * It is called automatically by \ref update when links have been added since the last call.
+ */
+	void finalize();
 /*!
  * Creates all the random links of the network.
  * Each \ref Neuron will expect to receive the inputs of n other neurons, calculated with \ref calculate_connections.
@@ -110,14 +254,60 @@ public:
  * \param model (std::string): model to pick number of links at random.
  */
     void random_connect(const double& connectivity, const double &i, const std::string &model);
+/*!
+ * Draws the same links as \ref random_connect, in the same order, but writes them directly as the rows of the \ref topology
+ * instead of filling the map \ref links first: the links then take 12 bytes each instead of about 80 while the network is built.
+ */
+    void connect_rows(const double& connectivity, const double &i, const std::string &model);
+/*!
+ * Draws the rows of \ref connect_rows, calling \p emit for each of them in order instead of keeping them
+ */
+    void random_rows(const double& connectivity, const double &i, const std::string &model, const StreamedTopology::Row& emit);
 /*!
  *Find all neurons connected with incomming connections to neuron \p n.
  *\param n : the index of the receiving neuron.
  *\return a vector of pair {neuron index, link intensity}.
 */
 	std::vector<std::pair<size_t, double>> find_neighbours(const size_t &n);
+/*!
+ * Stores the neurons in the order given by \p method, one of \ref Ordering::Methods.
+ * The ids of the neurons, and therefore the outputs, do not change.
+ */
+	void reorder(const std::string& method);
+/*!
+ * Stores the neurons in the order \p order: the neuron at internal index \p order [i] moves to internal index i (see \ref Topology::permuted).
+ */
+	void reorder(const std::vector<uint32_t>& order);
+/*!
+ * Stores the links in the compressed form \p mode, one of \ref CompressedTopology::Modes, to save memory.
+ * The map \ref links is released too. Intensities are rounded: reading \ref links or the whole \ref topology, or adding links,
+ * decodes the links back with these rounded values.
+ */
+	void compress(const std::string& mode);
+/*!
+ * Moves the links to the file \p path, from which they are read at every step by blocks, keeping at most
+ * \p budget bytes of links in memory; the map \ref links is released too. The file is removed when the links are
+ * read back (by the methods needing all of them, as for \ref compress) or when the network is destroyed.
+ * The links of a network too large for memory are rather streamed as they are built (\ref Wiring_parameters::stream).
+ */
+	void stream(const std::string& path, const size_t& budget);
+/*!
+ * Makes the intensities of the links change with the spikes, with the \ref Plasticity \p parameters.
+ * The links must be kept in memory, uncompressed. The traces start again from 0 when links are added or the neurons reordered.
+ */
+	void set_plasticity(const Plasticity_parameters& parameters);
+/*!
+ * Adds the currents of \p stimulus to the noise of the neurons (ids), from the next step on, which is its step \ref steps +1 - \p start:
+ * with \p start = \ref get_steps, its steps count from now (e.g. after a burn-in). nullptr removes the stimulus.
+ */
+	void set_stimulus(std::unique_ptr<Stimulus> stimulus, const size_t& start = 0);
+/*!
+ * Number of link intensities changed by the plasticity so far, 0 without plasticity
+ */
+	size_t plastic_updates() const { return (plasticity ? plasticity->updates() : 0); }
 /*!
  * Calculate the sum of intensity of all neurons connected to neuron \p n.
+ * Excitatory inputs count positively and inhibitory ones negatively.
  *\param n : the index of the receiving neuron.
  *\return the valence of neuron \p n.
 */
@@ -126,6 +316,49 @@ public:
 ///@}
 	
 	
+/*! @name Editing the network
+ * Changes for lesion and growth experiments, made between steps once the \ref topology is built.
+ * The changes of links are kept in the \ref delta, seen by the next \ref update without rebuilding the topology.
+ * Once there are \ref set_compaction_threshold edits, a thread merges them into a new topology, which replaces the old one
+ * at the first step after it is done; the steps go on meanwhile. With plasticity, the edits are merged at the next step,
+ * and with compressed or streamed links, only when \ref compact is called (the links are then decoded back).
+ */
+///@{
+/*!
+ * Adds a neuron of type \p type, its parameters drawn with the margin \p d, without links. Returns its id, the next one.
+ */
+	size_t add_neuron(const std::string& type, const double& d = 0.0);
+/*!
+ * Removes neuron \p n: it keeps its id but no longer fires nor receives anything, and its links are dropped at the next compaction
+ */
+	void remove_neuron(const size_t& n);
+	bool is_removed(const size_t& n) const { return not removed.empty() and removed[internal_id(n)]; }
+/*!
+ * Removes the link from \p n_s to \p n_r; false if there is none
+ */
+	bool remove_link(const size_t& n_r, const size_t& n_s);
+/*!
+ * Gives the intensity \p i to the link from \p n_s to \p n_r; false if there is none
+ */
+	bool set_intensity(const size_t& n_r, const size_t& n_s, const double& i);
+/*!
+ * Merges the edits and the removed neurons into the \ref topology now
+ */
+	void compact();
+/*!
+ * Number of edits from which they are merged in the background, \ref _Compaction_Edits_ by default
+ */
+	void set_compaction_threshold(const size_t& edits) { threshold = edits; }
+/*!
+ * Number of edits kept in the \ref delta
+ */
+	size_t pending_edits() const { return delta.size(); }
+/*!
+ * True while a compaction runs in the background
+ */
+	bool compacting() const { return compaction.valid(); }
+///@}
+
 /*! @name Testing neurons properties
  */
 ///@{
@@ -138,7 +371,7 @@ public:
  */
 	bool is_type(const std::string& type) const;
 /*!
- * finds the index of the first \ref Neuron of one type of neuron passed as a parameter
+ * finds the id of the first \ref Neuron of one type of neuron passed as a parameter
  */
 	size_t find_first_neuron(const std::string& type) const;
 ///@} 
@@ -148,6 +381,8 @@ public:
 ///@{
 /*!
  *Calculates the total synaptic current received by neuron \p n.
+ *The noise is scaled by 1/sqrt( \ref dt) and the synaptic inputs by 1/ \ref dt, so that the charge
+ *received per millisecond does not depend on the time step.
  *\param n : the index of the receiving neuron.
  *\return a double value.
 */
@@ -155,10 +390,32 @@ public:
 
 /*!
  * Principal function that updates the parameters of each \ref Neuron in the \ref Network
- * It returns a vector containing the index of firing neurons to allow the \ref Simulation to have access to them.
- * In order to perform one time-step of the simulation, it updates twice the potential and once the recovery. 
+ * It returns the index of firing neurons to allow the \ref Simulation to have access to them; the vector
+ * is owned by the network and is overwritten by the next call.
+ * One call advances the network by \ref dt milliseconds using the chosen \ref integrator.
+ *
+ * The neurons firing at the beginning of the step are recorded first: a neuron crossing the threshold
+ * during the step only sends its signal at the next step, whatever its index.
+ */
+	const std::vector<size_t>& update();
+/*!
+ * Phases of \ref update measured by \ref measure_phases: the firing neurons ("drive"), the noise and the stimulus ("noise"),
+ * the integration of the other neurons from their links ("integrate"), then the reset of the firing ones and the plasticity ("reset")
+ */
+	static const std::vector<std::string> Phases;
+/*!
+ * Measures the \ref Phases of each \ref update with \ref Counters opened in the calling thread, which must be the one running
+ * the steps; false stops measuring. Where the hardware counters are not available, only the wall time is measured.
+ */
+	void measure_phases(const bool& measure);
+/*!
+ * Counters measuring the phases, nullptr if they are not measured
  */
-	std::vector<size_t> update();
+	const Counters* get_counters() const { return counters.get(); }
+/*!
+ * Wall time and events of each of the \ref Phases during the last \ref update, empty if they are not measured
+ */
+	const std::vector<Counts>& get_phase_counts() const { return phase_counts; }
 ///@}
 
 /*! @name Generating the output
@@ -173,18 +430,92 @@ public:
  * Print the potential, recovery and current of the first \ref Neuron in the \ref Network at each simulation step using \ref print_properties
  * \param t is the simulation time step
  * \param *outstr is the output stream for writing values
+ * \param first, last only the sample neurons \p first to \p last -1 are printed (see \ref get_sample_neurons), for a shard of the file
  */					
-	void print_sample(const int& t, std::ostream *outstr);
+	void print_sample(const int& t, std::ostream *outstr, const size_t& first = 0, const size_t& last = SIZE_MAX);
 /*!
  * Helper function for \ref print_sample
  */
-	void print_properties(const std::string& type, std::ostream *outstr);
+	void print_properties(const size_t& n, std::ostream *outstr);
+/*!
+ * Print a header for function \ref print_sample, with the columns of the sample neurons \p first to \p last -1
+ */
+	void header_sample(std::ostream *outstr, const size_t& first = 0, const size_t& last = SIZE_MAX);							
 /*!
- * Print a header for function \ref print_sample
+ * Print every link (receiving neuron, sending neuron, intensity), for instance after the plasticity changed them
  */
-	void header_sample(std::ostream *outstr);							
+	void print_links(std::ostream *outstr);
 ///@}
 private:
+/*!
+ * Rebuilds \ref links from the \ref topology written by a \ref Generator
+ */
+	void materialize_links();
+/*!
+ * Decodes the \ref compressed or \ref streamed links back into \ref topology
+ */
+	void expand();
+/*!
+ * Calls \p f (sending neuron, intensity) for each link received by the neuron of internal index \p i, with the edits of the \ref delta
+ */
+	template<class F> void for_each_input(const size_t& i, F f) const;
+/*!
+ * Same as \ref for_each_input, without the edits
+ */
+	template<class F> void for_each_base_input(const size_t& i, F f) const;
+/*!
+ * True if the link from \p s to \p i (internal indices) exists, its intensity then in \p w
+ */
+	bool find_link(const size_t& i, const size_t& s, double& w) const;
+/*!
+ * Records the edit of the link from \p s to \p i (internal indices) in the \ref delta, and starts a compaction if they are many
+ */
+	void edit_link(const size_t& i, const size_t& s, const bool& present, const double& w);
+/*!
+ * Waits for the compaction running in the background, if any, and takes its topology
+ */
+	void finish_compaction();
+/*!
+ * Replaces the \ref topology by \p merged, which holds the edits up to \p sequence
+ */
+	void install(Topology&& merged, const uint64_t& sequence);
+/*!
+ * Number of links received by the neuron of internal index \p i
+ */
+	size_t degree(const size_t& i) const;
+/*!
+ * Gives to the neuron of internal index \p i the current received from the links \p inputs, then integrates it
+ */
+	void integrate(const size_t& i, const View<uint32_t>& inputs, const View<double>& intensities);
+/*!
+ * Integrates the neurons of internal index \p first to \p last -1, from the links in memory
+ */
+	void integrate_rows(const size_t& first, const size_t& last);
+/*!
+ * Integrates all the neurons from the map \ref links (\ref Engine::Reference)
+ */
+	void integrate_links();
+/*!
+ * Integrates all the neurons from the signals sent through the \ref outgoing links of the firing ones (\ref Engine::Push)
+ */
+	void integrate_pushed();
+/*!
+ * Splits the rows into the \ref chunks run by the \ref pool
+ */
+	void make_chunks();
+/*!
+ * Records the counts since the end of the previous phase as those of phase \p phase, if the phases are measured
+ */
+	void lap(const size_t& phase);
+/*!
+ * External noise received by neuron \p n during one step
+ */
+	double noise_current(const size_t& n);
+/*!
+ * Sum of the signals received through the links \p inputs from the neurons recorded in \ref drive
+ */
+	double synaptic_current(const View<uint32_t>& inputs, const View<double>& intensities) const;
+
 /*!
  * Set of \ref Neuron that composes the network. 
  */
@@ -211,4 +542,167 @@ private:
  */
 	Link links;
 
+/*!
+ * Compact copy of \ref links used by \ref update
+ */
+	Topology topology;
+/*!
+ * Transpose of \ref topology used by \ref Engine::Push (row n lists the neurons receiving a link from n), empty with the other engines
+ */
+	Topology outgoing;
+/*!
+ * True when the \ref topology changed since \ref outgoing was built
+ */
+	bool outgoing_stale = true;
+/*!
+ * Compressed copy of \ref topology, which is then left empty
+ */
+	CompressedTopology compressed;
+/*!
+ * Links read from a file at each step, nullptr when they are in memory
+ */
+	std::unique_ptr<StreamedTopology> streamed;
+/*!
+ * Plasticity of the intensities of \ref topology, nullptr if they are fixed
+ */
+	std::unique_ptr<Plasticity> plasticity;
+/*!
+ * External currents added to the noise, nullptr if there are none
+ */
+	std::unique_ptr<Stimulus> stimulus;
+/*!
+ * Number of steps performed by \ref update, the clock of the \ref plasticity and of the \ref stimulus
+ */
+	size_t steps = 0;
+/*!
+ * Step of the network after which the \ref stimulus starts
+ */
+	size_t stimulus_start = 0;
+/*!
+ * Threads computing the rows, nullptr to compute them in the calling thread
+ */
+	std::unique_ptr<WorkPool> pool;
+	bool stealing = true;
+/*!
+ * Internal index of the first row of each chunk run by the \ref pool, followed by the number of rows
+ */
+	std::vector<size_t> chunks;
+/*!
+ * Time waited for the \ref streamed links during the last step
+ */
+	double io_wait = 0.0;
+/*!
+ * Links edited since the \ref topology was built, see \ref edit_link
+ */
+	TopologyDelta delta;
+/*!
+ * Neurons removed, by internal index; empty if none was
+ */
+	std::vector<char> removed;
+/*!
+ * Number of edits made so far, the last one removing a neuron, and the last one held by the \ref topology
+ */
+	uint64_t edits = 0, last_removal = 0, merged_edits = 0;
+/*!
+ * Number of edits from which they are merged in the background
+ */
+	size_t threshold = _Compaction_Edits_;
+/*!
+ * Topology being merged in the background (holding the edits up to \ref compaction_edits), invalid if none is
+ */
+	std::future<Topology> compaction;
+	uint64_t compaction_edits = 0;
+/*!
+ * True when \ref links changed since the last \ref finalize
+ */
+	bool topology_dirty = true;
+/*!
+ * True when the \ref topology was generated directly and \ref links has not been built from it yet
+ */
+	bool links_stale = false;
+
+/*! @name Step buffers
+ * Allocated by \ref finalize and reused at every step.
+ */
+///@{
+/*!
+ * Internal index of the neurons firing at the current step
+ */
+	std::vector<size_t> firing_neurons;
+/*!
+ * Ids of the neurons firing at the current step, returned by \ref update when the neurons are reordered
+ */
+	std::vector<size_t> firing_ids;
+/*!
+ * External noise drawn for each neuron at the current step
+ */
+	Array<double> noise;
+/*!
+ * Factor applied to the links sent by each neuron during the current step:
+ * 0.5 if it fires and is excitatory, -1 if it fires and is inhibitory, 0 otherwise
+ */
+	Array<double> drive;
+/*!
+ * Signals received by each neuron during the current step, summed by \ref integrate_pushed
+ */
+	Array<double> pushed;
+/*!
+ * Id of the first \ref Neuron of each type present in the network, printed by \ref print_sample
+ */
+	std::vector<size_t> sample_neurons;
+///@}
+
+/*! @name Neuron order
+ * Both vectors are empty as long as the neurons are stored in the order of their ids.
+ */
+///@{
+	std::vector<uint32_t> internal_of;
+	std::vector<uint32_t> external_of;
+///@}
+
+/*!
+ * Length of a time step in milliseconds
+ */
+	double dt = _Time_Step_;
+/*!
+ * Scheme used to integrate the \ref Neuron equations
+ */
+	Integrator integrator = Integrator::Euler;
+/*!
+ * Generator of the noise, nullptr to use the global one
+ */
+	std::unique_ptr<RandomNumbers> rng;
+/*!
+ * Engine used by \ref update
+ */
+	Engine engine = Engine::Pull;
+/*!
+ * Counters of the \ref Phases, nullptr if they are not measured; counts of each phase at the last step, and at the end of the previous phase
+ */
+	std::unique_ptr<Counters> counters;
+	std::vector<Counts> phase_counts;
+	Counts phase_end;
+
 };
+
+template<class F>
+void Network::for_each_input(const size_t& i, F f) const
+{
+	if (delta.empty() or delta.row(i).empty()) return for_each_base_input(i, f);
+	for_each_base_input(i, [&](const uint32_t& m, const double& w) {		// the edited links replace those of the rows
+		if (not delta.find(i, m)) f(m, w);
+	});
+	for (const auto& edit : delta.row(i)) {
+		if (edit.present) f(edit.pre, edit.weight);
+	}
+}
+
+template<class F>
+void Network::for_each_base_input(const size_t& i, F f) const
+{
+	if (not compressed.empty()) return compressed.for_each(i, f);
+	if (streamed) return streamed->for_each(i, f);
+	View<uint32_t> inputs = topology.inputs(i);
+	View<double> intensities = topology.intensities(i);
+	for (size_t k(0); k<inputs.size(); ++k) f(inputs[k], intensities[k]);
+}
@@ -23,11 +23,61 @@ Neuron::Neuron(const std::string &type, const double &delta) : curr_(0.0)
 	set_recovery (params_.b*pot_);
 }
 
-void Neuron::equation()
+const std::map<std::string, Integrator> Neuron::Integrators {
+	{"euler",    Integrator::Euler},
+	{"rk2",      Integrator::RK2},
+	{"rk4",      Integrator::RK4},
+	{"adaptive", Integrator::Adaptive}
+};
+
+void Neuron::equation(const double& dt, Integrator method)
+{
+	switch (method) {
+		case Integrator::RK2:      rk2(dt);      break;
+		case Integrator::RK4:      rk4(dt);      break;
+		case Integrator::Adaptive: adaptive(dt); break;
+		default:                   euler(dt);
+	}
+}
+
+void Neuron::euler(const double& dt)
+{
+	pot_ += 0.5*dt*dpot(pot_, rec_);									// updates two times the potential and one time the recovery
+	pot_ += 0.5*dt*dpot(pot_, rec_);
+	rec_ += dt*drec(pot_, rec_);
+}
+
+void Neuron::rk2(const double& dt)
+{
+	double v = capped(pot_ + 0.5*dt*dpot(pot_, rec_));					// state at the middle of the step
+	double u = rec_ + 0.5*dt*drec(pot_, rec_);
+	pot_ += dt*dpot(v, u);
+	rec_ += dt*drec(v, u);
+}
+
+void Neuron::rk4(const double& dt)
 {
-	pot_ += 0.5*(0.04*pot_*pot_+5*pot_+140-rec_+curr_);					// updates two times the potential and one time the recovery
-	pot_ += 0.5*(0.04*pot_*pot_+5*pot_+140-rec_+curr_);
-	rec_ += params_.a*(params_.b*pot_-rec_);
+	double kv1 = dpot(pot_, rec_), ku1 = drec(pot_, rec_);
+	double v = capped(pot_+0.5*dt*kv1), u = rec_+0.5*dt*ku1;
+	double kv2 = dpot(v, u), ku2 = drec(v, u);
+	v = capped(pot_+0.5*dt*kv2); u = rec_+0.5*dt*ku2;
+	double kv3 = dpot(v, u), ku3 = drec(v, u);
+	v = capped(pot_+dt*kv3); u = rec_+dt*ku3;
+	double kv4 = dpot(v, u), ku4 = drec(v, u);
+	pot_ += dt*(kv1 + 2*kv2 + 2*kv3 + kv4)/6.0;
+	rec_ += dt*(ku1 + 2*ku2 + 2*ku3 + ku4)/6.0;
+}
+
+void Neuron::adaptive(const double& dt)
+{
+	double pot0 = pot_, rec0 = rec_;
+	rk2(dt);																// coarse trial step
+	if (pot0 < _Adaptive_Margin_ and pot_ < _Adaptive_Margin_) return;	// far from the threshold: the coarse step is accepted
+
+	pot_ = pot0;															// close to the threshold: the step is redone with fine sub-steps
+	rec_ = rec0;
+	int substeps = (int)std::ceil(dt/_Adaptive_Step_);
+	for (int k(0); k<substeps and not firing(); ++k) rk4(dt/substeps);	// integration stops once the threshold is crossed
 }
 
 std::string Neuron::params_to_print() const
@@ -48,3 +98,8 @@ std::string Neuron::variables_to_print() const
 	ss << "\t" << pot_  << "\t" << rec_ << "\t" << curr_;
 	return ss.str();
 }
+
+void Neuron::print_variables(std::ostream *outstr) const
+{
+	*outstr << "\t" << pot_  << "\t" << rec_ << "\t" << curr_;
+}
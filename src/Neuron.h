@@ -23,6 +23,15 @@
 struct Neuron_parameters {double a, b, c, d;
 						  bool excit;}; 
 
+/*! \enum Integrator
+ * Numerical schemes available to integrate the \ref Neuron equations over one time step:
+ * - Euler: the historical scheme, two half-steps for the potential and one step for the recovery,
+ * - RK2: explicit midpoint method on the coupled (potential, recovery) system,
+ * - RK4: classical fourth order Runge-Kutta method,
+ * - Adaptive: a single RK2 step far from the threshold, refined into RK4 sub-steps when the potential gets close to it.
+ */
+enum class Integrator {Euler, RK2, RK4, Adaptive};
+
 class Neuron{
 public:
 /*! @name Initializing
@@ -32,14 +41,20 @@ public:
 ///@{
 	Neuron(const std::string &type, const double &delta);
 	static const std::map<std::string, Neuron_parameters> Neuron_types;
+/*!
+ * Names of the available \ref Integrator, as given on the command line.
+ */
+	static const std::map<std::string, Integrator> Integrators;
 ///@}
 /*! @name Neuron states
  */
 ///@{
 /*!
  * Equation calculates differential equations based on a simple model of spiking neurons.
+ * The state is advanced by \p dt milliseconds using the scheme \p method.
+ * With the default arguments, this is the historical 1 ms Euler step.
  */
-	void equation();
+	void equation(const double& dt = _Time_Step_, Integrator method = Integrator::Euler);
 /*!
  * Tests if the neuron is firing.
  */
@@ -65,7 +80,7 @@ public:
 /*!
  * Provides access the potential \ref pot_
  */
-	double get_potential() const {return pot_;}
+	const double& get_potential() const {return pot_;}
 /*!
  * Allows other classes to set the recovery \ref rec_ of the \ref Neuron using \p rec
  */
@@ -73,7 +88,7 @@ public:
 /*!
  * Provides access the recovery \ref rec_
  */
-	double get_recovery() const {return rec_;}
+	const double& get_recovery() const {return rec_;}
 /*!
  * Allows other classes to set the current \ref curr_ of the \ref Neuron using \p curr
  */
@@ -81,7 +96,7 @@ public:
 /*!
  * Provides access the current \ref curr_
  */
-	double get_current() const {return curr_;}
+	const double& get_current() const {return curr_;}
 /*!
  * Provides access the name of the type \ref n_type of the \ref Neuron
  */
@@ -100,6 +115,10 @@ public:
  * Returns a string containing the recovery \ref rec_, potential \ref pot_ and current \ref curr_ of the \ref Neuron
  */								
 	std::string variables_to_print() const;	
+/*!
+ * Writes the same values as \ref variables_to_print directly on \p outstr, without building a string
+ */
+	void print_variables(std::ostream *outstr) const;
 /*!
  * Is used to reset the potential \ref pot_ and the recovery \ref rec_ . 
  * This function is called by the update in the \ref Network
@@ -108,6 +127,29 @@ public:
 ///@}
 
 private:
+/*! @name Integration schemes
+ * Each scheme advances \ref pot_ and \ref rec_ by \p dt milliseconds, the current \ref curr_ being held constant.
+ */
+///@{
+/*!
+ * Time derivative of the potential for the state ( \p v, \p u)
+ */
+	double dpot(const double& v, const double& u) const {return 0.04*v*v+5*v+140-u+curr_;}
+/*!
+ * Time derivative of the recovery for the state ( \p v, \p u)
+ */
+	double drec(const double& v, const double& u) const {return params_.a*(params_.b*v-u);}
+/*!
+ * Intermediate states of the Runge-Kutta schemes are capped at the threshold: past it the
+ * quadratic term diverges within a fraction of a millisecond and would turn the recovery into nan.
+ */
+	static double capped(const double& v) {return std::min(v, (double)_Discharge_Threshold_);}
+	void euler(const double& dt);
+	void rk2(const double& dt);
+	void rk4(const double& dt);
+	void adaptive(const double& dt);
+///@}
+
 /*! @name Cellular properties
  * Parameters are regrouped in a data structure called \ref Neuron_parameters. They are initialized at the start of the simulation and are constant.
  * \ref n_type holds the name of the type of the \ref Neuron
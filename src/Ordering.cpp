@@ -0,0 +1,129 @@
+#include "Ordering.h"
+#include "Random.h"
+#include <deque>
+
+const std::vector<std::string> Ordering::Methods {"none", "degree", "rcm", "partition"};
+const size_t Ordering::Part;
+
+namespace {
+
+// links in both directions: the rows and their transpose
+struct Neighbourhood {
+	Neighbourhood(const Topology& topology) : in(topology), out(topology.transpose()) {}
+	size_t degree(const size_t& n) const { return in.degree(n) + out.degree(n); }
+	template<class F> void for_each(const size_t& n, F f) const {
+		for (const auto& m : in.inputs(n)) f(m);
+		for (const auto& m : out.inputs(n)) f(m);
+	}
+	const Topology& in;
+	Topology out;
+};
+
+}
+
+std::vector<uint32_t> Ordering::compute(const std::string& method, const Topology& topology)
+{
+	if (method == "none") return std::vector<uint32_t>();
+	if (method == "degree") return degree(topology);
+	if (method == "rcm") return rcm(topology);
+	if (method == "partition") return partition(topology, Part);
+	throw std::runtime_error("Unknown ordering " + method);
+}
+
+std::vector<uint32_t> Ordering::degree(const Topology& topology)
+{
+	Neighbourhood graph(topology);
+	std::vector<uint32_t> order(topology.size());
+	for (size_t n(0); n<order.size(); ++n) order[n] = (uint32_t)n;
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return graph.degree(a) > graph.degree(b); });
+	return order;
+}
+
+std::vector<uint32_t> Ordering::rcm(const Topology& topology)
+{
+	Neighbourhood graph(topology);
+	size_t size = topology.size();
+	std::vector<uint32_t> by_degree(size);
+	for (size_t n(0); n<size; ++n) by_degree[n] = (uint32_t)n;
+	std::stable_sort(by_degree.begin(), by_degree.end(), [&](uint32_t a, uint32_t b) { return graph.degree(a) < graph.degree(b); });
+
+	std::vector<uint32_t> order;
+	order.reserve(size);
+	std::vector<char> visited(size, 0);
+	std::vector<uint32_t> next;
+	for (const auto& root : by_degree) {								// one breadth-first search per connected component,
+		if (visited[root]) continue;									// starting from a neuron of minimal degree
+		visited[root] = 1;
+		order.push_back(root);
+		for (size_t head(order.size() - 1); head<order.size(); ++head) {
+			next.clear();
+			graph.for_each(order[head], [&](uint32_t m) {
+				if (not visited[m]) {
+					visited[m] = 1;
+					next.push_back(m);
+				}
+			});
+			std::stable_sort(next.begin(), next.end(), [&](uint32_t a, uint32_t b) { return graph.degree(a) < graph.degree(b); });
+			order.insert(order.end(), next.begin(), next.end());
+		}
+	}
+	std::reverse(order.begin(), order.end());
+	return order;
+}
+
+std::vector<uint32_t> Ordering::partition(const Topology& topology, const size_t& part)
+{
+	Neighbourhood graph(topology);
+	size_t size = topology.size();
+	std::vector<uint32_t> order;
+	order.reserve(size);
+	std::vector<char> placed(size, 0);
+	std::deque<uint32_t> frontier;										// neighbours of the previous regions, used as seeds
+	size_t scan = 0;
+	while (order.size() < size) {
+		uint32_t seed = (uint32_t)size;
+		while (not frontier.empty() and seed == size) {
+			if (not placed[frontier.front()]) seed = frontier.front();
+			frontier.pop_front();
+		}
+		while (seed == size) {
+			if (not placed[scan]) seed = (uint32_t)scan;
+			++scan;
+		}
+		// grows one region breadth-first from the seed, up to part neurons
+		size_t first = order.size();
+		placed[seed] = 1;
+		order.push_back(seed);
+		for (size_t head(first); head<order.size(); ++head) {
+			graph.for_each(order[head], [&](uint32_t m) {
+				if (placed[m]) return;
+				if (order.size() - first < part) {
+					placed[m] = 1;
+					order.push_back(m);
+				}
+				else frontier.push_back(m);
+			});
+		}
+	}
+	return order;
+}
+
+std::vector<uint32_t> Ordering::random(const size_t& size)
+{
+	std::vector<size_t> index(size);
+	for (size_t n(0); n<size; ++n) index[n] = n;
+	_RNG->shuffle(index);
+	return std::vector<uint32_t>(index.begin(), index.end());
+}
+
+double Ordering::lines_per_link(const Topology& topology)
+{
+	size_t lines = 0;
+	for (size_t n(0); n<topology.size(); ++n) {
+		View<uint32_t> inputs = topology.inputs(n);					// rows are sorted: lines are counted in one pass
+		for (size_t k(0); k<inputs.size(); ++k) {
+			if (k == 0 or inputs[k]/8 != inputs[k-1]/8) ++lines;
+		}
+	}
+	return topology.synapses() ? (double)lines/topology.synapses() : 0.0;
+}
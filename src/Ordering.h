@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Topology.h"
+
+/*! \class Ordering
+ * Orders of the neurons improving the locality of the \ref Topology: neurons exchanging links are given close
+ * indices, so that the state of the sending neurons read while computing a row lies in a few cache lines.
+ *
+ * An order is a vector where element i is the current index of the neuron placed at position i.
+ * Available methods:
+ * - "none": keeps the current order (empty vector),
+ * - "degree": neurons sorted by decreasing number of links, so that hubs share cache lines,
+ * - "rcm": reverse Cuthill-McKee, a breadth-first order reducing the bandwidth of the adjacency matrix,
+ * - "partition": the graph is split into regions of \ref Part neurons grown breadth-first, numbered one after the other.
+ *
+ * Links are considered in both directions.
+ */
+
+class Ordering {
+public:
+	static const std::vector<std::string> Methods;
+/*!
+ * Number of neurons of a region of the "partition" method: their state fits in the first level cache
+ */
+	static const size_t Part = 2048;
+
+/*!
+ * Computes the order given by \p method for \p topology
+ */
+	static std::vector<uint32_t> compute(const std::string& method, const Topology& topology);
+
+	static std::vector<uint32_t> degree(const Topology& topology);
+	static std::vector<uint32_t> rcm(const Topology& topology);
+	static std::vector<uint32_t> partition(const Topology& topology, const size_t& part);
+/*!
+ * A random order, which destroys any locality (used as a worst case by the benchmarks)
+ */
+	static std::vector<uint32_t> random(const size_t& size);
+
+/*!
+ * Locality of \p topology: mean number of distinct cache lines of per-neuron state (8 bytes per neuron)
+ * read per link while computing all the rows
+ */
+	static double lines_per_link(const Topology& topology);
+};
@@ -0,0 +1,47 @@
+#include "Plasticity.h"
+#include <algorithm>
+
+Plasticity::Plasticity(const Plasticity_parameters& parameters, const Topology& topology)
+: parameters(parameters), out_start(topology.size() + 1, 0), out_link(topology.synapses()), out_post(topology.synapses()),
+  pre_trace(topology.size(), {0.0, 0}), post_trace(topology.size(), {0.0, 0})
+{
+	for (size_t n(0); n<topology.size(); ++n) {
+		for (const auto& m : topology.inputs(n)) ++out_start[m + 1];
+	}
+	for (size_t n(0); n<topology.size(); ++n) out_start[n+1] += out_start[n];
+	std::vector<size_t> fill(out_start.begin(), out_start.end() - 1);
+	for (size_t n(0); n<topology.size(); ++n) {
+		View<uint32_t> inputs = topology.inputs(n);
+		for (size_t k(0); k<inputs.size(); ++k) {
+			out_link[fill[inputs[k]]] = topology.first_link(n) + k;
+			out_post[fill[inputs[k]]++] = (uint32_t)n;
+		}
+	}
+}
+
+double Plasticity::decayed(const Trace& trace, const size_t& step, const double& dt, const double& tau)
+{
+	if (trace.value == 0.0 or trace.step == step) return trace.value;
+	return trace.value*std::exp(-(double)(step - trace.step)*dt/tau);
+}
+
+void Plasticity::spike(const std::vector<size_t>& firing, const size_t& step, const double& dt, Topology& topology)
+{
+	for (const auto& n : firing) {
+		for (size_t k(out_start[n]); k<out_start[n+1]; ++k) {			// post before pre: depression
+			double& w = topology.intensity(out_link[k]);
+			w = clamp(w - parameters.depression*decayed(post_trace[out_post[k]], step, dt, parameters.tau_minus));
+		}
+		View<uint32_t> inputs = topology.inputs(n);
+		for (size_t k(0); k<inputs.size(); ++k) {						// pre before post: potentiation
+			double& w = topology.intensity(topology.first_link(n) + k);
+			w = clamp(w + parameters.potentiation*decayed(pre_trace[inputs[k]], step, dt, parameters.tau_plus));
+		}
+		changes += out_start[n+1] - out_start[n] + inputs.size();
+	}
+	// the traces are increased once all the links are updated: simultaneous spikes do not change each other's links
+	for (const auto& n : firing) {
+		pre_trace[n] = {decayed(pre_trace[n], step, dt, parameters.tau_plus) + 1.0, step};
+		post_trace[n] = {decayed(post_trace[n], step, dt, parameters.tau_minus) + 1.0, step};
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Topology.h"
+
+/*! \struct Plasticity_parameters
+ * Parameters of the spike-timing-dependent plasticity:
+ * - potentiation, depression: change of intensity for a pair of spikes at the same time,
+ * - tau_plus, tau_minus: time constants (ms) of the presynaptic and postsynaptic traces,
+ * - max_weight: intensities are kept between 0 and max_weight.
+ */
+struct Plasticity_parameters {
+	Plasticity_parameters() : potentiation(_STDP_Potentiation_), depression(_STDP_Depression_),
+							  tau_plus(_STDP_Tau_), tau_minus(_STDP_Tau_), max_weight(_STDP_Max_Weight_) {}
+	double potentiation, depression, tau_plus, tau_minus, max_weight;
+};
+
+/*! \class Plasticity
+ * Trace-based spike-timing-dependent plasticity (STDP) of the intensities of a \ref Topology.
+ *
+ * Each neuron has a presynaptic trace and a postsynaptic trace, increased by 1 when it fires and decaying
+ * exponentially. When neuron n fires:
+ * - each link it sends is weakened by depression times the postsynaptic trace of the receiving neuron,
+ * - each link it receives is strengthened by potentiation times the presynaptic trace of the sending neuron.
+ *
+ * Only the links of the firing neurons are visited, so the cost of a step is proportional to the number of spikes.
+ * The traces are decayed lazily: each one keeps the step of its last change and is decayed when it is read.
+ */
+
+class Plasticity {
+public:
+/*!
+ * Prepares the plasticity of the links of \p topology: finds the links sent by each neuron.
+ * The traces start at 0.
+ */
+	Plasticity(const Plasticity_parameters& parameters, const Topology& topology);
+/*!
+ * Applies the plasticity for the neurons \p firing at step \p step, each step lasting \p dt ms.
+ */
+	void spike(const std::vector<size_t>& firing, const size_t& step, const double& dt, Topology& topology);
+/*!
+ * Number of intensities changed since the creation
+ */
+	size_t updates() const { return changes; }
+	const Plasticity_parameters& get_parameters() const { return parameters; }
+
+private:
+	struct Trace {double value;
+				  size_t step;};
+/*!
+ * Value of \p trace at step \p step, for the time constant \p tau
+ */
+	static double decayed(const Trace& trace, const size_t& step, const double& dt, const double& tau);
+	double clamp(const double& w) const { return std::min(std::max(w, 0.0), parameters.max_weight); }
+
+	Plasticity_parameters parameters;
+/*!
+ * Links sent by each neuron, as rows: the position of the link in the \ref Topology and its receiving neuron
+ */
+	std::vector<size_t> out_start;
+	std::vector<size_t> out_link;
+	std::vector<uint32_t> out_post;
+	std::vector<Trace> pre_trace, post_trace;
+	size_t changes = 0;
+};
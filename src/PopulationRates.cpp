@@ -0,0 +1,62 @@
+#include "PopulationRates.h"
+
+PopulationRates::PopulationRates(const std::vector<Type_block>& types, const size_t& window, const double& dt)
+	: types(types), window(window), dt(dt), window_spikes(types.size(), 0.0), total_spikes(types.size(), 0.0), rates(types.size(), 0.0)
+{
+	if (window == 0) throw std::runtime_error("A window of the rates needs at least one step.");
+}
+
+void PopulationRates::header(std::ostream *outstr) const
+{
+	*outstr << "Time(ms)";
+	for (const auto& type : types) *outstr << '\t' << type.name;
+	*outstr << '\n';
+}
+
+void PopulationRates::add(const std::vector<size_t>& firing)
+{
+	size_t k(0);
+	for (const auto& n : firing) {
+		while (k < types.size() and n >= types[k].last) ++k;
+		if (k == types.size()) break;
+		if (n >= types[k].first) window_spikes[k] += 1.0;
+	}
+}
+
+void PopulationRates::step(const int& t, std::ostream *outstr)
+{
+	last = t;
+	++window_steps;
+	if (window_steps == window) write(outstr);
+}
+
+void PopulationRates::flush(std::ostream *outstr)
+{
+	if (window_steps > 0) write(outstr);
+}
+
+void PopulationRates::write(std::ostream *outstr)
+{
+	double seconds = window_steps*dt/1000.0;
+	for (size_t k(0); k<types.size(); ++k) {
+		rates[k] = window_spikes[k]/((types[k].last - types[k].first)*seconds);
+		total_spikes[k] += window_spikes[k];
+		window_spikes[k] = 0.0;
+	}
+	total_steps += window_steps;
+	window_steps = 0;
+	if (not outstr) return;
+	*outstr << last*dt;
+	for (const auto& rate : rates) *outstr << '\t' << rate;
+	*outstr << '\n';
+}
+
+std::vector<double> PopulationRates::mean_rates() const
+{
+	std::vector<double> means(types.size(), 0.0);
+	double seconds = (total_steps + window_steps)*dt/1000.0;
+	for (size_t k(0); k<types.size() and seconds > 0; ++k) {
+		means[k] = (total_spikes[k] + window_spikes[k])/((types[k].last - types[k].first)*seconds);
+	}
+	return means;
+}
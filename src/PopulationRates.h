@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Generator.h"
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*! \class PopulationRates
+ * Firing rate of each type of neuron, by windows of steps: the rate statistics of a run.
+ *
+ * The file starts with the header "Time(ms)" followed by the types, then has one line per window:
+ * the time at the end of the window (ms) and the mean firing rate (Hz) of the neurons of each type over the window.
+ * The rates are the spikes counted in the window divided by the number of neurons of the type and by the duration of the window.
+ * A \ref Network run counts its spikes, a \ref MeanField run adds the expected number of spikes of each type:
+ * both write the same file.
+ */
+
+class PopulationRates {
+public:
+/*!
+ * Rates of the neurons of the \p types (contiguous ids), over windows of \p window steps of \p dt ms
+ */
+	PopulationRates(const std::vector<Type_block>& types, const size_t& window, const double& dt);
+
+	void header(std::ostream *outstr) const;
+/*!
+ * Counts the spikes of the neurons \p firing (ids in increasing order) at the current step
+ */
+	void add(const std::vector<size_t>& firing);
+/*!
+ * Counts \p spikes spikes of the neurons of the type \p k at the current step
+ */
+	void add(const size_t& k, const double& spikes) { window_spikes[k] += spikes; }
+/*!
+ * Ends the step \p t: the line of the window is written on \p outstr (if not nullptr) when the window is complete
+ */
+	void step(const int& t, std::ostream *outstr);
+/*!
+ * Writes the line of the last window if it is not complete, at the end of the run
+ */
+	void flush(std::ostream *outstr);
+
+	const std::vector<Type_block>& get_types() const { return types; }
+/*!
+ * Rates of each type over the last complete window (Hz)
+ */
+	const std::vector<double>& get_rates() const { return rates; }
+/*!
+ * Rates of each type over all the steps counted so far (Hz)
+ */
+	std::vector<double> mean_rates() const;
+
+private:
+	void write(std::ostream *outstr);
+
+	std::vector<Type_block> types;
+	size_t window;
+	double dt;
+	std::vector<double> window_spikes, total_spikes, rates;
+	size_t window_steps = 0, total_steps = 0;
+	int last = 0;
+};
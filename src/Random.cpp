@@ -1,5 +1,7 @@
 #include "Random.h"
 
+RandomNumbers *_RNG = nullptr;
+
 
 RandomNumbers::RandomNumbers(unsigned long int s) : seed(s) {
     if (seed == 0) {
@@ -0,0 +1,384 @@
+#include "Server.h"
+#include "Validation.h"
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+/*!
+ * Replies are sent by blocks of about this size
+ */
+const size_t Block = 1 << 16;
+
+std::string option(const std::map<std::string, std::string>& options, const std::string& key, const std::string& fallback)
+{
+	auto value = options.find(key);
+	return (value == options.end() ? fallback : value->second);
+}
+
+double number(const std::map<std::string, std::string>& options, const std::string& key, const double& fallback)
+{
+	auto value = options.find(key);
+	if (value == options.end()) return fallback;
+	size_t end(0);
+	double x(0.0);
+	try { x = std::stod(value->second, &end); } catch (std::exception&) {}
+	if (end == 0 or end != value->second.size()) throw std::runtime_error("Invalid value of " + key + ".");
+	return x;
+}
+
+void check(const std::string& what, const std::string& value, const std::vector<std::string>& allowed)
+{
+	if (std::find(allowed.begin(), allowed.end(), value) == allowed.end()) throw std::runtime_error("Unknown " + what + " " + value + ".");
+}
+}
+
+Server::Server(const std::string& path, unsigned int threads)
+: path(path)
+{
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (path.empty() or path.size() >= sizeof(address.sun_path)) throw OUTPUT_ERROR("Invalid socket path " + path + ".");
+	std::strcpy(address.sun_path, path.c_str());
+	listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0) throw OUTPUT_ERROR(std::string("Cannot create a socket: ") + std::strerror(errno));
+	unlink(path.c_str());
+	if (bind(listener, (sockaddr*)&address, sizeof(address)) != 0 or listen(listener, 64) != 0) {
+		std::string error = std::strerror(errno);
+		close(listener);
+		throw OUTPUT_ERROR("Cannot listen on " + path + ": " + error);
+	}
+	if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned int w(0); w<threads; ++w) workers.emplace_back(&Server::work, this);
+}
+
+Server::~Server()
+{
+	stop();
+	for (auto& conversation : conversations) conversation.first.join();
+	{
+		std::lock_guard<std::mutex> guard(jobs_lock);
+		finished = true;
+	}
+	wake.notify_all();
+	for (auto& worker : workers) worker.join();
+	close(listener);
+	unlink(path.c_str());
+}
+
+Server::Connection::~Connection()
+{
+	close(fd);
+}
+
+bool Server::Connection::send(const std::string& text)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	for (size_t sent(0); sent<text.size() and not broken; ) {
+		ssize_t written = ::send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+		if (written < 0 and errno == EINTR) continue;
+		if (written <= 0) broken = true;
+		else sent += written;
+	}
+	return not broken;
+}
+
+void Server::Connection::wait()
+{
+	std::unique_lock<std::mutex> guard(lock);
+	done.wait(guard, [this] { return pending == 0; });
+}
+
+void Server::serve()
+{
+	while (true) {
+		int fd = accept(listener, nullptr, nullptr);
+		if (fd < 0) {
+			if (errno == EINTR or errno == ECONNABORTED) continue;
+			break;														// the listener was shut down by stop
+		}
+		std::lock_guard<std::mutex> guard(clients_lock);
+		if (stopping) {
+			close(fd);
+			break;
+		}
+		for (size_t k(0); k<conversations.size(); ) {					// threads of the closed connections
+			if (not *conversations[k].second) {
+				++k;
+				continue;
+			}
+			conversations[k].first.join();
+			conversations[k] = std::move(conversations.back());
+			conversations.pop_back();
+		}
+		std::shared_ptr<Connection> client = std::make_shared<Connection>(fd);
+		clients.push_back(client);
+		std::shared_ptr<std::atomic<bool>> over = std::make_shared<std::atomic<bool>>(false);
+		conversations.emplace_back(std::thread([this, client, over] { converse(client); *over = true; }), over);
+	}
+	stop();
+	std::lock_guard<std::mutex> guard(clients_lock);
+	for (const auto& client : clients) {								// wakes the threads reading the connections
+		std::shared_ptr<Connection> connection = client.lock();
+		if (connection) shutdown(connection->fd, SHUT_RD);
+	}
+}
+
+void Server::stop()
+{
+	std::lock_guard<std::mutex> guard(clients_lock);
+	if (stopping) return;
+	stopping = true;
+	shutdown(listener, SHUT_RDWR);
+}
+
+void Server::converse(std::shared_ptr<Connection> client)
+{
+	std::string buffer;
+	char chunk[4096];
+	size_t jobs(0);
+	while (true) {
+		ssize_t got = recv(client->fd, chunk, sizeof(chunk), 0);
+		if (got < 0 and errno == EINTR) continue;
+		if (got <= 0) break;
+		buffer.append(chunk, got);
+		size_t end;
+		while ((end = buffer.find('\n')) != std::string::npos) {
+			std::istringstream line(buffer.substr(0, end));
+			buffer.erase(0, end + 1);
+			std::vector<std::string> words;
+			for (std::string word; line >> word; ) words.push_back(word);
+			if (not words.empty()) execute(words, client, jobs);
+		}
+	}
+	client->wait();
+}
+
+void Server::execute(const std::vector<std::string>& words, const std::shared_ptr<Connection>& client, size_t& jobs)
+{
+	const std::string& command = words[0];
+	if (command == "run") ++jobs;
+	std::string prefix = (command == "run" ? std::to_string(jobs) + " " : "");
+	try {
+		Options options;
+		for (size_t k(2); k<words.size(); ++k) {
+			size_t equal = words[k].find('=');
+			if (equal == std::string::npos or equal == 0) throw std::runtime_error("Expected key=value, got " + words[k] + ".");
+			options[words[k].substr(0, equal)] = words[k].substr(equal + 1);
+		}
+		if (command == "list") {
+			std::string reply;
+			std::lock_guard<std::mutex> guard(networks_lock);
+			for (const auto& resident : networks) {
+				reply += "network " + resident.first + " " + std::to_string(resident.second->network->get_size()) + " "
+					   + std::to_string(resident.second->links) + "\n";
+			}
+			client->send(reply + "ok list\n");
+			return;
+		}
+		if (command == "shutdown") {
+			client->send("ok shutdown\n");
+			stop();
+			return;
+		}
+		if (words.size() < 2) throw std::runtime_error("Missing network name.");
+		const std::string& name = words[1];
+		if (command == "build") client->send(build(name, options));
+		else if (command == "edit") client->send(edit(name, options));
+		else if (command == "drop") {
+			std::lock_guard<std::mutex> guard(networks_lock);
+			if (networks.erase(name) == 0) throw std::runtime_error("Unknown network " + name + ".");
+			client->send("ok drop " + name + "\n");
+		}
+		else if (command == "run") {
+			std::shared_ptr<Resident> resident;
+			{
+				std::lock_guard<std::mutex> guard(networks_lock);
+				auto found = networks.find(name);
+				if (found == networks.end()) throw std::runtime_error("Unknown network " + name + ".");
+				resident = found->second;
+			}
+			{
+				std::lock_guard<std::mutex> guard(client->lock);
+				++client->pending;
+			}
+			size_t job = jobs;
+			std::lock_guard<std::mutex> guard(jobs_lock);
+			this->jobs.push_back([this, client, job, resident, options] { run(client, job, resident, options); });
+			wake.notify_one();
+		}
+		else throw std::runtime_error("Unknown command " + command + ".");
+	} catch (std::exception& e) {
+		client->send(prefix + "error " + e.what() + "\n");
+	}
+}
+
+std::string Server::build(const std::string& name, const Options& options)
+{
+	static const std::vector<std::string> keys {"number", "types", "delta", "connectivity", "model", "intensity", "dt", "integrator",
+												"engine", "reorder", "compress", "seed", "threads", "matrix"};
+	for (const auto& entry : options) check("option", entry.first, keys);
+	std::vector<std::string> models {"constant", "poisson", "over-dispersed"};
+	for (const auto& m : Generator::Models) models.push_back(m);
+	std::vector<std::string> integrators, engines;
+	for (const auto& scheme : Neuron::Integrators) integrators.push_back(scheme.first);
+	for (const auto& engine : Network::Engines) engines.push_back(engine.first);
+	std::string model = option(options, "model", "poisson");
+	check("model", model, models);
+	check("integrator", option(options, "integrator", "euler"), integrators);
+	check("engine", option(options, "engine", "pull"), engines);
+	check("ordering", option(options, "reorder", "none"), Ordering::Methods);
+	check("compression", option(options, "compress", "none"), CompressedTopology::Modes);
+	double size = number(options, "number", _Numbers_), threads = number(options, "threads", 1);
+	if (size <= 0 or threads < 0) throw std::runtime_error("Parameters are non valid.");
+
+	Wiring_parameters wiring;
+	if (options.count("matrix")) wiring.matrix = Connectivity_matrix::parse(option(options, "matrix", ""));
+
+	auto begin = std::chrono::steady_clock::now();
+	std::shared_ptr<Resident> resident = std::make_shared<Resident>();
+	{
+		std::lock_guard<std::mutex> guard(generator_lock);
+		if (options.count("seed")) *_RNG = RandomNumbers((unsigned long)number(options, "seed", 0));
+		resident->network.reset(new Network((size_t)size, option(options, "types", ""), number(options, "delta", _Delta_),
+											number(options, "connectivity", _Connectivity_), model, number(options, "intensity", _Intensity_), wiring));
+		Network& network = *resident->network;
+		network.set_integrator(option(options, "integrator", "euler"), number(options, "dt", _Time_Step_));
+		network.set_engine(option(options, "engine", "pull"));
+		network.reorder(option(options, "reorder", "none"));
+		resident->links = network.get_topology().synapses();
+		network.compress(option(options, "compress", "none"));
+		network.set_threads((unsigned int)threads);
+		network.place();
+		network.set_seed((unsigned long)_RNG->uniform_int(1, 2147483647));
+	}
+	double wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	std::lock_guard<std::mutex> guard(networks_lock);
+	networks[name] = resident;
+	return "ok build " + name + " " + std::to_string(resident->network->get_size()) + " " + std::to_string(resident->links) + " " + std::to_string(wall) + "\n";
+}
+
+std::string Server::edit(const std::string& name, const Options& options)
+{
+	static const std::vector<std::string> keys {"op", "post", "pre", "intensity", "neuron", "type"};
+	static const std::vector<std::string> operations {"add-link", "remove-link", "reweight", "add-neuron", "remove-neuron", "compact"};
+	for (const auto& entry : options) check("option", entry.first, keys);
+	std::string operation = option(options, "op", "");
+	check("edit", operation, operations);
+	std::shared_ptr<Resident> resident;
+	{
+		std::lock_guard<std::mutex> guard(networks_lock);
+		auto found = networks.find(name);
+		if (found == networks.end()) throw std::runtime_error("Unknown network " + name + ".");
+		resident = found->second;
+	}
+	std::lock_guard<std::mutex> busy(resident->lock);					// between two jobs
+	Network& network = *resident->network;
+	double post = number(options, "post", -1), pre = number(options, "pre", -1), neuron = number(options, "neuron", -1);
+	if ((operation.find("link") != std::string::npos or operation == "reweight") and (post < 0 or pre < 0))
+		throw std::runtime_error("Missing post= or pre=.");
+	size_t result(0);
+	if (operation == "add-link") {
+		result = network.add_link((size_t)post, (size_t)pre, number(options, "intensity", _Intensity_));
+		resident->links += result;
+	}
+	else if (operation == "remove-link") {
+		result = network.remove_link((size_t)post, (size_t)pre);
+		resident->links -= result;
+	}
+	else if (operation == "reweight") result = network.set_intensity((size_t)post, (size_t)pre, number(options, "intensity", _Intensity_));
+	else if (operation == "add-neuron") {
+		std::lock_guard<std::mutex> guard(generator_lock);
+		result = network.add_neuron(option(options, "type", "RS"));
+	}
+	else if (operation == "remove-neuron") {
+		if (neuron < 0) throw std::runtime_error("Missing neuron=.");
+		network.remove_neuron((size_t)neuron);
+		result = 1;
+	}
+	else network.compact();
+	return "ok edit " + name + " " + std::to_string(result) + " " + std::to_string(network.pending_edits()) + "\n";
+}
+
+void Server::run(const std::shared_ptr<Connection>& client, const size_t& job, const std::shared_ptr<Resident>& resident, const Options& options)
+{
+	std::string prefix = std::to_string(job) + " ", reply;
+	try {
+		std::lock_guard<std::mutex> busy(resident->lock);				// one job at a time on a network
+		Network& network = *resident->network;
+		static const std::vector<std::string> keys {"steps", "seed", "reset", "outputs", "stimulus"};
+		for (const auto& entry : options) check("option", entry.first, keys);
+		double steps = number(options, "steps", std::ceil(_Simulation_Time_/network.get_time_step()));
+		if (steps < 0) throw std::runtime_error("Parameters are non valid.");
+		std::vector<std::string> outputs;
+		std::istringstream list(option(options, "outputs", "spikes"));
+		for (std::string output; std::getline(list, output, ','); ) {
+			check("output", output, {"spikes", "count", "sample", "hash"});
+			outputs.push_back(output);
+		}
+		unsigned long seed;
+		if (options.count("seed")) seed = (unsigned long)number(options, "seed", 0);
+		else {
+			std::lock_guard<std::mutex> guard(generator_lock);
+			seed = (unsigned long)_RNG->uniform_int(1, 2147483647);
+		}
+		if (number(options, "reset", 1) != 0) network.reset();
+		if (options.count("stimulus")) network.set_stimulus(Stimulus::read(options.at("stimulus")), network.get_steps());	// from the first step of the job
+		network.set_seed(seed);
+
+		auto begin = std::chrono::steady_clock::now();
+		size_t spikes(0);
+		for (size_t t(1); t<=(size_t)steps; ++t) {
+			const std::vector<size_t>& firing = network.update();
+			spikes += firing.size();
+			for (const auto& output : outputs) {
+				reply += prefix + output + " " + std::to_string(t);
+				if (output == "spikes") for (const auto& n : firing) reply += " " + std::to_string(n);
+				else if (output == "count") reply += " " + std::to_string(firing.size());
+				else if (output == "sample") {
+					std::ostringstream sample;
+					for (const auto& n : network.get_sample_neurons())
+						sample << ' ' << network.get_potential(n) << ' ' << network.get_recovery(n) << ' ' << network.get_current(n);
+					reply += sample.str();
+				}
+				else {
+					std::ostringstream hash;
+					hash << std::hex << ' ' << Validation::spike_hash(firing) << ' ' << Validation::state_hash(network);
+					reply += hash.str();
+				}
+				reply += '\n';
+			}
+			if (reply.size() >= Block) {								// the results are streamed while the job runs
+				if (not client->send(reply)) break;						// nobody is reading them any more
+				reply.clear();
+			}
+		}
+		double wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+		client->send(reply + prefix + "done " + std::to_string((size_t)steps) + " " + std::to_string(spikes) + " " + std::to_string(wall) + "\n");
+	} catch (std::exception& e) {
+		client->send(reply + prefix + "error " + e.what() + "\n");
+	}
+	std::lock_guard<std::mutex> guard(client->lock);
+	if (--client->pending == 0) client->done.notify_all();
+}
+
+void Server::work()
+{
+	while (true) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> guard(jobs_lock);
+			wake.wait(guard, [this] { return not jobs.empty() or finished; });
+			if (jobs.empty()) return;
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+		job();
+	}
+}
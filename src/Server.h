@@ -0,0 +1,126 @@
+#pragma once
+
+#include "Network.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/*! \class Server
+ * Keeps networks built once in memory and runs simulation jobs on them, for clients connecting to a local Unix socket.
+ *
+ * The clients send lines of words; options are given as key=value. The commands are:
+ * - build <name> [number= types= delta= connectivity= model= intensity= dt= integrator= engine= reorder= compress= seed= threads= matrix=]:
+ *   builds a network (defaults of the command line, threads computing its steps) and keeps it under \p name.
+ *   Replies "ok build <name> <neurons> <links> <ms>".
+ * - run <name> [steps= seed= reset= stimulus= outputs=spikes,count,sample,hash]: queues a job on the network, with the \ref Stimulus file
+ *   stimulus= if given, its step 1 being the first step of the job (it is kept for the next jobs on the network). Jobs are numbered from 1 on
+ *   each connection and every line they send starts with this number: "<job> spikes <step> <ids...>", "<job> count <step> <n>",
+ *   "<job> sample <step> <v u I of each sample neuron>", "<job> hash <step> <spike hash> <state hash>" (see \ref Validation),
+ *   then "<job> done <steps> <spikes> <ms>" or "<job> error <message>". Unless reset=0, the neurons start again from their
+ *   initial state; the noise is drawn from \p seed (or from a seed drawn by the server).
+ * - edit <name> op= [post= pre= intensity= neuron= type=]: changes the network between jobs (see \ref Network::add_neuron),
+ *   op being add-link, remove-link or reweight (link from pre to post), remove-neuron (neuron), add-neuron (type) or compact.
+ *   It waits for the job running on the network. Replies "ok edit <name> <result> <pending edits>", the result being 1 or 0
+ *   (whether the link could be changed) or the id of the new neuron.
+ * - drop <name>, list: forget a network, or describe them ("network <name> <neurons> <links>" lines then "ok list").
+ * - shutdown: stops the server once the queued jobs are done.
+ *
+ * Errors in a command are replied as "error <message>". Jobs run concurrently on a pool of threads, each network running one job
+ * at a time: the jobs of one connection may thus finish out of order. The networks are built one at a time, as they draw from the
+ * global generator; the jobs draw their noise from the generator of their network.
+ */
+
+class Server {
+public:
+/*!
+ * Listens on the socket \p path (replacing a former socket file), with \p threads threads running the jobs (0 for one per core).
+ * Throws an \ref OUTPUT_ERROR if the socket cannot be opened.
+ */
+	Server(const std::string& path, unsigned int threads);
+	~Server();
+	Server(const Server&) = delete;
+	Server& operator=(const Server&) = delete;
+
+/*!
+ * Serves the clients until a shutdown command or \ref stop
+ */
+	void serve();
+/*!
+ * Makes \ref serve return, once the queued jobs are done
+ */
+	void stop();
+
+private:
+/*!
+ * A network kept between the jobs, with its number of links. \p lock is held by the job running on it.
+ */
+	struct Resident {std::unique_ptr<Network> network;
+					 size_t links;
+					 std::mutex lock;};
+/*!
+ * A client. Its socket is closed once its jobs are done and it hung up.
+ */
+	struct Connection {
+		explicit Connection(int fd) : fd(fd) {}
+		~Connection();
+/*!
+ * Sends \p text at once, false if the client is gone
+ */
+		bool send(const std::string& text);
+/*!
+ * Waits until the jobs of the connection are done
+ */
+		void wait();
+		int fd;
+		std::mutex lock;
+		std::condition_variable done;
+		size_t pending = 0;
+		bool broken = false;
+	};
+	typedef std::map<std::string, std::string> Options;
+
+/*!
+ * Reads and executes the commands of \p client until it hangs up
+ */
+	void converse(std::shared_ptr<Connection> client);
+/*!
+ * Executes the command made of \p words, sending the replies to \p client; \p jobs counts its run commands
+ */
+	void execute(const std::vector<std::string>& words, const std::shared_ptr<Connection>& client, size_t& jobs);
+	std::string build(const std::string& name, const Options& options);
+	std::string edit(const std::string& name, const Options& options);
+/*!
+ * Runs job \p job of \p client on \p resident
+ */
+	void run(const std::shared_ptr<Connection>& client, const size_t& job, const std::shared_ptr<Resident>& resident, const Options& options);
+/*!
+ * Loop of the threads running the \ref jobs
+ */
+	void work();
+
+	std::string path;
+	int listener;
+	bool stopping = false;
+
+	std::map<std::string, std::shared_ptr<Resident>> networks;
+	std::mutex networks_lock;
+/*!
+ * Held while the global generator is used: building a network, adding a neuron, drawing a seed
+ */
+	std::mutex generator_lock;
+
+	std::deque<std::function<void()>> jobs;
+	std::mutex jobs_lock;
+	std::condition_variable wake;
+	std::vector<std::thread> workers;
+	bool finished = false;
+/*!
+ * Thread reading each connection, and whether it is over
+ */
+	std::vector<std::pair<std::thread, std::shared_ptr<std::atomic<bool>>>> conversations;
+	std::vector<std::weak_ptr<Connection>> clients;
+	std::mutex clients_lock;
+};
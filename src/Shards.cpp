@@ -0,0 +1,112 @@
+#include "Shards.h"
+#include <sstream>
+
+namespace {
+const std::string Shard_tag = "#shard";
+
+std::string shard_name(const std::string& path, const size_t& k)
+{
+	return path + ".shard" + std::to_string(k);
+}
+
+/*!
+ * Length of the step at the beginning of \p line: the line goes on with a space (raster) or a tab (sample)
+ */
+size_t step_length(const std::string& line)
+{
+	size_t end = line.find_first_of(" \t");
+	return (end == std::string::npos ? line.size() : end);
+}
+}
+
+ShardedOutput::ShardedOutput(Network& network, const size_t& n_shards, const std::string& raster, const std::string& sample)
+	: network(network), pool((unsigned int)n_shards)
+{
+	if (n_shards == 0) throw OUTPUT_ERROR("An output needs at least one shard.");
+	size_t neurons = network.get_size(), samples = network.get_sample_neurons().size();
+	line.assign(2*neurons, ' ');
+	for (size_t i(0); i < neurons; ++i) line[2*i+1] = '0';
+	for (size_t k(0); k<n_shards; ++k) {
+		shards.emplace_back(new Shard{k*neurons/n_shards, (k+1)*neurons/n_shards, k*samples/n_shards, (k+1)*samples/n_shards, {}, {}});
+		Shard& shard = *shards.back();
+		if (raster.length()) {
+			shard.raster.open(shard_name(raster, k), std::ios_base::out);
+			if (not shard.raster.is_open()) throw OUTPUT_ERROR("Cannot create the shard " + shard_name(raster, k) + ".");
+			shard.raster << Shard_tag << ' ' << k << ' ' << n_shards << ' ' << shard.first << ' ' << shard.last << '\n';
+		}
+		if (sample.length()) {
+			shard.sample.open(shard_name(sample, k), std::ios_base::out);
+			if (not shard.sample.is_open()) throw OUTPUT_ERROR("Cannot create the shard " + shard_name(sample, k) + ".");
+			shard.sample << Shard_tag << ' ' << k << ' ' << n_shards << ' ' << shard.sample_first << ' ' << shard.sample_last << '\n';
+			network.header_sample(&shard.sample, shard.sample_first, shard.sample_last);
+		}
+	}
+}
+
+void ShardedOutput::write(const int& t, const std::vector<size_t>& firing)
+{
+	for (const auto& n : firing) line[2*n+1] = '1';
+	pool.run(shards.size(), [&](const size_t& k) {
+		Shard& shard = *shards[k];
+		if (shard.raster.is_open()) {
+			shard.raster << t;
+			shard.raster.write(line.data() + 2*shard.first, 2*(shard.last - shard.first));
+			shard.raster << '\n';
+		}
+		if (shard.sample.is_open()) network.print_sample(t, &shard.sample, shard.sample_first, shard.sample_last);
+	}, false);
+	for (const auto& n : firing) line[2*n+1] = '0';
+}
+
+void ShardedOutput::close()
+{
+	bool failed(false);
+	for (auto& shard : shards) {
+		if (shard->raster.is_open()) shard->raster.close();
+		if (shard->sample.is_open()) shard->sample.close();
+		failed = failed or shard->raster.fail() or shard->sample.fail();
+	}
+	if (failed) throw OUTPUT_ERROR("Cannot write the shards of the output.");
+}
+
+ShardReader::ShardReader(const std::string& path)
+	: path(path)
+{
+	std::unique_ptr<std::ifstream> first(new std::ifstream(shard_name(path, 0)));
+	if (not first->is_open()) {													// a single file
+		files.emplace_back(new std::ifstream(path));
+		if (not files.back()->is_open()) throw CFILE_ERROR("Cannot open " + path + ".");
+		return;
+	}
+	size_t n_shards(1), end(0);
+	for (size_t k(0); k<n_shards; ++k) {
+		if (k > 0) first.reset(new std::ifstream(shard_name(path, k)));
+		std::string header, tag;
+		size_t index, count, from, to;
+		std::getline(*first, header);
+		std::istringstream fields(header);
+		if (not first->is_open() or not (fields >> tag >> index >> count >> from >> to) or tag != Shard_tag
+			or index != k or (k > 0 and count != n_shards) or from != end or to < from)
+			throw CFILE_ERROR(shard_name(path, k) + " is not shard " + std::to_string(k) + " of " + path + ".");
+		n_shards = count;
+		end = to;
+		files.push_back(std::move(first));
+	}
+}
+
+bool ShardReader::next(std::string& line)
+{
+	if (not std::getline(*files[0], line)) {
+		for (size_t k(1); k<files.size(); ++k) {
+			if (std::getline(*files[k], part)) throw CFILE_ERROR("The shards of " + path + " do not have the same number of lines.");
+		}
+		return false;
+	}
+	size_t step = step_length(line);
+	for (size_t k(1); k<files.size(); ++k) {
+		if (not std::getline(*files[k], part) or step_length(part) != step or part.compare(0, step, line, 0, step) != 0)
+			throw CFILE_ERROR("The shards of " + path + " are not aligned on the step " + line.substr(0, step) + ".");
+		line.append(part, step, std::string::npos);
+	}
+	return true;
+}
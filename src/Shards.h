@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Network.h"
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*! \class ShardedOutput
+ * Raster and sample files written as sets of shards, each shard by its own thread and through its own file.
+ *
+ * Shard k of K holds the columns of a range of neurons: the neurons k*N/K to (k+1)*N/K -1 of the raster,
+ * and the sample neurons k*S/K to (k+1)*S/K -1 of the sample file. The shards of \p path are named \p path.shard0, \p path.shard1...
+ * Each one starts with the line "#shard k K first last" (its columns first to last -1), then holds one line per step,
+ * starting with the step as in the single file: the lines of the shards are aligned, the i-th line of each shard being the same step.
+ * Gluing the lines of the shards (the step written once) gives back the single file, byte for byte: see \ref ShardReader.
+ */
+
+class ShardedOutput {
+public:
+/*!
+ * Opens \p shards shards of the raster \p raster and of the sample file \p sample of \p network (no file for an empty name),
+ * and writes the header of the sample file. Throws an \ref OUTPUT_ERROR if a shard cannot be created.
+ */
+	ShardedOutput(Network& network, const size_t& shards, const std::string& raster, const std::string& sample);
+/*!
+ * Writes the line of step \p t in each shard, the neurons \p firing (increasing ids) firing
+ */
+	void write(const int& t, const std::vector<size_t>& firing);
+	void close();
+
+	size_t size() const { return shards.size(); }
+
+private:
+	struct Shard {size_t first, last, sample_first, sample_last;
+				  std::ofstream raster, sample;};
+
+	Network& network;
+	WorkPool pool;
+	std::vector<std::unique_ptr<Shard>> shards;
+/*!
+ * Raster line of the current step, without its step: " 0 1 0 ...", each shard writing its part
+ */
+	std::string line;
+};
+
+/*! \class ShardReader
+ * Reads a raster or sample file as it was written by a single thread, from its shards if it was sharded.
+ *
+ * The next line of every shard is read, and the lines are glued: this is a merge of K sorted streams by step,
+ * checking that the shards give the same step. A file without shards is read as it is.
+ */
+
+class ShardReader {
+public:
+/*!
+ * Opens the shards of \p path (\p path.shard0...), or \p path itself if it has no shards.
+ * Throws a \ref CFILE_ERROR if a shard is missing or does not belong to the set.
+ */
+	explicit ShardReader(const std::string& path);
+/*!
+ * Reads the next line of the file into \p line (without its end of line); returns false at the end of the file.
+ * Throws a \ref CFILE_ERROR if the shards are not aligned.
+ */
+	bool next(std::string& line);
+
+	size_t size() const { return files.size(); }
+
+private:
+	std::string path;
+	std::vector<std::unique_ptr<std::ifstream>> files;
+	std::string part;
+};
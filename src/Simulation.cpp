@@ -1,4 +1,9 @@
 #include "Simulation.h"
+#include <chrono>
+#include <sstream>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
 
 Simulation::Simulation(int argc, char **argv)
 {
@@ -6,7 +11,19 @@ Simulation::Simulation(int argc, char **argv)
      allowed.push_back("constant");
      allowed.push_back("poisson");
      allowed.push_back("over-dispersed");
+     for (const auto& m : Generator::Models) allowed.push_back(m);
      TCLAP::ValuesConstraint<std::string> allowed_models(allowed);
+     std::vector<std::string> schemes;
+     for (const auto& scheme : Neuron::Integrators) schemes.push_back(scheme.first);
+     TCLAP::ValuesConstraint<std::string> allowed_schemes(schemes);
+     std::vector<std::string> orderings(Ordering::Methods);
+     TCLAP::ValuesConstraint<std::string> allowed_orderings(orderings);
+     std::vector<std::string> compressions(CompressedTopology::Modes);
+     TCLAP::ValuesConstraint<std::string> allowed_compressions(compressions);
+     std::vector<std::string> engines;
+     for (const auto& engine : Network::Engines) engines.push_back(engine.first);
+     engines.push_back("mean-field");
+     TCLAP::ValuesConstraint<std::string> allowed_engines(engines);
 
      try {
 		// get the parameter in the command line
@@ -19,8 +36,62 @@ Simulation::Simulation(int argc, char **argv)
         cmd.add(delta);
         TCLAP::ValueArg<std::string> connectivity_model("M", "model", "dispersion model", false, "poisson", &allowed_models );
         cmd.add(connectivity_model);
-        TCLAP::ValueArg<int> time("t", "time", "Total simulation Time", false, _Simulation_Time_ , "int");
+        TCLAP::ValueArg<double> rewiring("", "rewiring", "rewiring probability of the small-world model", false, _Rewiring_, "double");
+        cmd.add(rewiring);
+        TCLAP::ValueArg<double> sigma("", "sigma", "connection distance of the spatial model (grid units)", false, _Sigma_, "double");
+        cmd.add(sigma);
+        TCLAP::ValueArg<std::string> matrix("", "matrix", "links between the types of the types model: PRE->POST:probability:intensity,... or a file", false, "", "string");
+        cmd.add(matrix);
+        TCLAP::ValueArg<std::string> ordering("", "reorder", "order in which neurons are stored", false, "none", &allowed_orderings);
+        cmd.add(ordering);
+        TCLAP::ValueArg<std::string> compression("", "compress", "storage of the links: quantized intensities on 16 or 8 bits", false, "none", &allowed_compressions);
+        cmd.add(compression);
+        TCLAP::ValueArg<std::string> stream("", "stream", "file from which the links are read at every step, to simulate networks larger than memory", false, "", "string");
+        cmd.add(stream);
+        TCLAP::ValueArg<double> stream_memory("", "stream-memory", "memory used by the links read from the --stream file (MB)", false, _Stream_Memory_, "double");
+        cmd.add(stream_memory);
+        TCLAP::SwitchArg stdp("", "stdp", "spike-timing-dependent plasticity of the link intensities", false);
+        cmd.add(stdp);
+        TCLAP::ValueArg<double> stdp_max("", "stdp-max", "maximal intensity of a plastic link", false, _STDP_Max_Weight_, "double");
+        cmd.add(stdp_max);
+        TCLAP::ValueArg<std::string> stimulus("", "stimulus", "schedule of the currents injected into the neurons (pulses, ramps, spike trains)", false, "", "string");
+        cmd.add(stimulus);
+        TCLAP::ValueArg<int> n_trials("", "trials", "number of independent trials, differing by their noise, simulated together", false, 1, "int");
+        cmd.add(n_trials);
+        TCLAP::ValueArg<int> threads("j", "threads", "number of threads, 0 for one per core", false, 0, "int");
+        cmd.add(threads);
+        TCLAP::ValueArg<std::string> pin("", "pin", "cores to which the threads are pinned, e.g. 0,2,4-7", false, "", "string");
+        cmd.add(pin);
+        TCLAP::ValueArg<double> mem_limit("", "mem-limit", "memory the run may use (MB), the available memory by default", false, 0, "double");
+        cmd.add(mem_limit);
+        TCLAP::SwitchArg huge_pages("", "huge-pages", "back the large arrays with huge pages", false);
+        cmd.add(huge_pages);
+        TCLAP::ValueArg<std::string> engine("", "engine", "way of gathering the inputs of the neurons", false, "pull", &allowed_engines);
+        cmd.add(engine);
+        TCLAP::ValueArg<int> field_samples("", "mean-field-samples", "number of neurons representing each type in the mean-field engine", false, _Mean_Field_Samples_, "int");
+        cmd.add(field_samples);
+        TCLAP::SwitchArg validate("", "validate", "runs the reference engine alongside and reports the first step where they differ", false);
+        cmd.add(validate);
+        TCLAP::ValueArg<double> tolerance("", "tolerance", "largest difference of potential, recovery and current accepted by --validate", false, _Tolerance_, "double");
+        cmd.add(tolerance);
+        TCLAP::ValueArg<double> autotune_time("", "autotune", "time spent timing engines, threads and orders of the neurons on the network before the run (s), the fastest then being used", false, 0, "double");
+        cmd.add(autotune_time);
+        TCLAP::ValueArg<std::string> autotune_cache("", "autotune-cache", "file keeping the configuration chosen by --autotune for each network, empty for none", false, "autotune_cache.txt", "string");
+        cmd.add(autotune_cache);
+        TCLAP::SwitchArg hash("", "hash", "writes hashes of the spikes and of the state of each step in the telemetry file", false);
+        cmd.add(hash);
+        TCLAP::SwitchArg counters("", "counters", "writes the time, cycles, instructions, cache and branch misses of the phases of each step in the telemetry file", false);
+        cmd.add(counters);
+        TCLAP::ValueArg<double> burn_in("", "burn-in", "time simulated once without any output before the run (ms), its steps not counted in --time", false, 0, "double");
+        cmd.add(burn_in);
+        TCLAP::ValueArg<int> n_branches("", "branches", "number of runs continuing the burn-in in forked processes, each with its own seed and --stimulus", false, 1, "int");
+        cmd.add(n_branches);
+        TCLAP::ValueArg<int> time("t", "time", "Total simulation Time (ms)", false, _Simulation_Time_ , "int");
         cmd.add(time);
+        TCLAP::ValueArg<double> step("", "dt", "Length of a time step (ms)", false, _Time_Step_, "double");
+        cmd.add(step);
+        TCLAP::ValueArg<std::string> scheme("I", "integrator", "integration scheme", false, "euler", &allowed_schemes);
+        cmd.add(scheme);
         TCLAP::ValueArg<double> lambda("c", "lambda", "Average Connectivity", false, _Connectivity_, "double");
         cmd.add(lambda);
         TCLAP::ValueArg<double> intens("l", "Intensity", "Average intensity of connections", false, _Intensity_, "double");
@@ -31,23 +102,79 @@ Simulation::Simulation(int argc, char **argv)
         cmd.add(sfile);
         TCLAP::ValueArg<std::string> pfile("p", "parameters", "parameters output file name", false, "param_file.txt", "string");
         cmd.add(pfile);
+        TCLAP::ValueArg<std::string> efile("e", "telemetry", "telemetry output file name (time spent in each step)", false, "", "string");
+        cmd.add(efile);
+        TCLAP::ValueArg<std::string> wfile("w", "weights", "output file of the links at the end of the simulation", false, "", "string");
+        cmd.add(wfile);
+        TCLAP::ValueArg<std::string> rfile("", "rates", "output file of the firing rate of each type of neuron (Hz), by windows", false, "", "string");
+        cmd.add(rfile);
+        TCLAP::ValueArg<double> rate_window("", "rate-window", "length of the windows of the --rates file (ms)", false, _Rate_Window_, "double");
+        cmd.add(rate_window);
+        TCLAP::ValueArg<std::string> archive_file("", "archive", "compact spike file, readable by windows of steps", false, "", "string");
+        cmd.add(archive_file);
+        TCLAP::ValueArg<int> archive_block("", "archive-block", "number of steps of the blocks of the --archive file", false, _Archive_Block_, "int");
+        cmd.add(archive_block);
+        TCLAP::SwitchArg archive_postings("", "archive-postings", "also writes the steps of each neuron in the --archive file, to query them directly", false);
+        cmd.add(archive_postings);
+        TCLAP::ValueArg<int> n_shards("", "shards", "number of shards of the output and sample files, each written by its own thread, 0 for single files", false, 0, "int");
+        cmd.add(n_shards);
+        TCLAP::ValueArg<std::string> shm("", "shm", "name of a shared memory ring publishing each step", false, "", "string");
+        cmd.add(shm);
+        TCLAP::ValueArg<std::string> serve("", "serve", "Unix socket on which jobs are received, keeping the networks built between them", false, "", "string");
+        cmd.add(serve);
+        TCLAP::ValueArg<int> shm_slots("", "shm-slots", "number of steps kept in the shared memory ring", false, 1024, "int");
+        cmd.add(shm_slots);
         cmd.parse(argc, argv);
 
 		//Check the values of parameters get in the command line
-        if ( (delta.getValue() < 0) or (time.getValue() <= 0) or (lambda.getValue() <= 0) or (neuron.getValue() <= 0) or (intens.getValue() < 0))
+        if ( (delta.getValue() < 0) or (time.getValue() <= 0) or (lambda.getValue() <= 0) or (neuron.getValue() <= 0) or (intens.getValue() < 0) or (step.getValue() <= 0) or (shm_slots.getValue() <= 0)
+             or (rewiring.getValue() < 0) or (rewiring.getValue() > 1) or (sigma.getValue() <= 0) or (threads.getValue() < 0) or (stream_memory.getValue() <= 0) or (stdp_max.getValue() < 0)
+             or (n_trials.getValue() < 1) or (n_trials.getValue() > 1 and (stdp.getValue() or scheme.getValue() != "euler" or validate.getValue() or stimulus.getValue().length() or archive_file.getValue().length()))
+             or (matrix.getValue().length() and connectivity_model.getValue() != "types")
+             or (archive_block.getValue() <= 0) or (n_shards.getValue() < 0) or (n_shards.getValue() > 0 and n_trials.getValue() > 1)
+             or (tolerance.getValue() < 0) or (rate_window.getValue() <= 0) or (field_samples.getValue() <= 0)
+             or (rfile.getValue().length() and n_trials.getValue() > 1) or (mem_limit.getValue() < 0)
+             or (burn_in.getValue() < 0) or (n_branches.getValue() < 1) or (autotune_time.getValue() < 0))
         throw(std::runtime_error("Parameters are non valid."));
+        bool approximate = (engine.getValue() == "mean-field");			// only the rates of the types, without neurons nor links
+        if (approximate and (rfile.getValue().empty() or n_trials.getValue() > 1 or validate.getValue() or hash.getValue() or stdp.getValue()
+                             or stimulus.getValue().length() or archive_file.getValue().length() or n_shards.getValue() > 0 or shm.getValue().length()))
+        throw(std::runtime_error("The mean-field engine only writes the --rates file, without trials, validation, plasticity, stimulus or spike outputs."));
+        if ((burn_in.getValue() > 0 or n_branches.getValue() > 1) and (n_trials.getValue() > 1 or validate.getValue() or (approximate and n_branches.getValue() > 1)))
+        throw(std::runtime_error("The burn-in and the branches run a single network, without trials nor validation."));
+        if (n_branches.getValue() > 1 and stdp.getValue())
+        throw(std::runtime_error("The branches share the links of the burn-in, which cannot be plastic."));
+        if (counters.getValue() and (efile.getValue().empty() or n_trials.getValue() > 1 or approximate))
+        throw(std::runtime_error("The --counters are written in the telemetry file (-e) of a single network, without trials nor mean field."));
+        bool tuned = (autotune_time.getValue() > 0);
+        if (tuned and (engine.getValue() != "pull" or n_trials.getValue() > 1 or validate.getValue() or stdp.getValue()
+                       or compression.getValue() != "none" or stream.getValue().length()))
+        throw(std::runtime_error("The autotuner chooses the engine of a single network with its links in memory: without --engine, trials, validation, plasticity, compression nor streaming."));
+        if (n_trials.getValue() > 1 and (compression.getValue() != "none" or stream.getValue().length()))
+        throw(std::runtime_error("The trials share the links of the network in memory: without compression nor streaming."));
+        if (stream.getValue().length() and (ordering.getValue() != "none" or compression.getValue() != "none" or stdp.getValue()))
+        throw(std::runtime_error("The streamed links are written to the file as they are built: without --reorder, compression nor plasticity."));
+        std::stringstream stimulus_list(stimulus.getValue());
+        for (std::string name; std::getline(stimulus_list, name, ','); ) stimuli.push_back(Stimulus::read(name));
+        if (stimuli.size() > 1 and (int)stimuli.size() != n_branches.getValue())
+        throw(std::runtime_error("Give one --stimulus for all the branches, or one per branch."));
 
-        // creation of output file
-        std::string outfname = ofile.getValue();
-        if (outfname.length()) outfile.open(outfname, std::ios_base::out);
-        outfname = sfile.getValue();
-        if (outfname.length()) samplefile.open(outfname, std::ios_base::out);
-        outfname = pfile.getValue();
-        if (outfname.length()) paramfile.open(outfname, std::ios_base::out);
+        if (serve.getValue().length()) {								// the jobs give their own parameters and outputs
+            server = new Server(serve.getValue(), threads.getValue());
+            return;
+        }
+
+        // names of the output files, opened once the network is built (by each branch)
+        outputs = {ofile.getValue(), sfile.getValue(), pfile.getValue(), efile.getValue(), wfile.getValue(), rfile.getValue(),
+                   archive_file.getValue(), shm.getValue(), (size_t)archive_block.getValue(), (size_t)n_shards.getValue(),
+                   (size_t)shm_slots.getValue(), archive_postings.getValue(), step.getValue()};
 
         // Setting of parameters into attributs if simulation
-        endtime = time.getValue();
+        endtime = (int)std::ceil(time.getValue()/step.getValue());		// number of steps needed to cover the simulation time
         number = neuron.getValue();
+        burn_steps = (int)std::ceil(burn_in.getValue()/step.getValue());
+        branches = n_branches.getValue();
+        threads_per_run = threads.getValue();
         connectivity = lambda.getValue();
         intensity = intens.getValue();
         n_types = types.getValue();
@@ -55,7 +182,124 @@ Simulation::Simulation(int argc, char **argv)
         model = connectivity_model.getValue();
 
         // Creation of the neuron network
-        network = new Network(number, n_types, d, connectivity, model, intensity);
+        wiring.rewiring = rewiring.getValue();
+        wiring.sigma = sigma.getValue();
+        wiring.threads = threads.getValue();
+        if (matrix.getValue().length()) wiring.matrix = Connectivity_matrix::parse(matrix.getValue());
+        if (stream.getValue().length()) {								// the links go to the file as they are drawn
+            wiring.stream = stream.getValue();
+            wiring.stream_budget = (size_t)(stream_memory.getValue()*1024*1024);
+        }
+        Memory::set_huge_pages(huge_pages.getValue());
+        size_t window = (size_t)std::max(1.0, std::round(rate_window.getValue()/step.getValue()));
+        if (approximate) {
+            mean_field = new MeanField(number, n_types, d, connectivity, model, intensity, wiring, field_samples.getValue());
+            mean_field->set_integrator(scheme.getValue(), step.getValue());
+            if (rfile.getValue().length()) rates = new PopulationRates(mean_field->get_types(), window, step.getValue());
+            open_outputs("");
+            return;
+        }
+        if (rfile.getValue().length()) rates = new PopulationRates(Network::type_blocks(n_types, number), window, step.getValue());
+
+        // preflight: the memory of the run is checked before minutes are spent building a network that does not fit
+        Footprint_parameters needs;
+        needs.neurons = number;
+        needs.n_types = n_types;
+        needs.model = model;
+        needs.connectivity = connectivity;
+        needs.wiring = wiring;
+        needs.bits = CompressedTopology::bits_of(compression.getValue());
+        needs.stream_budget = (stream.getValue().length() ? (size_t)(stream_memory.getValue()*1024*1024) : 0);
+        needs.reference = (engine.getValue() == "reference");
+        needs.push = (engine.getValue() == "push" or tuned);
+        needs.validate = validate.getValue();
+        needs.plasticity = stdp.getValue();
+        needs.reorder = (ordering.getValue() != "none");
+        needs.trials = n_trials.getValue();
+        needs.raster = (ofile.getValue().length() > 0);
+        needs.shards = n_shards.getValue();
+        needs.archive_block = (archive_file.getValue().length() ? archive_block.getValue() : 0);
+        needs.steps = endtime;
+        needs.ring_slots = (shm.getValue().length() ? shm_slots.getValue() : 0);
+        footprint = Footprint::estimate(needs);
+        print_footprint = (mem_limit.getValue() > 0);
+        size_t limit = (mem_limit.getValue() > 0 ? (size_t)(mem_limit.getValue()*1024*1024) : Memory::available());
+        if (limit > 0 and footprint.peak() > limit and not Generator::is_structured(model) and not wiring.rows and wiring.stream.empty()) {
+            needs.wiring.rows = true;									// the same links, without the map
+            Footprint rows = Footprint::estimate(needs);
+            if (rows.peak() <= limit) {
+                wiring.rows = true;
+                footprint = rows;
+                print_footprint = true;
+                std::cout << "The links are built directly as rows to fit in " << (limit >> 20) << " MB." << std::endl;
+            }
+        }
+        if (limit > 0 and footprint.peak() > limit) {
+            std::ostringstream needed;
+            footprint.print(&needed);
+            needed << ", more than the " << (limit >> 20) << " MB it may use: lower the number of neurons or the connectivity";
+            if (stream.getValue().empty() and not stdp.getValue() and ordering.getValue() == "none" and n_trials.getValue() == 1 and not tuned) {
+                needs.bits = 0;												// the streamed links are written as they are generated
+                for (double megabytes : {stream_memory.getValue(), std::floor(limit/4.0/(1024*1024)), 1.0}) {
+                    needs.stream_budget = (size_t)(megabytes*1024*1024);
+                    Footprint streamed = Footprint::estimate(needs);
+                    if (megabytes < 1 or streamed.peak() > limit) continue;
+                    needed << ", stream the links to a file (--stream with --stream-memory " << megabytes << ": about " << (streamed.peak() >> 20) << " MB)";
+                    break;
+                }
+            }
+            throw std::runtime_error("The run needs about " + needed.str() + ", or raise --mem-limit.");
+        }
+        RandomNumbers seed(*_RNG);
+        network = new Network(number, n_types, d, connectivity, model, intensity, wiring);
+        network->set_integrator(scheme.getValue(), step.getValue());
+        network->set_engine(engine.getValue());
+        for (const auto& scheduled : stimuli) scheduled->check(network->get_size());
+        if (stimuli.size() and burn_steps == 0 and branches == 1) network->set_stimulus(std::move(stimuli[0]));
+        Plasticity_parameters plasticity;
+        plasticity.max_weight = stdp_max.getValue();
+        if (validate.getValue()) {										// the same network again, from the same seed
+            RandomNumbers built(*_RNG);
+            *_RNG = seed;
+            Wiring_parameters in_memory(wiring);							// the reference keeps its links in memory
+            in_memory.stream.clear();
+            reference = new Network(number, n_types, d, connectivity, model, intensity, in_memory);
+            *_RNG = built;
+            reference->set_integrator(scheme.getValue(), step.getValue());
+            if (stdp.getValue()) reference->set_plasticity(plasticity);
+            if (stimulus.getValue().length()) reference->set_stimulus(Stimulus::read(stimulus.getValue()));
+            double tol = tolerance.getValue();
+            validation = new Validation(*network, *reference, {tol, tol, tol});
+        }
+        hashes = hash.getValue();
+        if (tuned) {													// the engine, threads and order are those found fastest for this network
+            std::ostringstream signature;
+            signature << "n=" << number << " types=" << n_types << " model=" << model << " c=" << connectivity << " l=" << intensity << " d=" << d
+                      << " rewiring=" << wiring.rewiring << " sigma=" << wiring.sigma << " matrix=" << matrix.getValue() << " stimulus=" << stimulus.getValue()
+                      << " dt=" << step.getValue() << " integrator=" << scheme.getValue()
+                      << " threads=" << (threads_per_run > 0 ? threads_per_run : std::max(1u, std::thread::hardware_concurrency()));
+            double tol = tolerance.getValue();
+            autotune(autotune_time.getValue(), autotune_cache.getValue(), signature.str(), {tol, tol, tol});
+        }
+        else if (ordering.getValue() != "none") network->reorder(ordering.getValue());
+        if (stdp.getValue()) network->set_plasticity(plasticity);
+        if (compression.getValue() != "none") network->compress(compression.getValue());
+        network->set_threads(threads_per_run, stealing);				// the threads pinned first write the memory they compute
+        if (not network->pin_threads(Memory::parse_cores(pin.getValue()))) throw std::runtime_error("Cannot pin the threads to the cores " + pin.getValue() + ".");
+        network->place();
+        phases = counters.getValue();
+        network->measure_phases(phases);								// in the thread running the steps
+        raster.assign(2*number + 1, ' ');
+        for (size_t i(0); i < number; ++i) raster[2*i+1] = '0';
+        raster.back() = '\n';
+        if (branches == 1) open_outputs("");
+        if (n_trials.getValue() > 1) {
+            trials = new Trials(*network, n_trials.getValue());
+            for (int k(0); k<n_trials.getValue() and outstr_print; ++k) {		// one raster per trial
+                trial_files.emplace_back(ofile.getValue() + "." + std::to_string(k));
+                if (not trial_files.back().is_open()) throw std::runtime_error("Cannot open the output file of trial " + std::to_string(k) + ".");
+            }
+        }
 
      } catch (std::runtime_error &e) {
        std::cout<<e.what()<<std::endl;
@@ -63,34 +307,261 @@ Simulation::Simulation(int argc, char **argv)
      } ;
 }
 
+void Simulation::autotune(const double& budget, const std::string& cache, const std::string& signature, const Tolerances& tolerances)
+{
+	Configuration chosen;
+	if (cache.length() and Autotuner::lookup(cache, signature, chosen)) {
+		chosen.apply(*network);
+		std::cout << "Autotune: " << chosen.to_string() << ", read from " << cache << "." << std::endl;
+	}
+	else {
+		Autotuner tuner(budget, tolerances, threads_per_run);
+		chosen = tuner.tune(*network);
+		const std::vector<Autotuner::Trial>& trials = tuner.get_trials();
+		double fastest = trials.front().seconds_per_step;
+		for (const auto& trial : trials) {
+			if (trial.equivalent) fastest = std::min(fastest, trial.seconds_per_step);
+		}
+		std::cout << "Autotune: " << chosen.to_string() << ", " << 1000*fastest << " ms a step against " << 1000*trials.front().seconds_per_step
+				  << " for " << trials.front().configuration.to_string() << " (" << trials.size() << " candidates)." << std::endl;
+		if (cache.length() and not Autotuner::store(cache, signature, chosen)) std::cout << "The autotune cache " << cache << " cannot be written." << std::endl;
+	}
+	threads_per_run = chosen.threads;
+	stealing = chosen.stealing;
+}
+
+void Simulation::open_outputs(const std::string& suffix)
+{
+	auto named = [&suffix](const std::string& name) { return (name.length() ? name + suffix : name); };
+	bool spikes = (network != nullptr);								// the mean field only writes the rates and the telemetry
+	if (outputs.raster.length() and outputs.shards == 0 and spikes) outfile.open(named(outputs.raster), std::ios_base::out);
+	if (outputs.sample.length() and outputs.shards == 0 and spikes) samplefile.open(named(outputs.sample), std::ios_base::out);
+	if (outputs.parameters.length() and spikes) paramfile.open(named(outputs.parameters), std::ios_base::out);
+	if (outputs.rates.length()) ratefile.open(named(outputs.rates), std::ios_base::out);
+	if (outputs.telemetry.length()) telemetryfile.open(named(outputs.telemetry), std::ios_base::out);
+	if (outputs.weights.length()) weightfile.open(named(outputs.weights), std::ios_base::out);
+	if (ratefile.is_open()) outstr_rates = &ratefile;
+	if (telemetryfile.is_open()) outstr_telemetry = &telemetryfile;
+	if (weightfile.is_open()) outstr_weights = &weightfile;
+	if (paramfile.is_open()) outstr_param = &paramfile;
+	if (samplefile.is_open()) outstr_sample = &samplefile;
+	if (outfile.is_open()) outstr_print = &outfile;
+	if (not spikes) return;
+
+	if (outputs.shards > 0) shards = new ShardedOutput(*network, outputs.shards, named(outputs.raster), named(outputs.sample));
+	if (outputs.archive.length()) {
+		archive = new SpikeArchive(SpikeArchive::create(named(outputs.archive), network->get_size(), outputs.archive_block, outputs.dt, outputs.postings));
+		std::vector<SpikeArchive::Type> types;								// the neurons of each type have successive ids
+		for (size_t n(0); n<network->get_size(); ++n) {				// the types may round the number of neurons down
+			std::string type = network->get_neurons()[network->internal_id(n)].get_type();
+			if (types.empty() or type != types.back().name) {
+				types.push_back({{}, n, n});
+				type.copy(types.back().name, sizeof(types.back().name) - 1);
+			}
+			types.back().last = n + 1;
+		}
+		archive->set_types(types);
+	}
+	if (outputs.shm.length()) {
+		size_t n_samples = network->get_sample_neurons().size();
+		ring = new SpikeRing(SpikeRing::create(named(outputs.shm), outputs.shm_slots, number, n_samples));
+		samples.assign(3*n_samples, 0.0);
+	}
+}
+
 void Simulation::run()
+{
+	if (server) {
+		server->serve();
+		return;
+	}
+	for (int t(1); t<=burn_steps; ++t) {								// the transient, without any output
+		if (mean_field) mean_field->update();
+		else network->update();
+	}
+	if (branches > 1) {
+		branch();
+		return;
+	}
+	if (burn_steps > 0 and stimuli.size()) network->set_stimulus(std::move(stimuli[0]), network->get_steps());
+	record();
+}
+
+void Simulation::branch()
+{
+	std::vector<unsigned long> seeds;
+	for (int k(0); k<branches; ++k) seeds.push_back((unsigned long)_RNG->uniform_int(1, 2147483647));
+	network->set_threads(1);											// the threads of the pool would not exist in the children
+	std::cout.flush();
+	std::vector<pid_t> children;
+	for (int k(0); k<branches; ++k) {
+		pid_t child = fork();
+		if (child < 0) throw OUTPUT_ERROR("Cannot start the branch " + std::to_string(k) + ".");
+		if (child == 0) {												// the network is shared with the parent until it is written: only the states are copied
+			int status(EXIT_SUCCESS);
+			try {
+				network->set_seed(seeds[k]);
+				if (stimuli.size()) {
+					std::unique_ptr<Stimulus>& scheduled = stimuli[stimuli.size() == 1 ? 0 : k];
+					scheduled->rewind();								// its own spike train files: the offsets of those of the parent are shared
+					network->set_stimulus(std::move(scheduled), network->get_steps());
+				}
+				network->set_threads(threads_per_run, stealing);
+				network->measure_phases(phases);						// the counters of the parent do not count this process
+				open_outputs(".branch" + std::to_string(k));
+				record();
+			} catch (std::runtime_error& e) {
+				std::cout << "branch " << k << ": " << e.what() << std::endl;
+				status = EXIT_FAILURE;
+			}
+			std::cout.flush();
+			_exit(status);
+		}
+		children.push_back(child);
+		std::cout << "branch " << k << ": seed " << seeds[k] << std::endl;
+	}
+	int failed(0);
+	for (const auto& child : children) {
+		int status(0);
+		if (waitpid(child, &status, 0) != child or not WIFEXITED(status) or WEXITSTATUS(status) != EXIT_SUCCESS) ++failed;
+	}
+	if (failed) throw OUTPUT_ERROR(std::to_string(failed) + " of the " + std::to_string(branches) + " branches failed.");
+}
+
+void Simulation::record()
 {
 	// this will be called once, at the beginning of the simulation
-	std::ostream *outstr_param=nullptr;
-	std::ostream *outstr_sample=nullptr;
-	std::ostream *outstr_print=nullptr;
-    if (paramfile.is_open()) outstr_param = &paramfile;
-    if (samplefile.is_open()) outstr_sample = &samplefile;
-    if (outfile.is_open()) outstr_print = &outfile;
-    network->header_sample(outstr_sample);								// print a header in sample file
-    network->print_parameters(outstr_param);							// print parameters of every neuron
+    if (outstr_rates) rates->header(outstr_rates);
+    if (outstr_telemetry and mean_field) *outstr_telemetry << "Step\tWall(ms)" << std::endl;
+    if (outstr_sample) network->header_sample(outstr_sample);			// print a header in sample file
+    if (outstr_param) network->print_parameters(outstr_param);			// print parameters of every neuron
+    if (outstr_telemetry and network) {
+        network->print_placement(outstr_telemetry);					// memory node of the data of each thread
+        if (phases and not network->get_counters()->available())
+            *outstr_telemetry << "# hardware counters not available (" << network->get_counters()->why() << "): wall time only" << '\n';
+        *outstr_telemetry << "Step\tWall(ms)\tIO wait(ms)" << (hashes ? "\tSpike hash\tState hash" : "");
+        for (size_t p(0); p<network->get_phase_counts().size(); ++p) {	// the phases, measured with --counters
+            *outstr_telemetry << '\t' << Network::Phases[p] << "(ms)";
+            if (network->get_counters()->available()) {
+                for (const auto& name : Counters::Names) *outstr_telemetry << '\t' << Network::Phases[p] << ' ' << name;
+            }
+        }
+        *outstr_telemetry << std::endl;
+        phase_totals.assign(network->get_phase_counts().size(), Counts());
+    }
 	// for each step of the simulation, first the network is updated by updating each neurons of the network
 	// then the results are printed in the output files
-	for (int t(1); t<=endtime; ++t) {
-		std::vector<size_t> firing_n = network->update();
-		*outstr_print << t;
-		for (size_t i(0); i < number; ++i) *outstr_print << " " << std::count(firing_n.begin(), firing_n.end(), i);
-		*outstr_print << std::endl;
-		network->print_sample(t, outstr_sample);
-	}
+	for (int t(1); t<=endtime; ++t) step(t);
+	if (outstr_weights and network) network->print_links(outstr_weights);	// the intensities reached, with plasticity
+	if (outstr_rates) rates->flush(outstr_rates);						// the last window, if it is not complete
 
 	// the output files are closed
+	delete ring;														// marks the stream as closed for the consumers
+	ring = nullptr;
+	if (archive) archive->close();
+	if (shards) shards->close();
 	if (outfile.is_open()) outfile.close();
 	if (samplefile.is_open()) samplefile.close();
 	if (paramfile.is_open()) paramfile.close();
+	if (ratefile.is_open()) ratefile.close();
+	for (auto& file : trial_files) file.close();
+	if (outstr_telemetry and network) {
+		std::vector<WorkPool::Statistics> statistics = network->thread_statistics();
+		for (size_t w(0); w<statistics.size(); ++w) {
+			*outstr_telemetry << "# thread " << w << "\tbusy(ms) " << 1e3*statistics[w].busy << "\tidle(ms) " << 1e3*statistics[w].idle
+							  << "\ttasks " << statistics[w].tasks << "\tsteals " << statistics[w].steals << '\n';
+		}
+		for (size_t p(0); p<phase_totals.size(); ++p) {
+			const Counts& total = phase_totals[p];
+			*outstr_telemetry << "# phase " << Network::Phases[p] << "\ttime(ms) " << 1e3*total.seconds;
+			if (network->get_counters()->available()) {
+				*outstr_telemetry << "\tcycles " << total.cycles << "\tinstructions " << total.instructions << "\tllc_misses " << total.cache_misses
+								  << "\tbranch_misses " << total.branch_misses << "\tIPC " << (total.cycles ? (double)total.instructions/total.cycles : 0.0);
+			}
+			*outstr_telemetry << '\n';
+		}
+		*outstr_telemetry << "# memory\testimated peak ";								// for the calibration of the preflight
+		footprint.print(outstr_telemetry);
+		*outstr_telemetry << "\tmeasured peak " << (Memory::peak_resident() >> 20) << " MB" << '\n';
+	}
+	if (telemetryfile.is_open()) telemetryfile.close();
+	if (weightfile.is_open()) weightfile.close();
+	if (validation) validation->report(&std::cout);
+	if (network and print_footprint) {
+		std::cout << "Memory: estimated peak ";
+		footprint.print(&std::cout);
+		std::cout << ", measured peak " << (Memory::peak_resident() >> 20) << " MB" << std::endl;
+	}
+}
+
+void Simulation::step(const int& t)
+{
+	auto begin = std::chrono::steady_clock::now();
+	if (trials) {
+		const std::vector<std::vector<size_t>>& spikes = trials->update();
+		for (size_t k(0); k<trial_files.size(); ++k) write_raster(t, spikes[k], &trial_files[k]);
+	}
+	else if (mean_field) {
+		const std::vector<double>& firing_n = mean_field->update();
+		for (size_t k(0); k<firing_n.size(); ++k) rates->add(k, firing_n[k]);
+	}
+	else step_network(t);
+	if (rates) rates->step(t, outstr_rates);
+	if (outstr_telemetry) {
+		double wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+		*outstr_telemetry << t << '\t' << wall;
+		if (network) *outstr_telemetry << '\t' << 1e3*network->get_io_wait();
+		if (hashes and not trials) *outstr_telemetry << std::hex << '\t' << Validation::spike_hash(*firing) << '\t' << Validation::state_hash(*network) << std::dec;
+		for (size_t p(0); p<phase_totals.size(); ++p) {
+			const Counts& counts = network->get_phase_counts()[p];
+			phase_totals[p] += counts;
+			*outstr_telemetry << '\t' << 1e3*counts.seconds;
+			if (network->get_counters()->available()) {
+				*outstr_telemetry << '\t' << counts.cycles << '\t' << counts.instructions << '\t' << counts.cache_misses << '\t' << counts.branch_misses;
+			}
+		}
+		*outstr_telemetry << '\n';
+	}
+}
+
+void Simulation::write_raster(const int& t, const std::vector<size_t>& firing_n, std::ostream *outstr)
+{
+	for (const auto& n : firing_n) raster[2*n+1] = '1';					// the line is written at once, then cleared for the next step
+	*outstr << t;
+	outstr->write(raster.data(), raster.size());
+	for (const auto& n : firing_n) raster[2*n+1] = '0';
+}
+
+void Simulation::step_network(const int& t)
+{
+	const std::vector<size_t>& firing_n = (validation ? validation->update() : network->update());
+	firing = &firing_n;
+	if (rates) rates->add(firing_n);
+	if (outstr_print) write_raster(t, firing_n, outstr_print);
+	if (shards) shards->write(t, firing_n);
+	if (archive) archive->write(t, firing_n);
+	if (outstr_sample) network->print_sample(t, outstr_sample);
+	if (ring) {
+		const std::vector<size_t>& sample_neurons = network->get_sample_neurons();
+		for (size_t k(0); k<sample_neurons.size(); ++k) {
+			samples[3*k]   = network->get_potential(sample_neurons[k]);
+			samples[3*k+1] = network->get_recovery(sample_neurons[k]);
+			samples[3*k+2] = network->get_current(sample_neurons[k]);
+		}
+		ring->publish(t, firing_n, samples);
+	}
 }
 
 Simulation::~Simulation()
 {
+	delete server;
+	delete mean_field;
+	delete rates;
+	delete archive;
+	delete shards;
+	delete ring;
+	delete trials;
+	delete validation;
+	delete reference;
 	delete network;
 }
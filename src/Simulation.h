@@ -1,6 +1,16 @@
 #pragma once
 
 #include "Network.h"
+#include "SpikeRing.h"
+#include "SpikeArchive.h"
+#include "Shards.h"
+#include "Trials.h"
+#include "Validation.h"
+#include "Server.h"
+#include "MeanField.h"
+#include "PopulationRates.h"
+#include "Footprint.h"
+#include "Autotuner.h"
 
 /*!
  * The \b Simulation class is the main class in this program. It constructs the neuron \ref Network according to user-specified parameters, and \ref run the simulation.
@@ -13,7 +23,7 @@
  * A Simulation is made of a \ref Network composed of a given \ref number of \ref Neuron.
  *
  * The parameters of the Simulation are:
- * - \ref endtime : total number of time-steps,
+ * - \ref endtime : total number of time-steps, each lasting \ref Network::get_time_step milliseconds,
  * - \ref number : total number of neurons,
  * - \ref connectivity : average connectivity of a \ref Neuron,
  * - \ref intensity : average intensity of connections,
@@ -51,23 +61,82 @@ public:
 ///@{
 /*!
  * \ref run is the function that performs the simulation. 
- * It creates all the files that will be written on and calls for the printing fuctions of the \ref Network
- * It iterates on the simulation time and for each step, first updates the neuron \ref Network, on the \ref outfile the state of each \ref Neuron,
- * a 1 if it's firing and a 0 if it's not.
- * Finally, this method closes the files when the \ref endtime has been attained 
+ * It first runs the \ref burn_steps steps of the burn-in without writing anything, then \ref record the run,
+ * or forks the \ref branches that each record their own run from the state reached (see \ref branch).
  */
 		void run();
+/*!
+ * Performs the simulation step \p t: updates the \ref network (or the \ref trials) and prints its state in the output files.
+ * Once the network is running, a step does not allocate memory: the raster line is written from the buffer \ref raster.
+ */
+		void step(const int& t);
 ///@}
 
 private:
+/*!
+ * Writes the header of the output files, performs the \ref endtime steps and writes them,
+ * then closes the files when the \ref endtime has been attained
+ */
+		void record();
+/*!
+ * Forks one process per branch once the burn-in is done. The processes share the pages of the \ref network, which
+ * are only copied when written: the links, read-only, are never copied, only the states of the neurons and the buffers.
+ * Branch k reseeds the noise with a seed drawn from the global generator, sets its own stimulus (the k-th of the
+ * --stimulus list, or the only one), and writes its outputs in the files named as the others followed by ".branchk".
+ * Throws an \ref OUTPUT_ERROR if a branch fails.
+ */
+		void branch();
+/*!
+ * Gives the \ref network the configuration found for \p signature in the file \p cache, or else the one chosen by an \ref Autotuner
+ * timing candidates for \p budget seconds, which is then added to the \p cache (none if its name is empty). The choice is printed.
+ */
+		void autotune(const double& budget, const std::string& cache, const std::string& signature, const Tolerances& tolerances);
+/*!
+ * Opens the output files of the run, their names followed by \p suffix, and the spike archive, shards and shared memory ring
+ */
+		void open_outputs(const std::string& suffix);
+/*!
+ * Step \p t of the single \ref network: raster, sample and shared memory outputs
+ */
+		void step_network(const int& t);
+/*!
+ * Writes on \p outstr the raster line of step \p t, where the neurons \p firing_n fire
+ */
+		void write_raster(const int& t, const std::vector<size_t>& firing_n, std::ostream *outstr);
+
 /*!
  * The neuron \ref Network of the simulation
  */
-		Network* network;
+		Network* network = nullptr;
 /*!
- * Total time of the simulation
+ * Total number of time steps of the simulation: the simulated time divided by the time step
  */
   		int endtime;
+/*!
+ * Number of steps of the burn-in, run before the \ref endtime steps without output
+ */
+		int burn_steps = 0;
+/*!
+ * Number of processes continuing the burn-in, 1 to continue it in this process
+ */
+		int branches = 1;
+/*!
+ * Number of threads of the network and partition of its rows (see \ref Network::set_threads), given again to it in each branch
+ */
+		unsigned int threads_per_run = 0;
+		bool stealing = true;
+/*!
+ * Stimuli read from the --stimulus files before the run: one for the run or all the branches, or one per branch.
+ * They are given to the network after the burn-in.
+ */
+		std::vector<std::unique_ptr<Stimulus>> stimuli;
+/*!
+ * Names of the outputs requested (empty if not), and their parameters
+ */
+		struct Outputs {std::string raster, sample, parameters, telemetry, weights, rates, archive, shm;
+						size_t archive_block, shards, shm_slots;
+						bool postings;
+						double dt;} outputs;
 /*!
  * Total number of \ref Neuron in the \ref Network
  */
@@ -96,6 +165,10 @@ private:
  * Average intensity of connection between \ref Neuron in the \ref Network
  */
   		double intensity;
+/*!
+ * Parameters of the structured connectivity models, and number of threads
+ */
+		Wiring_parameters wiring;
 /*!
  * Output file, where the results will be printed
  */
@@ -109,5 +182,91 @@ private:
  * Output file, where the initial parameters of each neurons will be printed
  */
 		std::ofstream paramfile;
+/*!
+ * Output file, where the time spent in each step is printed
+ */
+		std::ofstream telemetryfile;
+/*!
+ * Output file, where the links are printed at the end of the simulation
+ */
+		std::ofstream weightfile;
+/*!
+ * Output file, where the firing rate of each type is printed by windows of steps
+ */
+		std::ofstream ratefile;
+
+/*!
+ * Streams of the opened output files, nullptr when a file is not written
+ */
+		std::ostream *outstr_print = nullptr, *outstr_sample = nullptr, *outstr_param = nullptr, *outstr_telemetry = nullptr, *outstr_weights = nullptr,
+					 *outstr_rates = nullptr;
+/*!
+ * One line of \ref outfile without its step number: " 0" or " 1" for each neuron, then a new line
+ */
+		std::vector<char> raster;
+/*!
+ * Shared memory ring where each step is published for live consumers, nullptr if not requested
+ */
+		SpikeRing* ring = nullptr;
+/*!
+ * Compact file of the spikes, nullptr if not requested
+ */
+		SpikeArchive* archive = nullptr;
+/*!
+ * Raster and sample files written in shards by several threads, nullptr for single files
+ */
+		ShardedOutput* shards = nullptr;
+/*!
+ * Independent trials of the \ref network simulated together, nullptr for a single trial
+ */
+		Trials* trials = nullptr;
+/*!
+ * Memory expected for the run by the preflight, and whether it is printed with the peak measured at the end
+ * (when the memory is limited by --mem-limit or the preflight changed the build); it is always written in the telemetry file
+ */
+		Footprint footprint;
+		bool print_footprint = false;
+/*!
+ * Firing rates of the types counted from the \ref network or the \ref mean_field, nullptr if not requested
+ */
+		PopulationRates* rates = nullptr;
+/*!
+ * Approximation of the network by populations of each type, replacing the \ref network with the mean-field engine
+ */
+		MeanField* mean_field = nullptr;
+/*!
+ * Server running jobs for clients instead of a single simulation, nullptr if not requested
+ */
+		Server* server = nullptr;
+/*!
+ * Comparison of the \ref network with the \ref reference network, nullptr if not requested
+ */
+		Validation* validation = nullptr;
+/*!
+ * Copy of the \ref network using the reference engine, nullptr if no \ref validation
+ */
+		Network* reference = nullptr;
+/*!
+ * True to write the hashes of each step in the telemetry file
+ */
+		bool hashes = false;
+/*!
+ * True to write the time and hardware counters of the phases of each step in the telemetry file (see \ref Network::measure_phases),
+ * whose sums over the run are in \ref phase_totals
+ */
+		bool phases = false;
+		std::vector<Counts> phase_totals;
+/*!
+ * Raster output file of each trial: the name of \ref outfile followed by the number of the trial
+ */
+		std::vector<std::ofstream> trial_files;
+/*!
+ * State of the sample neurons published in the \ref ring at each step
+ */
+		std::vector<double> samples;
+/*!
+ * Neurons firing at the last step of the \ref network, hashed in the telemetry file
+ */
+		const std::vector<size_t>* firing = nullptr;
 
 };
@@ -0,0 +1,244 @@
+#include "SpikeArchive.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+const char Magic[8] = {'N', 'N', 'S', 'P', 'I', 'K', 'E', '2'}, Index_magic[8] = {'N', 'N', 'I', 'N', 'D', 'E', 'X', '2'};
+
+/*!
+ * Header: magic, neurons, steps per block, length of a step
+ */
+struct Header {char magic[8];
+			   uint64_t neurons, block_steps;
+			   double dt;};
+/*!
+ * Footer: number of blocks, offset of the index, last step written, offsets of the postings and of the types (0 if absent),
+ * number of types, magic
+ */
+struct Footer {uint64_t blocks, index, last_step, postings, types, type_count;
+			   char magic[8];};
+
+/*!
+ * Pads \p file with zeros up to a multiple of 8 bytes, so that the tables written next can be read in place
+ */
+void align(std::ofstream& file)
+{
+	static const char zeros[8] = {};
+	file.write(zeros, (8 - (uint64_t)file.tellp() % 8) % 8);
+}
+}
+
+void SpikeArchive::put(std::vector<uint8_t>& bytes, uint64_t value)
+{
+	while (value >= 0x80) {
+		bytes.push_back((uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+	bytes.push_back((uint8_t)value);
+}
+
+uint64_t SpikeArchive::get(const uint8_t *&p)
+{
+	uint64_t value = *p++;
+	if (value < 0x80) return value;
+	value &= 0x7f;
+	for (int shift(7); ; shift += 7) {
+		uint64_t byte = *p++;
+		value |= (byte & 0x7f) << shift;
+		if (byte < 0x80) return value;
+	}
+}
+
+SpikeArchive SpikeArchive::create(const std::string& path, const size_t& neurons, const size_t& block_steps, const double& dt,
+								  const bool& postings)
+{
+	if (block_steps == 0) throw OUTPUT_ERROR("The blocks of a spike archive need at least one step.");
+	SpikeArchive archive;
+	archive.path = path;
+	archive.file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (not archive.file.is_open()) throw OUTPUT_ERROR("Cannot create the spike archive " + path + ".");
+	archive.writing = true;
+	archive.size = neurons;
+	archive.block = block_steps;
+	archive.dt = dt;
+	if (postings) {
+		archive.neuron_steps.resize(neurons);
+		archive.neuron_last.assign(neurons, 0);
+	}
+	Header header;
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.neurons = neurons;
+	header.block_steps = block_steps;
+	header.dt = dt;
+	archive.file.write((const char*)&header, sizeof(header));
+	return archive;
+}
+
+SpikeArchive SpikeArchive::open(const std::string& path)
+{
+	SpikeArchive archive;
+	archive.path = path;
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) throw CFILE_ERROR("Cannot open the spike archive " + path + ": " + std::strerror(errno));
+	struct stat status;
+	if (fstat(fd, &status) != 0 or status.st_size < (off_t)(sizeof(Header) + sizeof(Footer))) {
+		::close(fd);
+		throw CFILE_ERROR(path + " is not a complete spike archive.");
+	}
+	archive.length = status.st_size;
+	void *memory = mmap(nullptr, archive.length, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (memory == MAP_FAILED) throw CFILE_ERROR("Cannot map the spike archive " + path + ": " + std::strerror(errno));
+	archive.memory = static_cast<const uint8_t*>(memory);
+
+	Header header;
+	Footer footer;
+	std::memcpy(&header, archive.memory, sizeof(header));
+	std::memcpy(&footer, archive.memory + archive.length - sizeof(footer), sizeof(footer));
+	if (std::memcmp(header.magic, Magic, sizeof(Magic)) or std::memcmp(footer.magic, Index_magic, sizeof(Index_magic))
+		or footer.index + footer.blocks*sizeof(Block) > archive.length or footer.types + footer.type_count*sizeof(Type) > archive.length
+		or (footer.postings and footer.postings + (header.neurons + 1)*sizeof(uint64_t) > archive.length))
+		throw CFILE_ERROR(path + " is not a complete spike archive.");
+	archive.size = header.neurons;
+	archive.block = header.block_steps;
+	archive.dt = header.dt;
+	archive.last_step = footer.last_step;
+	archive.index = View<Block>(reinterpret_cast<const Block*>(archive.memory + footer.index), footer.blocks);
+	if (footer.postings) archive.postings = View<uint64_t>(reinterpret_cast<const uint64_t*>(archive.memory + footer.postings), archive.size + 1);
+	archive.blocks_end = (footer.postings ? archive.postings[0] : footer.index);
+	const Type *types = reinterpret_cast<const Type*>(archive.memory + footer.types);
+	archive.types_.assign(types, types + (footer.types ? footer.type_count : 0));
+	return archive;
+}
+
+SpikeArchive::SpikeArchive(SpikeArchive&& other)
+{
+	*this = std::move(other);
+}
+
+SpikeArchive& SpikeArchive::operator=(SpikeArchive&& other)
+{
+	std::swap(path, other.path);
+	std::swap(size, other.size);
+	std::swap(block, other.block);
+	std::swap(last_step, other.last_step);
+	std::swap(dt, other.dt);
+	std::swap(types_, other.types_);
+	std::swap(file, other.file);
+	std::swap(writing, other.writing);
+	std::swap(written, other.written);
+	std::swap(buffer, other.buffer);
+	std::swap(neuron_steps, other.neuron_steps);
+	std::swap(neuron_last, other.neuron_last);
+	std::swap(memory, other.memory);
+	std::swap(length, other.length);
+	std::swap(index, other.index);
+	std::swap(blocks_end, other.blocks_end);
+	std::swap(postings, other.postings);
+	return *this;
+}
+
+void SpikeArchive::write(const size_t& step, const std::vector<size_t>& firing)
+{
+	if (step <= last_step or step == 0) throw OUTPUT_ERROR("The steps written in a spike archive must increase from 1.");
+	uint64_t first = (step - 1)/block*block + 1;								// first step of the block of step
+	if (written.empty() or first != written.back().first_step) {
+		flush();
+		written.push_back({first, 0, 0, 0});
+		buffer.clear();
+	}
+	Block& current = written.back();
+	for (; current.first_step + current.steps < step; ++current.steps) buffer.push_back(0);	// silent steps
+	put(buffer, firing.size());
+	for (size_t k(0); k<firing.size(); ++k) {
+		if ((k > 0 and firing[k] <= firing[k-1]) or firing[k] >= size) throw OUTPUT_ERROR("The ids written in a spike archive must increase.");
+		put(buffer, firing[k] - (k > 0 ? firing[k-1] : 0));
+		if (neuron_steps.empty()) continue;
+		put(neuron_steps[firing[k]], step - neuron_last[firing[k]]);
+		neuron_last[firing[k]] = step;
+	}
+	++current.steps;
+	current.spikes += firing.size();
+	last_step = step;
+}
+
+void SpikeArchive::flush()
+{
+	if (written.empty() or written.back().offset != 0) return;					// already written: blocks start after the header
+	written.back().offset = (uint64_t)file.tellp();
+	file.write((const char*)buffer.data(), buffer.size());
+	if (not file) throw OUTPUT_ERROR("Cannot write the spike archive " + path + ".");
+}
+
+void SpikeArchive::close()
+{
+	if (not writing or not file.is_open()) return;
+	writing = false;
+	flush();
+	Footer footer;
+	std::memset(&footer, 0, sizeof(footer));
+	if (not neuron_steps.empty()) {
+		std::vector<uint64_t> offsets(size + 1);
+		offsets[0] = (uint64_t)file.tellp();
+		for (size_t n(0); n<size; ++n) {
+			file.write((const char*)neuron_steps[n].data(), neuron_steps[n].size());
+			offsets[n+1] = offsets[n] + neuron_steps[n].size();
+		}
+		align(file);
+		footer.postings = (uint64_t)file.tellp();
+		file.write((const char*)offsets.data(), offsets.size()*sizeof(uint64_t));
+	}
+	align(file);
+	footer.blocks = written.size();
+	footer.index = (uint64_t)file.tellp();
+	file.write((const char*)written.data(), written.size()*sizeof(Block));
+	if (not types_.empty()) {
+		footer.types = (uint64_t)file.tellp();
+		footer.type_count = types_.size();
+		file.write((const char*)types_.data(), types_.size()*sizeof(Type));
+	}
+	footer.last_step = last_step;
+	std::memcpy(footer.magic, Index_magic, sizeof(Index_magic));
+	file.write((const char*)&footer, sizeof(footer));
+	file.close();
+	if (file.fail()) throw OUTPUT_ERROR("Cannot write the spike archive " + path + ".");
+}
+
+SpikeArchive::~SpikeArchive()
+{
+	try { close(); } catch (SimulError&) {}
+	if (memory) munmap((void*)memory, length);
+}
+
+size_t SpikeArchive::find(const size_t& step) const
+{
+	size_t b = std::upper_bound(index.begin(), index.end(), (uint64_t)step,
+								[](const uint64_t& s, const Block& block) { return s < block.first_step; }) - index.begin();
+	return (b > 0 ? b - 1 : 0);													// the block holding step, or the first one after it
+}
+
+size_t SpikeArchive::count(const size_t& first, const size_t& last) const
+{
+	size_t spikes(0);
+	for (size_t b(find(first)); b<index.size() and index[b].first_step <= last; ++b) {
+		if (index[b].first_step >= first and index[b].first_step + index[b].steps - 1 <= last) spikes += index[b].spikes;
+		else {																	// a block cut by the window
+			SpikeArchive::read(std::max<size_t>(first, index[b].first_step), std::min<size_t>(last, index[b].first_step + index[b].steps - 1),
+							   [&spikes](const size_t&, const size_t&) { ++spikes; });
+		}
+	}
+	return spikes;
+}
+
+size_t SpikeArchive::window_bytes(const size_t& first, const size_t& last) const
+{
+	size_t bytes(0);
+	for (size_t b(find(first)); b<index.size() and index[b].first_step <= last; ++b) {
+		bytes += (b + 1 < index.size() ? index[b+1].offset : blocks_end) - index[b].offset;
+	}
+	return bytes;
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "constants.h"
+#include "View.h"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/*! \class SpikeArchive
+ * Compact file of the spikes of a run, from which any window of steps can be read without decoding the whole file.
+ *
+ * The steps are grouped in blocks of \ref block_steps steps: block b holds the steps b*block_steps +1 to (b+1)*block_steps.
+ * In a block, each step is written as its number of spikes followed by the ids of the firing neurons, in increasing order,
+ * each one as the difference with the previous id; all these numbers are written on 7 bits per byte (varint), so that most
+ * spikes take a single byte. Blocks without any written step are left out.
+ *
+ * The file is made of a header, the blocks, then an index giving for each block its first step, its number of steps,
+ * its offset in the file and its number of spikes, and finally a footer locating the index and the optional sections:
+ * - postings: for each neuron, the steps at which it fires (differences between successive steps, as varints),
+ * - types: the ranges of ids of each type of neuron.
+ *
+ * A reader maps the file in memory: a window of steps is found by binary search in the index and only its blocks are decoded,
+ * the spikes of a few neurons are read from their postings, and the spikes of whole blocks are counted from the index.
+ * Only these bytes are read from the disk.
+ *
+ * An archive is either created, then written step by step, or opened to be read.
+ */
+
+class SpikeArchive {
+public:
+/*!
+ * Entry of the index for one block
+ */
+	struct Block {uint64_t first_step, steps, offset, spikes;};
+/*!
+ * Neurons \p first to \p last -1 are of type \p name
+ */
+	struct Type {char name[8];
+				 uint64_t first, last;};
+
+/*! @name Opening and closing
+ */
+///@{
+/*!
+ * Creates the archive \p path for \p neurons neurons, with blocks of \p block_steps steps of \p dt ms.
+ * With \p postings, the steps of each neuron are also written at the end (they are kept in memory until then).
+ * Throws an \ref OUTPUT_ERROR on failure.
+ */
+	static SpikeArchive create(const std::string& path, const size_t& neurons, const size_t& block_steps, const double& dt = _Time_Step_,
+							   const bool& postings = false);
+/*!
+ * Opens the archive \p path to read it. Throws a \ref CFILE_ERROR if it cannot be read or is not a closed archive.
+ */
+	static SpikeArchive open(const std::string& path);
+/*!
+ * Writes the last block, the index and the sections of an archive being written
+ */
+	void close();
+	~SpikeArchive();
+	SpikeArchive(SpikeArchive&& other);
+	SpikeArchive& operator=(SpikeArchive&& other);
+	SpikeArchive(const SpikeArchive&) = delete;
+	SpikeArchive& operator=(const SpikeArchive&) = delete;
+///@}
+
+/*! @name Writing
+ */
+///@{
+/*!
+ * Records that the neurons \p firing (increasing ids) fire at step \p step. Steps start at 1 and must increase;
+ * steps which are not written have no spike.
+ */
+	void write(const size_t& step, const std::vector<size_t>& firing);
+/*!
+ * Records the ranges of ids of each type of neuron, written when the archive is closed
+ */
+	void set_types(const std::vector<Type>& ranges) { types_ = ranges; }
+///@}
+
+/*! @name Reading
+ */
+///@{
+/*!
+ * Calls \p f (step, neuron) for each spike of the steps \p first to \p last included, in the order of the steps then of the ids
+ */
+	template<class F> void read(const size_t& first, const size_t& last, F f) const;
+/*!
+ * Calls \p f (step) for each spike of neuron \p n during the steps \p first to \p last included, from its postings
+ */
+	template<class F> void read_neuron(const size_t& n, const size_t& first, const size_t& last, F f) const;
+/*!
+ * Number of spikes during the steps \p first to \p last included: only the blocks cut by the window are decoded
+ */
+	size_t count(const size_t& first, const size_t& last) const;
+/*!
+ * Number of bytes decoded by \ref read for the window \p first - \p last, and by \ref read_neuron for neuron \p n
+ */
+	size_t window_bytes(const size_t& first, const size_t& last) const;
+	size_t posting_bytes(const size_t& n) const { return postings.empty() ? 0 : postings[n+1] - postings[n]; }
+	bool has_postings() const { return not postings.empty(); }
+
+	size_t neurons() const { return size; }
+	size_t block_steps() const { return block; }
+	double time_step() const { return dt; }
+/*!
+ * Last step written
+ */
+	size_t steps() const { return last_step; }
+	const View<Block>& blocks() const { return index; }
+	const std::vector<Type>& types() const { return types_; }
+///@}
+
+/*! @name Encoding
+ */
+///@{
+	static void put(std::vector<uint8_t>& bytes, uint64_t value);
+	static uint64_t get(const uint8_t *&p);
+///@}
+
+private:
+	SpikeArchive() {}
+/*!
+ * Writes the block being filled
+ */
+	void flush();
+/*!
+ * First block holding steps from \p step on
+ */
+	size_t find(const size_t& step) const;
+/*!
+ * Bytes of block \p b in the mapped file
+ */
+	const uint8_t* data(const size_t& b) const { return memory + index[b].offset; }
+
+	std::string path;
+	size_t size = 0, block = 0, last_step = 0;
+	double dt = _Time_Step_;
+	std::vector<Type> types_;
+
+/*! @name Writing
+ */
+///@{
+	std::ofstream file;
+	bool writing = false;
+/*!
+ * Index of the blocks written
+ */
+	std::vector<Block> written;
+/*!
+ * Block being written
+ */
+	std::vector<uint8_t> buffer;
+/*!
+ * Postings of each neuron, and the last step written in it
+ */
+	std::vector<std::vector<uint8_t>> neuron_steps;
+	std::vector<uint64_t> neuron_last;
+///@}
+
+/*! @name Reading
+ */
+///@{
+	const uint8_t *memory = nullptr;
+	size_t length = 0;
+	View<Block> index;
+/*!
+ * Offset where the last block ends
+ */
+	uint64_t blocks_end = 0;
+/*!
+ * Offset of the postings of each neuron in the file, followed by their end; empty without postings
+ */
+	View<uint64_t> postings;
+///@}
+};
+
+template<class F> void SpikeArchive::read(const size_t& first, const size_t& last, F f) const
+{
+	for (size_t b(find(first)); b<index.size() and index[b].first_step <= last; ++b) {
+		const uint8_t *p = data(b);
+		for (size_t step(index[b].first_step); step<index[b].first_step + index[b].steps and step <= last; ++step) {
+			uint64_t count = get(p), neuron(0);
+			bool inside = (step >= first);
+			for (uint64_t k(0); k<count; ++k) {
+				neuron += get(p);
+				if (inside) f(step, (size_t)neuron);
+			}
+		}
+	}
+}
+
+template<class F> void SpikeArchive::read_neuron(const size_t& n, const size_t& first, const size_t& last, F f) const
+{
+	if (postings.empty()) throw CFILE_ERROR("The spike archive " + path + " has no postings.");
+	const uint8_t *p = memory + postings[n], *end = memory + postings[n+1];
+	for (uint64_t step(0); p<end; ) {
+		step += get(p);
+		if (step > last) break;
+		if (step >= first) f((size_t)step);
+	}
+}
@@ -0,0 +1,192 @@
+#include "SpikeRing.h"
+#include "constants.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "the ring buffer needs lock-free 64 bit atomics to be shared between processes");
+
+struct SpikeRing::Header {
+	uint64_t magic;
+	uint64_t slots, slot_bytes, neurons, samples;
+	std::atomic<uint64_t> head;										// number of messages published
+	std::atomic<uint32_t> closed;
+};
+
+struct SpikeRing::Slot {
+	std::atomic<uint64_t> sequence;
+	uint64_t step;
+	uint32_t spikes, samples;
+	// followed by the firing neurons (uint32_t) and the sampled state (double), see slot_size
+};
+
+namespace {
+
+const uint64_t ring_magic = 0x474e4952534e4e31;						// "1NNSRING"
+
+size_t align(const size_t& bytes) { return (bytes + 63) & ~size_t(63); }
+
+size_t slot_size(const size_t& neurons, const size_t& samples)
+{
+	return align(sizeof(uint64_t)*3 + sizeof(uint32_t)*(neurons + (neurons % 2)) + sizeof(double)*3*samples + 8);
+}
+
+}
+
+SpikeRing::SpikeRing(const std::string& name, bool producer, void* memory, size_t bytes)
+	: name(name), producer(producer), memory(memory), bytes(bytes), header((Header*)memory), next(0), lost(0)
+{}
+
+SpikeRing::SpikeRing(SpikeRing&& other)
+	: name(other.name), producer(other.producer), memory(other.memory), bytes(other.bytes),
+	  header(other.header), next(other.next), lost(other.lost)
+{
+	other.memory = nullptr;
+}
+
+SpikeRing& SpikeRing::operator=(SpikeRing&& other)
+{
+	std::swap(name, other.name);
+	std::swap(producer, other.producer);
+	std::swap(memory, other.memory);
+	std::swap(bytes, other.bytes);
+	std::swap(header, other.header);
+	std::swap(next, other.next);
+	std::swap(lost, other.lost);
+	return *this;
+}
+
+SpikeRing::~SpikeRing()
+{
+	if (memory == nullptr) return;
+	if (producer) {
+		header->closed.store(1, std::memory_order_release);
+		shm_unlink(name.c_str());									// consumers already attached keep their mapping
+	}
+	munmap(memory, bytes);
+}
+
+SpikeRing SpikeRing::create(const std::string& name, const size_t& slots, const size_t& neurons, const size_t& samples)
+{
+	if (slots == 0) throw OUTPUT_ERROR("The shared memory ring needs at least one slot.");
+	size_t bytes = align(sizeof(Header)) + slots*slot_size(neurons, samples);
+	int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+	if (fd < 0) throw OUTPUT_ERROR("Cannot create the shared memory object " + name + ": " + std::strerror(errno));
+	if (ftruncate(fd, bytes) != 0) {
+		close(fd);
+		shm_unlink(name.c_str());
+		throw OUTPUT_ERROR("Cannot allocate the shared memory object " + name + ": " + std::strerror(errno));
+	}
+	void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (memory == MAP_FAILED) {
+		shm_unlink(name.c_str());
+		throw OUTPUT_ERROR("Cannot map the shared memory object " + name + ": " + std::strerror(errno));
+	}
+
+	Header* header = new (memory) Header;
+	header->slots = slots;
+	header->slot_bytes = slot_size(neurons, samples);
+	header->neurons = neurons;
+	header->samples = samples;
+	header->head.store(0, std::memory_order_relaxed);
+	header->closed.store(0, std::memory_order_relaxed);
+	SpikeRing ring(name, true, memory, bytes);
+	for (size_t k(0); k<slots; ++k) new (ring.slot(k)) Slot{{0}, 0, 0, 0};
+	std::atomic_thread_fence(std::memory_order_release);
+	header->magic = ring_magic;										// written last: consumers only attach to a complete layout
+	return ring;
+}
+
+SpikeRing SpikeRing::attach(const std::string& name)
+{
+	int fd = shm_open(name.c_str(), O_RDONLY, 0);
+	if (fd < 0) throw OUTPUT_ERROR("Cannot open the shared memory object " + name + ": " + std::strerror(errno));
+	struct stat st;
+	if (fstat(fd, &st) != 0 or (size_t)st.st_size < sizeof(Header)) {
+		close(fd);
+		throw OUTPUT_ERROR("The shared memory object " + name + " is not a spike ring.");
+	}
+	void* memory = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (memory == MAP_FAILED) throw OUTPUT_ERROR("Cannot map the shared memory object " + name + ": " + std::strerror(errno));
+
+	SpikeRing ring(name, false, memory, st.st_size);
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (ring.header->magic != ring_magic or align(sizeof(Header)) + ring.header->slots*ring.header->slot_bytes > (size_t)st.st_size)
+		throw OUTPUT_ERROR("The shared memory object " + name + " is not a spike ring.");
+	uint64_t head = ring.header->head.load(std::memory_order_acquire);
+	ring.next = (head > ring.header->slots ? head - ring.header->slots : 0);
+	return ring;
+}
+
+SpikeRing::Slot* SpikeRing::slot(const uint64_t& k) const
+{
+	return (Slot*)((char*)memory + align(sizeof(Header)) + (k % header->slots)*header->slot_bytes);
+}
+
+void SpikeRing::publish(const uint64_t& step, const std::vector<size_t>& spikes, const std::vector<double>& samples)
+{
+	uint64_t k = header->head.load(std::memory_order_relaxed);
+	Slot* s = slot(k);
+	s->sequence.store(2*k + 1, std::memory_order_relaxed);			// odd: the slot is being written
+	std::atomic_thread_fence(std::memory_order_release);
+
+	uint32_t* ids = (uint32_t*)(s + 1);
+	size_t count = std::min(spikes.size(), (size_t)header->neurons);
+	for (size_t i(0); i<count; ++i) ids[i] = (uint32_t)spikes[i];
+	double* state = (double*)(ids + header->neurons + (header->neurons % 2));
+	size_t values = std::min(samples.size(), (size_t)(3*header->samples));
+	std::copy(samples.begin(), samples.begin() + values, state);
+	s->step = step;
+	s->spikes = (uint32_t)count;
+	s->samples = (uint32_t)(values/3);
+
+	s->sequence.store(2*k + 2, std::memory_order_release);			// even: message k is complete
+	header->head.store(k + 1, std::memory_order_release);
+}
+
+bool SpikeRing::peek(Message& message)
+{
+	for (;;) {
+		uint64_t head = header->head.load(std::memory_order_acquire);
+		if (next >= head) return false;
+		if (head - next > header->slots) {							// the oldest unread messages have been overwritten
+			lost += head - header->slots - next;
+			next = head - header->slots;
+		}
+		Slot* s = slot(next);
+		uint64_t sequence = s->sequence.load(std::memory_order_acquire);
+		if (sequence != 2*next + 2) {								// overwritten since head was read
+			++lost;
+			++next;
+			continue;
+		}
+		const uint32_t* ids = (const uint32_t*)(s + 1);
+		message.sequence = next;
+		message.step = s->step;
+		message.spikes = View<uint32_t>(ids, std::min((uint64_t)s->spikes, header->neurons));
+		message.state = View<double>((const double*)(ids + header->neurons + (header->neurons % 2)),
+									 3*std::min((uint64_t)s->samples, header->samples));
+		return true;
+	}
+}
+
+bool SpikeRing::valid(const Message& message)
+{
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (slot(message.sequence)->sequence.load(std::memory_order_relaxed) == 2*message.sequence + 2) return true;
+	++lost;
+	return false;
+}
+
+bool SpikeRing::closed() const
+{
+	return header->closed.load(std::memory_order_acquire) != 0;
+}
+
+size_t SpikeRing::slots() const { return header->slots; }
+size_t SpikeRing::neurons() const { return header->neurons; }
+size_t SpikeRing::samples() const { return header->samples; }
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "View.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*! \class SpikeRing
+ * Ring buffer in POSIX shared memory, through which a running \ref Simulation publishes
+ * each step to consumers living in other processes (live dashboards, online decoders).
+ *
+ * There is a single producer and any number of consumers. The producer never waits: every
+ * step is written in the next of \ref slots slots, overwriting the oldest one. Each consumer
+ * keeps its own position and reads the messages in place, without copying them.
+ *
+ * Every slot carries a sequence number: 2k+1 while message k is being written, 2k+2 once it is
+ * complete. A consumer checks it before and after using a message, which tells it whether the
+ * message was overwritten meanwhile; skipped messages are counted as overruns.
+ *
+ * A message contains the step number, the list of firing neurons and the state (potential,
+ * recovery, current) of the recorded sample neurons.
+ */
+
+class SpikeRing {
+public:
+/*!
+ * One step as seen by a consumer. The views point into the shared memory.
+ */
+	struct Message {uint64_t sequence, step;
+					View<uint32_t> spikes;
+					View<double> state;};
+
+/*! @name Opening and closing
+ */
+///@{
+/*!
+ * Creates the shared memory object \p name for a network of \p neurons neurons with \p samples recorded
+ * neurons, and opens it as the producer. Throws an \ref OUTPUT_ERROR on failure.
+ */
+	static SpikeRing create(const std::string& name, const size_t& slots, const size_t& neurons, const size_t& samples);
+/*!
+ * Opens the existing shared memory object \p name as a consumer, starting at the oldest available message.
+ */
+	static SpikeRing attach(const std::string& name);
+
+	SpikeRing(SpikeRing&& other);
+	SpikeRing& operator=(SpikeRing&& other);
+	SpikeRing(const SpikeRing&) = delete;
+	SpikeRing& operator=(const SpikeRing&) = delete;
+/*!
+ * Unmaps the memory; the producer also marks the stream as closed and removes its name.
+ */
+	~SpikeRing();
+///@}
+
+/*! @name Producing
+ */
+///@{
+/*!
+ * Publishes the step \p step: its firing neurons \p spikes and the state of the neurons \p samples.
+ * It only writes in the mapped memory and never allocates.
+ */
+	void publish(const uint64_t& step, const std::vector<size_t>& spikes, const std::vector<double>& samples);
+///@}
+
+/*! @name Consuming
+ */
+///@{
+/*!
+ * Points \p message to the next unread message. Returns false if there is none yet.
+ * Messages overwritten before being read are skipped and counted in \ref overruns.
+ */
+	bool peek(Message& message);
+/*!
+ * True if \p message was not overwritten since \ref peek: the values read from it are consistent.
+ * Otherwise the values must be discarded, and the message is counted in \ref overruns.
+ */
+	bool valid(const Message& message);
+/*!
+ * Moves to the message following the one returned by \ref peek
+ */
+	void advance() { ++next; }
+/*!
+ * True once the producer closed the stream
+ */
+	bool closed() const;
+/*!
+ * Number of messages lost by this consumer
+ */
+	uint64_t overruns() const { return lost; }
+///@}
+
+/*! @name Layout
+ */
+///@{
+	size_t slots() const;
+	size_t neurons() const;
+	size_t samples() const;
+///@}
+
+private:
+	struct Header;
+	struct Slot;
+
+	SpikeRing(const std::string& name, bool producer, void* memory, size_t bytes);
+	Slot* slot(const uint64_t& k) const;
+
+	std::string name;
+	bool producer;
+	void* memory;
+	size_t bytes;
+	Header* header;
+	uint64_t next;
+	uint64_t lost;
+};
@@ -0,0 +1,107 @@
+#include "Stimulus.h"
+#include <sstream>
+
+void Stimulus::pulse(const size_t& first, const size_t& last, const size_t& start, const size_t& duration, const double& current)
+{
+	ramp(first, last, start, duration, current, current);
+}
+
+void Stimulus::ramp(const size_t& first, const size_t& last, const size_t& start, const size_t& duration, const double& from, const double& to)
+{
+	if (start == 0) throw CFILE_ERROR("The steps of a stimulus start at 1.");
+	if (first >= last or duration == 0) return;
+	ramps.push_back({first, last, start, duration, from, to});
+	active.reserve(ramps.size());										// no allocation once running
+	events.push({start, Kind::Start, ramps.size() - 1});
+	events.push({start + duration, Kind::End, ramps.size() - 1});
+}
+
+void Stimulus::train(const std::string& path, const double& current)
+{
+	trains.push_back({path, std::unique_ptr<std::ifstream>(new std::ifstream(path)), current, 0, 0, 0, 0.0});
+	if (not trains.back().file->is_open()) throw CFILE_ERROR("Cannot open the spike train file " + path + ".");
+	if (advance(trains.size() - 1)) events.push({trains.back().step, Kind::Spikes, trains.size() - 1});
+}
+
+bool Stimulus::advance(const size_t& t)
+{
+	Train& train = trains[t];
+	std::string text;
+	while (std::getline(*train.file, text)) {
+		++train.line;
+		std::istringstream line(text);
+		size_t step, neuron;
+		if (not (line >> step)) {
+			if (text.find_first_not_of(" \t\r") == std::string::npos) continue;
+			throw CFILE_ERROR("Invalid line " + std::to_string(train.line) + " in " + train.path + ".");
+		}
+		if (not (line >> neuron)) throw CFILE_ERROR("Invalid line " + std::to_string(train.line) + " in " + train.path + ".");
+		if (step < train.step) throw CFILE_ERROR("The steps are not sorted at line " + std::to_string(train.line) + " in " + train.path + ".");
+		if (neurons and neuron >= neurons) throw CFILE_ERROR("A spike train is given to neuron " + std::to_string(neuron) + ", beyond the network, in " + train.path + ".");
+		if (not (line >> train.next)) train.next = train.current;
+		train.step = step;
+		train.neuron = neuron;
+		return true;
+	}
+	return false;
+}
+
+std::unique_ptr<Stimulus> Stimulus::read(const std::string& path)
+{
+	std::ifstream file(path);
+	if (not file.is_open()) throw CFILE_ERROR("Cannot open the stimulus file " + path + ".");
+	std::unique_ptr<Stimulus> stimulus(new Stimulus);
+	std::string text;
+	for (size_t number(1); std::getline(file, text); ++number) {
+		std::istringstream line(text);
+		std::string kind, neurons;
+		if (not (line >> kind) or kind[0] == '#') continue;
+		std::string error = "Invalid line " + std::to_string(number) + " in " + path + ".";
+		if (kind == "train") {
+			std::string train;
+			double current;
+			if (not (line >> train >> current)) throw CFILE_ERROR(error);
+			stimulus->train(train, current);
+			continue;
+		}
+		size_t first, last, start, duration;
+		char dash;
+		double from, to;
+		if (not (line >> neurons >> start >> duration >> from)) throw CFILE_ERROR(error);
+		std::istringstream range(neurons);
+		if (not (range >> first)) throw CFILE_ERROR(error);
+		if (not (range >> dash >> last)) last = first;
+		else if (dash != '-' or last < first) throw CFILE_ERROR(error);
+		if (kind == "pulse") stimulus->pulse(first, last + 1, start, duration, from);
+		else if (kind == "ramp" and line >> to) stimulus->ramp(first, last + 1, start, duration, from, to);
+		else throw CFILE_ERROR(error);
+	}
+	return stimulus;
+}
+
+void Stimulus::check(const size_t& size)
+{
+	neurons = size;
+	for (const auto& ramp : ramps) {
+		if (ramp.last > size) throw CFILE_ERROR("A stimulus is given to neuron " + std::to_string(ramp.last - 1) + ", beyond the network.");
+	}
+	for (const auto& train : trains) {
+		if (train.step != 0 and train.neuron >= size) throw CFILE_ERROR("A spike train is given to neuron " + std::to_string(train.neuron) + ", beyond the network.");
+	}
+}
+
+void Stimulus::rewind()
+{
+	events = decltype(events)();
+	active.clear();
+	last_step = 0;
+	for (size_t r(0); r<ramps.size(); ++r) {
+		events.push({ramps[r].start, Kind::Start, r});
+		events.push({ramps[r].start + ramps[r].duration, Kind::End, r});
+	}
+	for (size_t t(0); t<trains.size(); ++t) {
+		trains[t].file.reset(new std::ifstream(trains[t].path));
+		trains[t].line = trains[t].step = 0;
+		if (advance(t)) events.push({trains[t].step, Kind::Spikes, t});
+	}
+}
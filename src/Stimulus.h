@@ -0,0 +1,137 @@
+#pragma once
+
+#include "constants.h"
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+/*! \class Stimulus
+ * External currents injected into some neurons at some steps, on top of the noise.
+ *
+ * A stimulus is made of:
+ * - pulses: a constant current given to the neurons first to last -1 during duration steps from step start,
+ * - ramps: the same, with a current going linearly from one value to another,
+ * - spike trains replayed from a file: each line "step neuron [current]" gives one step of current to one neuron.
+ *   The lines are sorted by step; the file is read along the simulation, a line at a time, never as a whole.
+ *
+ * The schedule is compiled into a queue of events sorted by step: the start and end of each pulse or ramp,
+ * and the next line of each spike train. A step only handles its own events and the pulses and ramps in progress,
+ * so that its cost does not depend on the stimuli that are over or not started yet.
+ *
+ * Steps are numbered from 1, as the lines of the raster: step 1 is the first \ref Network::update.
+ */
+
+class Stimulus {
+public:
+/*! @name Building the schedule
+ */
+///@{
+	void pulse(const size_t& first, const size_t& last, const size_t& start, const size_t& duration, const double& current);
+	void ramp(const size_t& first, const size_t& last, const size_t& start, const size_t& duration, const double& from, const double& to);
+/*!
+ * Replays the spike trains of the file \p path, each spike giving \p current to its neuron unless the line gives its own current.
+ * Throws a \ref CFILE_ERROR if the file cannot be opened.
+ */
+	void train(const std::string& path, const double& current);
+/*!
+ * Reads a schedule file, with one stimulus per line:
+ * "pulse <first>-<last> <start> <duration> <current>", "ramp <first>-<last> <start> <duration> <from> <to>" or "train <file> <current>",
+ * the neurons first to last included. Empty lines and lines starting with # are skipped. Throws a \ref CFILE_ERROR on errors.
+ */
+	static std::unique_ptr<Stimulus> read(const std::string& path);
+///@}
+
+/*!
+ * Throws a \ref CFILE_ERROR if a stimulus is given to a neuron beyond the \p size neurons of the network.
+ * The lines of the spike trains are checked as they are read.
+ */
+	void check(const size_t& size);
+/*!
+ * Goes back to step 1: the spike trains are read again from their beginning
+ */
+	void rewind();
+/*!
+ * Calls \p add (neuron, current) for each current injected at step \p step. The steps must be given in increasing order.
+ */
+	template<class F> void inject(const size_t& step, F add);
+/*!
+ * Number of pulses and ramps in progress
+ */
+	size_t active_stimuli() const { return active.size(); }
+
+private:
+/*!
+ * A pulse (from = to) or a ramp on the neurons [first, last), during the steps [start, start + duration)
+ */
+	struct Ramp {size_t first, last, start, duration;
+				 double from, to;};
+/*!
+ * A spike train file, with its next line
+ */
+	struct Train {std::string path;
+				  std::unique_ptr<std::ifstream> file;
+				  double current;
+				  size_t line, step, neuron;
+				  double next;};
+/*!
+ * Kind of \ref Event
+ */
+	enum class Kind {Start, End, Spikes};
+/*!
+ * At step \p step: the start or end of ramp \p index, or the next spikes of train \p index
+ */
+	struct Event {size_t step;
+				  Kind kind;
+				  size_t index;
+				  bool operator>(const Event& other) const { return step > other.step or (step == other.step and kind > other.kind); }};
+
+/*!
+ * Reads the next line of train \p t, returns false at the end of the file
+ */
+	bool advance(const size_t& t);
+
+	std::vector<Ramp> ramps;
+	std::vector<Train> trains;
+	std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+/*!
+ * Ramps in progress
+ */
+	std::vector<size_t> active;
+	size_t last_step = 0;
+/*!
+ * Number of neurons of the network, 0 until \ref check
+ */
+	size_t neurons = 0;
+};
+
+template<class F> void Stimulus::inject(const size_t& step, F add)
+{
+	if (step <= last_step) throw std::runtime_error("The steps of a stimulus must be increasing.");
+	last_step = step;
+	while (not events.empty() and events.top().step <= step) {
+		Event event = events.top();
+		events.pop();
+		if (event.kind == Kind::Start) active.push_back(event.index);
+		else if (event.kind == Kind::End) {
+			active.erase(std::find(active.begin(), active.end(), event.index));
+		}
+		else {
+			Train& train = trains[event.index];
+			bool more(true);
+			while (more and train.step <= step) {						// spikes of earlier steps are dropped
+				if (train.step == step) add(train.neuron, train.next);
+				more = advance(event.index);
+			}
+			if (more) events.push({train.step, Kind::Spikes, event.index});
+		}
+	}
+	for (const auto& r : active) {
+		const Ramp& ramp = ramps[r];
+		double current = ramp.from;
+		if (ramp.duration > 1) current += (ramp.to - ramp.from)*(double)(step - ramp.start)/(ramp.duration - 1);
+		for (size_t n(ramp.first); n<ramp.last; ++n) add(n, current);
+	}
+}
@@ -0,0 +1,205 @@
+#include "StreamedTopology.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+void write_all(const int& fd, const void *data, size_t bytes, const std::string& path)
+{
+	const char *p = static_cast<const char*>(data);
+	while (bytes > 0) {
+		ssize_t written = ::write(fd, p, bytes);
+		if (written < 0 and errno == EINTR) continue;
+		if (written <= 0) throw OUTPUT_ERROR("Cannot write the links in " + path + ": " + std::strerror(errno));
+		p += written;
+		bytes -= written;
+	}
+}
+
+void read_all(const int& fd, void *data, size_t bytes, off_t offset, const std::string& path)
+{
+	char *p = static_cast<char*>(data);
+	while (bytes > 0) {
+		ssize_t got = ::pread(fd, p, bytes, offset);
+		if (got < 0 and errno == EINTR) continue;
+		if (got <= 0) throw OUTPUT_ERROR("Cannot read the links from " + path + ": " + std::strerror(errno));
+		p += got;
+		offset += got;
+		bytes -= got;
+	}
+}
+
+const size_t Link_bytes = sizeof(uint32_t) + sizeof(double);
+
+}
+
+StreamedTopology::StreamedTopology(const Topology& topology, const std::string& path, const size_t& budget)
+: StreamedTopology(topology.size(), [&topology](const Row& row) {
+	for (size_t n(0); n<topology.size(); ++n) row(n, topology.inputs(n), topology.intensities(n));
+  }, path, budget)
+{}
+
+// In the file, each block holds the sending neurons of all its links, then their intensities:
+// block b starts at byte start[first_row[b]]*Link_bytes. The block being written is gathered in the first buffer.
+StreamedTopology::StreamedTopology(const size_t& neurons, const std::function<void(const Row&)>& generate, const std::string& path,
+								   const size_t& budget)
+: path(path), start(1, 0), first_row(1, 0)
+{
+	fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+	if (fd < 0) throw OUTPUT_ERROR("Cannot create " + path + ": " + std::strerror(errno));
+
+	const size_t block_links = budget/2/Link_bytes;
+	Buffer& block = buffers[0];
+	size_t largest(0), widest(0);
+	auto flush = [&]() {
+		write_all(fd, block.pre.data(), block.pre.size()*sizeof(uint32_t), path);
+		write_all(fd, block.weight.data(), block.weight.size()*sizeof(double), path);
+		largest = std::max(largest, block.pre.size());
+		block.pre.clear();
+		block.weight.clear();
+	};
+	start.reserve(neurons + 1);
+	try {
+		generate([&](const size_t& n, const View<uint32_t>& pre, const View<double>& weight) {
+			if (pre.size() > block_links) throw OUTPUT_ERROR("The memory budget is too small to stream the links of neuron " + std::to_string(n) + ".");
+			if (block.pre.size() + pre.size() > block_links) {
+				flush();
+				first_row.push_back(n);
+			}
+			block.pre.insert(block.pre.end(), pre.begin(), pre.end());
+			block.weight.insert(block.weight.end(), weight.begin(), weight.end());
+			start.push_back(start.back() + pre.size());
+			widest = std::max(widest, pre.size());
+		});
+		flush();
+	} catch (...) {
+		::close(fd);
+		::unlink(path.c_str());
+		throw;
+	}
+	first_row.push_back(size());
+
+	std::vector<uint32_t>().swap(block.pre);							// sized again to the largest block below
+	std::vector<double>().swap(block.weight);
+	for (size_t k(0); k<std::min(blocks(), (size_t)2); ++k) {			// the buffers are allocated once
+		buffers[k].pre.reserve(largest);
+		buffers[k].weight.reserve(largest);
+	}
+	row_buffer.pre.reserve(widest);
+	row_buffer.weight.reserve(widest);
+	reader = std::thread(&StreamedTopology::read_requests, this);
+}
+
+StreamedTopology::~StreamedTopology()
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_one();
+	reader.join();
+	::close(fd);
+	::unlink(path.c_str());
+}
+
+void StreamedTopology::read_links(const size_t& b, const size_t& first, const size_t& count, uint32_t *pre, double *weight) const
+{
+	size_t offset = start[first_row[b]]*Link_bytes;
+	size_t links = start[first_row[b+1]] - start[first_row[b]];
+	read_all(fd, pre, count*sizeof(uint32_t), offset + first*sizeof(uint32_t), path);
+	read_all(fd, weight, count*sizeof(double), offset + links*sizeof(uint32_t) + first*sizeof(double), path);
+}
+
+void StreamedTopology::read_block(const size_t& b, Buffer& buffer) const
+{
+	size_t links = start[first_row[b+1]] - start[first_row[b]];
+	buffer.pre.resize(links);
+	buffer.weight.resize(links);
+	read_links(b, 0, links, buffer.pre.data(), buffer.weight.data());
+}
+
+void StreamedTopology::request(const size_t& b)
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		wanted = b;
+	}
+	wake.notify_one();
+}
+
+void StreamedTopology::wait_block()
+{
+	std::unique_lock<std::mutex> guard(lock);
+	done.wait(guard, [this]() { return wanted == Nothing; });
+	if (error) {
+		std::exception_ptr thrown = error;
+		error = nullptr;
+		std::rethrow_exception(thrown);
+	}
+}
+
+void StreamedTopology::read_requests()
+{
+	std::unique_lock<std::mutex> guard(lock);
+	while (true) {
+		wake.wait(guard, [this]() { return stopping or wanted != Nothing; });
+		if (stopping) return;
+		size_t b = wanted;
+		guard.unlock();
+		try {
+			read_block(b, buffers[b%2]);
+		} catch (...) {
+			guard.lock();
+			error = std::current_exception();
+			guard.unlock();
+		}
+		guard.lock();
+		wanted = Nothing;
+		done.notify_one();
+	}
+}
+
+double StreamedTopology::stream(const Row& row)
+{
+	double wait(0.0);
+	if (blocks() > 0) request(0);
+	for (size_t b(0); b<blocks(); ++b) {
+		auto waiting = std::chrono::steady_clock::now();
+		wait_block();													// rethrows the errors of the reader
+		wait += std::chrono::duration<double>(std::chrono::steady_clock::now() - waiting).count();
+		if (b + 1 < blocks()) request(b + 1);
+
+		const Buffer& buffer = buffers[b%2];
+		size_t base = start[first_row[b]];
+		for (size_t n(first_row[b]); n<first_row[b+1]; ++n) {
+			row(n, View<uint32_t>(buffer.pre.data() + start[n] - base, degree(n)),
+				   View<double>(buffer.weight.data() + start[n] - base, degree(n)));
+		}
+	}
+	return wait;
+}
+
+Topology StreamedTopology::load() const
+{
+	Array<uint32_t> pre(synapses());
+	Array<double> weight(synapses());
+	for (size_t b(0); b<blocks(); ++b) {
+		size_t first = start[first_row[b]];
+		read_links(b, 0, start[first_row[b+1]] - first, pre.data() + first, weight.data() + first);
+	}
+	Topology topology;
+	topology.assign(Array<size_t>(start.begin(), start.end()), std::move(pre), std::move(weight));
+	return topology;
+}
+
+size_t StreamedTopology::bytes() const
+{
+	size_t buffered(0);
+	for (const auto& buffer : buffers) buffered += buffer.pre.capacity()*sizeof(uint32_t) + buffer.weight.capacity()*sizeof(double);
+	buffered += row_buffer.pre.capacity()*sizeof(uint32_t) + row_buffer.weight.capacity()*sizeof(double);
+	return (start.size() + first_row.size())*sizeof(size_t) + buffered;
+}
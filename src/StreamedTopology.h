@@ -0,0 +1,138 @@
+#pragma once
+
+#include "Topology.h"
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/*! \class StreamedTopology
+ * Links of a \ref Topology kept in a file instead of memory, for networks whose links do not fit in memory.
+ *
+ * The rows are grouped in blocks of consecutive rows, each block holding at most half of the memory budget.
+ * \ref stream reads the blocks in order into two buffers: while the rows of one block are computed,
+ * the next block is read from the file by the \ref reader thread, which lives as long as the object.
+ * The buffers are allocated once, so that streaming the rows does not allocate memory.
+ *
+ * Only the first link of each row (\ref start) and the position of each block in the file stay in memory.
+ * The rows can be written as they are generated, so that the whole \ref Topology is never in memory.
+ */
+
+class StreamedTopology {
+public:
+/*!
+ * Called for each row: receiving neuron, sending neurons, intensities
+ */
+	typedef std::function<void(const size_t&, const View<uint32_t>&, const View<double>&)> Row;
+
+/*! @name Building
+ */
+///@{
+/*!
+ * Writes the rows of \p topology in the file \p path, in blocks of at most \p budget /2 bytes.
+ * Throws an \ref OUTPUT_ERROR if the file cannot be written or if a row alone exceeds the budget.
+ */
+	StreamedTopology(const Topology& topology, const std::string& path, const size_t& budget);
+/*!
+ * Writes the rows of \p neurons neurons in the file \p path as \p generate gives them: it calls the \ref Row it receives
+ * for each row, in order. Only the block being written is kept in memory. Throws as the constructor above,
+ * and rethrows the errors of \p generate.
+ */
+	StreamedTopology(const size_t& neurons, const std::function<void(const Row&)>& generate, const std::string& path, const size_t& budget);
+/*!
+ * Stops the \ref reader, closes and removes the file
+ */
+	~StreamedTopology();
+	StreamedTopology(const StreamedTopology&) = delete;
+	StreamedTopology& operator=(const StreamedTopology&) = delete;
+/*!
+ * Reads all the rows back into memory
+ */
+	Topology load() const;
+///@}
+
+/*! @name Reading
+ */
+///@{
+	size_t size() const { return start.size() - 1; }
+	size_t synapses() const { return start.back(); }
+	size_t degree(const size_t& n) const { return start[n+1] - start[n]; }
+	size_t blocks() const { return first_row.size() - 1; }
+/*!
+ * Calls \p row for every row, in order, reading the blocks from the file one ahead of the computation.
+ * \return the time spent waiting for the file, in seconds
+ */
+	double stream(const Row& row);
+/*!
+ * Calls \p f (sending neuron, intensity) for each link received by neuron \p n, reading its row from the file
+ * into a buffer reused from one call to the next (not to be called from several threads at once)
+ */
+	template<class F> void for_each(const size_t& n, F f) const;
+/*!
+ * Memory used by the streamed rows: the row index, the two block buffers and the row buffer, in bytes
+ */
+	size_t bytes() const;
+///@}
+
+private:
+	struct Buffer {std::vector<uint32_t> pre;
+				   std::vector<double> weight;};
+/*!
+ * Reads the block \p b into \p buffer
+ */
+	void read_block(const size_t& b, Buffer& buffer) const;
+/*!
+ * Reads \p count links from link \p first of block \p b
+ */
+	void read_links(const size_t& b, const size_t& first, const size_t& count, uint32_t *pre, double *weight) const;
+/*!
+ * Asks the \ref reader to read the block \p b, into the buffer b modulo 2
+ */
+	void request(const size_t& b);
+/*!
+ * Waits until the block requested is read; rethrows the error of the \ref reader, if any
+ */
+	void wait_block();
+/*!
+ * Loop of the \ref reader: reads the blocks requested until the object is destroyed
+ */
+	void read_requests();
+
+	std::string path;
+	int fd;
+	std::vector<size_t> start;
+/*!
+ * First row of each block, followed by the number of rows
+ */
+	std::vector<size_t> first_row;
+	Buffer buffers[2];
+/*!
+ * Row read by \ref for_each
+ */
+	mutable Buffer row_buffer;
+
+/*! @name Reader
+ * Thread reading the blocks of \ref stream. \ref wanted is the block to read, \ref Nothing once it is read.
+ */
+///@{
+	static const size_t Nothing = SIZE_MAX;
+	std::thread reader;
+	std::mutex lock;
+	std::condition_variable wake, done;
+	size_t wanted = Nothing;
+	bool stopping = false;
+	std::exception_ptr error;
+///@}
+};
+
+template<class F>
+void StreamedTopology::for_each(const size_t& n, F f) const
+{
+	size_t b = std::upper_bound(first_row.begin(), first_row.end(), n) - first_row.begin() - 1;
+	row_buffer.pre.resize(degree(n));									// within the capacity reserved for the largest row
+	row_buffer.weight.resize(degree(n));
+	read_links(b, start[n] - start[first_row[b]], degree(n), row_buffer.pre.data(), row_buffer.weight.data());
+	for (size_t k(0); k<degree(n); ++k) f(row_buffer.pre[k], row_buffer.weight[k]);
+}
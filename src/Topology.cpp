@@ -0,0 +1,90 @@
+#include "Topology.h"
+
+Topology::Topology() : start(1, 0)
+{}
+
+void Topology::build(const Link& links, const size_t& size)
+{
+	start.assign(size + 1, 0);
+	pre.clear();
+	weight.clear();
+	pre.reserve(links.size());
+	weight.reserve(links.size());
+
+	// the map is sorted by receiving neuron, then by sending neuron: rows are filled in one pass
+	for (const auto& link : links) {
+		++start[link.first.first + 1];
+		pre.push_back((uint32_t)link.first.second);
+		weight.push_back(link.second);
+	}
+	for (size_t n(0); n<size; ++n) start[n+1] += start[n];
+}
+
+void Topology::assign(Array<size_t>&& start, Array<uint32_t>&& pre, Array<double>&& weight)
+{
+	this->start = std::move(start);
+	this->pre = std::move(pre);
+	this->weight = std::move(weight);
+}
+
+Link Topology::to_links() const
+{
+	Link links;
+	for (size_t n(0); n<size(); ++n) {
+		for (size_t k(start[n]); k<start[n+1]; ++k) links.emplace_hint(links.end(), std::make_pair(n, (size_t)pre[k]), weight[k]);
+	}
+	return links;
+}
+
+Topology Topology::transpose() const
+{
+	Topology t;
+	t.start.assign(size() + 1, 0);
+	for (const auto& m : pre) ++t.start[m + 1];
+	for (size_t n(0); n<size(); ++n) t.start[n+1] += t.start[n];
+	t.pre.resize(pre.size());
+	t.weight.resize(weight.size());
+	std::vector<size_t> fill(t.start.begin(), t.start.end() - 1);
+	for (size_t n(0); n<size(); ++n) {								// rows are read in order: the transposed rows are sorted
+		for (size_t k(start[n]); k<start[n+1]; ++k) {
+			t.pre[fill[pre[k]]] = (uint32_t)n;
+			t.weight[fill[pre[k]]++] = weight[k];
+		}
+	}
+	return t;
+}
+
+Topology Topology::permuted(const std::vector<uint32_t>& order) const
+{
+	std::vector<uint32_t> position(size());
+	for (size_t i(0); i<order.size(); ++i) position[order[i]] = (uint32_t)i;
+
+	Topology t;
+	t.start.assign(size() + 1, 0);
+	for (size_t i(0); i<size(); ++i) t.start[i+1] = t.start[i] + degree(order[i]);
+	t.pre.resize(pre.size());
+	t.weight.resize(weight.size());
+	std::vector<std::pair<uint32_t, double>> row;
+	for (size_t i(0); i<size(); ++i) {
+		row.clear();
+		for (size_t k(start[order[i]]); k<start[order[i]+1]; ++k) row.push_back({position[pre[k]], weight[k]});
+		std::sort(row.begin(), row.end());
+		for (size_t k(0); k<row.size(); ++k) {
+			t.pre[t.start[i] + k] = row[k].first;
+			t.weight[t.start[i] + k] = row[k].second;
+		}
+	}
+	return t;
+}
+
+void Topology::place(const std::vector<size_t>& bounds, WorkPool& pool)
+{
+	Array<uint32_t> placed_pre(pre.size());								// not written yet: no page is allocated
+	Array<double> placed_weight(weight.size());
+	pool.run(bounds.size() - 1, [&](const size_t& c) {
+		std::copy(pre.begin() + start[bounds[c]], pre.begin() + start[bounds[c+1]], placed_pre.begin() + start[bounds[c]]);
+		std::copy(weight.begin() + start[bounds[c]], weight.begin() + start[bounds[c+1]], placed_weight.begin() + start[bounds[c]]);
+	}, false);
+	pre.swap(placed_pre);
+	weight.swap(placed_weight);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "constants.h"
+#include "View.h"
+#include "Memory.h"
+#include "WorkPool.h"
+#include <cstdint>
+
+/*!
+ * Map of directional links: the key is the pair (receiving neuron, sending neuron), the value is the intensity of the link.
+ */
+typedef std::map<std::pair<size_t, size_t>, double> Link;
+
+/*! \class Topology
+ * Compact, read-only layout of the links of a \ref Network, used when running the simulation.
+ *
+ * The incoming links are stored row by row (compressed sparse rows): the inputs of neuron n are the entries
+ * from \ref start [n] to \ref start [n+1] of \ref pre (sending neurons) and \ref weight (intensities).
+ * Within a row, the sending neurons are sorted in increasing order.
+ */
+
+class Topology {
+public:
+/*! @name Building
+ */
+///@{
+	Topology();
+/*!
+ * Rebuilds the rows from the map \p links of a network of \p size neurons.
+ */
+	void build(const Link& links, const size_t& size);
+/*!
+ * Takes over rows that are already in compressed form: \p start has one more element than the number of rows,
+ * and each row of \p pre is sorted.
+ */
+	void assign(Array<size_t>&& start, Array<uint32_t>&& pre, Array<double>&& weight);
+/*!
+ * Adds \p rows rows without links at the end
+ */
+	void add_rows(const size_t& rows) { start.insert(start.end(), rows, start.back()); }
+/*!
+ * Rebuilds the map of links from the rows
+ */
+	Link to_links() const;
+/*!
+ * Topology of the reversed links: row n lists the neurons receiving a link from neuron n
+ */
+	Topology transpose() const;
+/*!
+ * Topology of the same network where the neuron at position i is the neuron \p order [i] of this one.
+ */
+	Topology permuted(const std::vector<uint32_t>& order) const;
+/*!
+ * Moves the links of rows \p bounds [c] to \p bounds [c+1]-1 into memory first written by the thread of \p pool
+ * running task c without stealing, i.e. onto the memory node of that thread.
+ */
+	void place(const std::vector<size_t>& bounds, WorkPool& pool);
+///@}
+
+/*! @name Reading
+ */
+///@{
+/*!
+ * Number of rows, i.e. of receiving neurons
+ */
+	size_t size() const { return start.size() - 1; }
+/*!
+ * Total number of links
+ */
+	size_t synapses() const { return pre.size(); }
+/*!
+ * Number of incoming links of neuron \p n
+ */
+	size_t degree(const size_t& n) const { return start[n+1] - start[n]; }
+/*!
+ * Sending neurons of the links received by neuron \p n
+ */
+	View<uint32_t> inputs(const size_t& n) const { return View<uint32_t>(pre.data() + start[n], degree(n)); }
+/*!
+ * Intensities of the links received by neuron \p n, in the same order as \ref inputs
+ */
+	View<double> intensities(const size_t& n) const { return View<double>(weight.data() + start[n], degree(n)); }
+/*!
+ * Position in the rows of the first link received by neuron \p n: the links are numbered row after row
+ */
+	size_t first_link(const size_t& n) const { return start[n]; }
+/*!
+ * Intensity of the link at position \p k, which can be changed (by \ref Plasticity) without changing the structure
+ */
+	double& intensity(const size_t& k) { return weight[k]; }
+/*!
+ * Memory used by the rows, in bytes
+ */
+	size_t bytes() const { return start.size()*sizeof(size_t) + pre.size()*sizeof(uint32_t) + weight.size()*sizeof(double); }
+///@}
+
+private:
+	Array<size_t> start;
+	Array<uint32_t> pre;
+	Array<double> weight;
+};
@@ -0,0 +1,93 @@
+#include "TopologyDelta.h"
+#include <algorithm>
+
+namespace {
+bool before(const TopologyDelta::Edit& edit, const uint32_t& pre) { return edit.pre < pre; }
+}
+
+void TopologyDelta::set(const size_t& row, const uint32_t& pre, const bool& present, const double& weight,
+						const bool& in_base, const double& base_weight, const uint64_t& sequence)
+{
+	std::vector<Edit>& edited = edits[row];
+	auto edit = std::lower_bound(edited.begin(), edited.end(), pre, before);
+	if (edit == edited.end() or edit->pre != pre) {
+		edit = edited.insert(edit, Edit());
+		++count;
+	}
+	*edit = {pre, present, in_base, weight, (present ? weight : 0.0) - (in_base ? base_weight : 0.0), sequence};
+}
+
+const TopologyDelta::Edit* TopologyDelta::find(const size_t& row, const uint32_t& pre) const
+{
+	if (edits.empty()) return nullptr;
+	auto edit = std::lower_bound(edits[row].begin(), edits[row].end(), pre, before);
+	return (edit == edits[row].end() or edit->pre != pre ? nullptr : &*edit);
+}
+
+long TopologyDelta::degree_change(const size_t& row) const
+{
+	long change(0);
+	for (const auto& edit : edits[row]) change += (long)edit.present - (long)edit.in_base;
+	return change;
+}
+
+Topology TopologyDelta::merge(const Topology& base, const TopologyDelta& delta, const std::vector<char>& removed)
+{
+	auto kept = [&removed](const uint32_t& m) { return removed.empty() or not removed[m]; };
+	static const std::vector<Edit> none;
+	Array<size_t> start(base.size() + 1, 0);
+	Array<uint32_t> pre;
+	Array<double> weight;
+	pre.reserve(base.synapses() + delta.size());
+	weight.reserve(base.synapses() + delta.size());
+	for (size_t n(0); n<base.size(); ++n) {
+		if (kept((uint32_t)n)) {
+			// both the row and its edits are sorted by sending neuron: they are merged in one pass
+			View<uint32_t> inputs = base.inputs(n);
+			View<double> intensities = base.intensities(n);
+			const std::vector<Edit>& edited = (n < delta.edits.size() ? delta.edits[n] : none);
+			size_t k(0);
+			for (const auto& edit : edited) {
+				for (; k<inputs.size() and inputs[k] < edit.pre; ++k) {
+					if (kept(inputs[k])) {
+						pre.push_back(inputs[k]);
+						weight.push_back(intensities[k]);
+					}
+				}
+				if (k<inputs.size() and inputs[k] == edit.pre) ++k;			// replaced by the edit
+				if (edit.present and kept(edit.pre)) {
+					pre.push_back(edit.pre);
+					weight.push_back(edit.weight);
+				}
+			}
+			for (; k<inputs.size(); ++k) {
+				if (kept(inputs[k])) {
+					pre.push_back(inputs[k]);
+					weight.push_back(intensities[k]);
+				}
+			}
+		}
+		start[n+1] = pre.size();
+	}
+	Topology merged;
+	merged.assign(std::move(start), std::move(pre), std::move(weight));
+	return merged;
+}
+
+void TopologyDelta::rebase(const Topology& base, const uint64_t& sequence)
+{
+	count = 0;
+	for (size_t n(0); n<edits.size(); ++n) {
+		std::vector<Edit>& edited = edits[n];
+		edited.erase(std::remove_if(edited.begin(), edited.end(), [&sequence](const Edit& edit) { return edit.sequence <= sequence; }),
+					 edited.end());
+		View<uint32_t> inputs = (n < base.size() ? base.inputs(n) : View<uint32_t>());
+		for (auto& edit : edited) {
+			const uint32_t *found = std::lower_bound(inputs.begin(), inputs.end(), edit.pre);
+			edit.in_base = (found != inputs.end() and *found == edit.pre);
+			double base_weight = (edit.in_base ? base.intensities(n)[found - inputs.begin()] : 0.0);
+			edit.change = (edit.present ? edit.weight : 0.0) - base_weight;
+		}
+		count += edited.size();
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Topology.h"
+#include <vector>
+
+/*! \class TopologyDelta
+ * Changes of the links made while the network runs, kept beside the compact \ref Topology instead of rebuilding it.
+ *
+ * Each row holds the edits of the links received by one neuron, sorted by sending neuron: the link is added, removed
+ * or given another intensity. Each edit keeps the difference between its intensity and the one of the \ref Topology
+ * (\ref Edit::change, a removed link having 0), so that the step only adds, for the rows with edits,
+ * the sum of these differences times the drive of the senders (\ref correction) to the sum of the compact row.
+ *
+ * Once there are many edits, \ref merge builds a new \ref Topology holding them, which can be done in another thread
+ * as it only reads the base topology and a copy of the edits; \ref rebase then drops the edits it holds.
+ */
+
+class TopologyDelta {
+public:
+/*!
+ * Edit of the link from \p pre: \p present false if it is removed, \p in_base true if the base topology has it.
+ * \p sequence numbers the edits, to know which ones a \ref merge holds.
+ */
+	struct Edit {uint32_t pre;
+				 bool present, in_base;
+				 double weight, change;
+				 uint64_t sequence;};
+
+/*!
+ * Number of rows, i.e. of receiving neurons
+ */
+	void resize(const size_t& rows) { edits.resize(rows); }
+/*!
+ * Records that the link from \p pre to \p row is now \p present with the intensity \p weight, the \p base topology
+ * having it with the intensity \p base_weight if \p in_base
+ */
+	void set(const size_t& row, const uint32_t& pre, const bool& present, const double& weight,
+			 const bool& in_base, const double& base_weight, const uint64_t& sequence);
+/*!
+ * Edit of the link from \p pre to \p row, nullptr if it was not edited
+ */
+	const Edit* find(const size_t& row, const uint32_t& pre) const;
+	const std::vector<Edit>& row(const size_t& i) const { return edits[i]; }
+
+/*!
+ * Difference between the signal received by \p row with the edits and without them, the senders having the \p drive
+ */
+	double correction(const size_t& row, const double *drive) const
+	{
+		double sum(0.0);
+		for (const auto& edit : edits[row]) sum += edit.change*drive[edit.pre];
+		return sum;
+	}
+/*!
+ * Number of links of \p row added by the edits, minus the number removed
+ */
+	long degree_change(const size_t& row) const;
+/*!
+ * Total number of edits
+ */
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+
+/*!
+ * Topology with the links of \p base changed by the edits of \p delta; the rows of the neurons \p removed (if not empty)
+ * and the links they send are left out
+ */
+	static Topology merge(const Topology& base, const TopologyDelta& delta, const std::vector<char>& removed);
+/*!
+ * Drops the edits up to \p sequence, now held by \p base, and recomputes the changes of the others against \p base
+ */
+	void rebase(const Topology& base, const uint64_t& sequence);
+
+private:
+	std::vector<std::vector<Edit>> edits;
+	size_t count = 0;
+};
@@ -0,0 +1,97 @@
+#include "Trials.h"
+
+Trials::Trials(Network& network, const size_t& trials)
+: network(network), topology(network.get_topology()), neurons(network.get_size()), lanes(trials), words((trials + 63)/64),
+  dt(network.get_time_step()), pot(neurons*lanes), rec(neurons*lanes), curr(neurons*lanes, 0.0), drive(neurons*lanes, 0.0),
+  noise(neurons*lanes, 0.0), mask(neurons*words, 0), count(neurons, 0), input(lanes), firing(lanes)
+{
+	if (trials == 0) throw std::runtime_error("At least one trial is needed.");
+	for (size_t i(0); i<neurons; ++i) {
+		const Neuron& neuron = network.get_neurons()[i];
+		Neuron_parameters p = neuron.get_params();
+		a.push_back(p.a);
+		b.push_back(p.b);
+		c.push_back(p.c);
+		d.push_back(p.d);
+		signal.push_back(p.excit ? 0.5 : -1.0);
+		for (size_t k(0); k<lanes; ++k) {
+			pot[i*lanes + k] = neuron.get_potential();
+			rec[i*lanes + k] = neuron.get_recovery();
+		}
+	}
+	for (size_t k(0); k<lanes; ++k) {
+		seeds.push_back((unsigned long)_RNG->uniform_int(1, 2147483647));
+		rngs.push_back(RandomNumbers(seeds.back()));
+		firing[k].reserve(neurons);
+	}
+}
+
+const std::vector<std::vector<size_t>>& Trials::update()
+{
+	// neurons firing at the beginning of the step, in each trial
+	std::fill(mask.begin(), mask.end(), 0);
+	for (size_t i(0); i<neurons; ++i) {
+		count[i] = 0;
+		for (size_t k(0); k<lanes; ++k) {
+			bool fire = pot[i*lanes + k] > _Discharge_Threshold_;
+			drive[i*lanes + k] = (fire ? signal[i] : 0.0);
+			mask[i*words + k/64] |= (uint64_t)fire << (k%64);
+			count[i] += fire;
+		}
+	}
+	for (size_t k(0); k<lanes; ++k) {									// each trial draws its noise in the order of Network::update
+		firing[k].clear();
+		for (size_t n(0); n<neurons; ++n) {
+			size_t i = network.internal_id(n);
+			if (fires(i, k)) {
+				firing[k].push_back(n);
+				continue;
+			}
+			double value = rngs[k].normal(0,1);
+			double current = (signal[i] > 0 ? 5.0*value : 2.0*value);
+			if (dt != _Time_Step_) current /= std::sqrt(dt);
+			noise[i*lanes + k] = current;
+		}
+	}
+
+	for (size_t i(0); i<neurons; ++i) {
+		std::fill(input.begin(), input.end(), 0.0);
+		View<uint32_t> inputs = topology.inputs(i);
+		View<double> intensities = topology.intensities(i);
+		for (size_t l(0); l<inputs.size(); ++l) {
+			const size_t m = inputs[l];
+			if (count[m] == 0) continue;								// silent in every trial
+			const double w = intensities[l];
+			if (8*count[m] > lanes) {									// firing in many trials: all the lanes at once
+				const double *from = &drive[m*lanes];
+				for (size_t k(0); k<lanes; ++k) input[k] += w*from[k];
+			}
+			else {
+				for (size_t word(0); word<words; ++word) {
+					for (uint64_t bits = mask[m*words + word]; bits; bits &= bits - 1) {
+						size_t k = 64*word + __builtin_ctzll(bits);
+						input[k] += w*drive[m*lanes + k];
+					}
+				}
+			}
+		}
+
+		// Euler step of the trials in which the neuron does not fire, as in Neuron::equation
+		double *v = &pot[i*lanes], *u = &rec[i*lanes], *I = &curr[i*lanes];
+		const double *x = &noise[i*lanes], *s = &drive[i*lanes];
+		for (size_t k(0); k<lanes; ++k) {
+			if (s[k] != 0.0) continue;
+			I[k] = x[k] + input[k]/dt;
+			v[k] += 0.5*dt*(0.04*v[k]*v[k]+5*v[k]+140-u[k]+I[k]);
+			v[k] += 0.5*dt*(0.04*v[k]*v[k]+5*v[k]+140-u[k]+I[k]);
+			u[k] += dt*(a[i]*(b[i]*v[k]-u[k]));
+		}
+		if (count[i] == 0) continue;
+		for (size_t k(0); k<lanes; ++k) {
+			if (s[k] == 0.0) continue;
+			v[k] = c[i];
+			u[k] += d[i];
+		}
+	}
+	return firing;
+}
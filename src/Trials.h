@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Network.h"
+
+/*! \class Trials
+ * Simulates several independent trials of the same \ref Network, differing only by their noise.
+ *
+ * Each neuron holds one state per trial (potential, recovery, current), stored next to each other, so that
+ * the links are read once per step for all the trials: the inputs of a neuron are accumulated for all the trials
+ * at once, in a loop over the trials the compiler turns into vector instructions.
+ * The trials in which each neuron fires are kept as a bitmask: a sending neuron silent in every trial is skipped,
+ * and one firing in a few trials only adds its signal to these trials.
+ *
+ * Trial k draws its noise from its own generator (seeded with \ref get_seeds [k]) in the same order as \ref Network::update:
+ * it gives the same spikes as the network run alone with this seed. Neurons are integrated with the Euler scheme.
+ */
+
+class Trials {
+public:
+/*!
+ * Prepares \p trials trials starting from the state of \p network, with seeds drawn from the global generator.
+ * The network must not be changed while the trials run; its links must be kept in memory.
+ */
+	Trials(Network& network, const size_t& trials);
+/*!
+ * Performs one step of every trial.
+ * \return for each trial, the ids of the neurons firing at the beginning of the step, in increasing order
+ */
+	const std::vector<std::vector<size_t>>& update();
+
+	size_t size() const { return neurons; }
+	size_t trials() const { return lanes; }
+	const std::vector<unsigned long>& get_seeds() const { return seeds; }
+/*!
+ * Potential of neuron \p n (id) in trial \p k
+ */
+	double get_potential(const size_t& n, const size_t& k) const { return pot[network.internal_id(n)*lanes + k]; }
+
+private:
+	bool fires(const size_t& i, const size_t& k) const { return (mask[i*words + k/64] >> (k%64)) & 1; }
+
+	Network& network;
+	const Topology& topology;
+	size_t neurons, lanes, words;
+	double dt;
+/*! @name Parameters of the neurons
+ */
+///@{
+	std::vector<double> a, b, c, d;
+/*!
+ * Signal sent when firing: 0.5 for excitatory neurons, -1 for inhibitory ones
+ */
+	std::vector<double> signal;
+///@}
+/*! @name State of the trials
+ * Trial k of neuron i is at position i*\ref lanes + k.
+ */
+///@{
+	std::vector<double> pot, rec, curr;
+/*!
+ * Signal sent in each trial at the current step, 0 when the neuron does not fire
+ */
+	std::vector<double> drive;
+	std::vector<double> noise;
+/*!
+ * Trials in which each neuron fires, \ref words 64-bit words per neuron
+ */
+	std::vector<uint64_t> mask;
+/*!
+ * Number of trials in which each neuron fires
+ */
+	std::vector<uint32_t> count;
+///@}
+	std::vector<double> input;
+	std::vector<unsigned long> seeds;
+	std::vector<RandomNumbers> rngs;
+	std::vector<std::vector<size_t>> firing;
+};
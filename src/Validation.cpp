@@ -0,0 +1,83 @@
+#include "Validation.h"
+
+namespace {
+const uint64_t Offset = 14695981039346656037ull, Prime = 1099511628211ull;
+
+uint64_t mix(uint64_t hash, const void *data, const size_t& bytes)
+{
+	const unsigned char *byte = static_cast<const unsigned char*>(data);
+	for (size_t k(0); k<bytes; ++k) hash = (hash ^ byte[k])*Prime;
+	return hash;
+}
+}
+
+Validation::Validation(Network& optimized, Network& reference, const Tolerances& tolerances)
+: optimized(optimized), reference(reference), tolerances(tolerances)
+{
+	if (optimized.get_size() != reference.get_size()) throw std::runtime_error("The networks to compare differ in size.");
+	reference.set_engine("reference");
+}
+
+const std::vector<size_t>& Validation::update()
+{
+	if (divergent) return optimized.update();
+	RandomNumbers start(*_RNG);
+	const std::vector<size_t>& expected = reference.update();
+	*_RNG = start;														// the optimized network draws the same noise
+	const std::vector<size_t>& firing = optimized.update();
+	compare(expected, firing);
+	if (not divergent) ++steps;
+	return firing;
+}
+
+void Validation::compare(const std::vector<size_t>& expected, const std::vector<size_t>& firing)
+{
+	if (expected != firing) {											// the first neuron firing in a single network
+		size_t k(0);
+		while (k<expected.size() and k<firing.size() and expected[k] == firing[k]) ++k;
+		bool in_reference = (k<expected.size() and (k == firing.size() or expected[k] < firing[k]));
+		size_t n = (in_reference ? expected[k] : firing[k]);
+		return diverge(n, "spike", in_reference, not in_reference);
+	}
+	for (size_t n(0); n<optimized.get_size(); ++n) {
+		if (std::abs(reference.get_potential(n) - optimized.get_potential(n)) > tolerances.potential)
+			return diverge(n, "potential", reference.get_potential(n), optimized.get_potential(n));
+		if (std::abs(reference.get_recovery(n) - optimized.get_recovery(n)) > tolerances.recovery)
+			return diverge(n, "recovery", reference.get_recovery(n), optimized.get_recovery(n));
+		if (std::abs(reference.get_current(n) - optimized.get_current(n)) > tolerances.current)
+			return diverge(n, "current", reference.get_current(n), optimized.get_current(n));
+	}
+}
+
+void Validation::diverge(const size_t& neuron, const std::string& quantity, const double& expected, const double& value)
+{
+	first = {steps + 1, neuron, quantity, expected, value};
+	divergent = true;
+}
+
+void Validation::report(std::ostream *outstr) const
+{
+	if (not divergent) *outstr << "Validation: the engines agree over " << steps << " steps." << std::endl;
+	else *outstr << "Validation: the engines diverge at step " << first.step << ", neuron " << first.neuron << ": " << first.quantity
+				 << " " << first.reference << " (reference) against " << first.optimized << "." << std::endl;
+}
+
+uint64_t Validation::spike_hash(const std::vector<size_t>& firing)
+{
+	uint64_t hash(Offset);
+	for (const auto& n : firing) {
+		uint64_t id = n;
+		hash = mix(hash, &id, sizeof(id));
+	}
+	return hash;
+}
+
+uint64_t Validation::state_hash(const Network& network)
+{
+	uint64_t hash(Offset);
+	for (size_t n(0); n<network.get_size(); ++n) {
+		double state[3] = {network.get_potential(n), network.get_recovery(n), network.get_current(n)};
+		hash = mix(hash, state, sizeof(state));
+	}
+	return hash;
+}
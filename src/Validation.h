@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Network.h"
+
+/*!
+ * Largest differences accepted between the state of a neuron in the two networks of a \ref Validation
+ */
+struct Tolerances {double potential, recovery, current;};
+
+/*! \class Validation
+ * Runs a \ref Network with an optimized \ref Engine next to a copy of it using \ref Engine::Reference, and checks that they agree.
+ *
+ * Both networks must have been built from the same seed. At each step, the reference network draws its noise first, then the
+ * generator is rewound so that the optimized network draws the same numbers; the global generator is left as if the optimized
+ * network had run alone. After each step, the firing neurons must be the same and the potential, recovery and current of
+ * every neuron must agree within the \ref Tolerances. The first difference is recorded as the \ref Divergence, and the
+ * reference network is not updated any more.
+ *
+ * The sums of the inputs are done in the same order by both engines as long as the neurons are not reordered, so that the
+ * states are then equal to the last bit, and so are their \ref state_hash.
+ */
+
+class Validation {
+public:
+/*!
+ * Where the networks first differed: \p quantity is "spike" when a neuron fired in a single network,
+ * "potential", "recovery" or "current" when a state differed by more than its tolerance.
+ */
+	struct Divergence {size_t step, neuron;
+					   std::string quantity;
+					   double reference, optimized;};
+
+	Validation(Network& optimized, Network& reference, const Tolerances& tolerances);
+/*!
+ * Performs one step of both networks (of the optimized one only after a divergence) and compares them.
+ * \return the ids of the neurons of the optimized network firing at the beginning of the step, as \ref Network::update
+ */
+	const std::vector<size_t>& update();
+	bool diverged() const { return divergent; }
+/*!
+ * First difference between the networks, valid if \ref diverged
+ */
+	const Divergence& divergence() const { return first; }
+/*!
+ * Number of steps over which the networks agreed
+ */
+	size_t agreed() const { return steps; }
+/*!
+ * Prints a line describing the result of the comparison
+ */
+	void report(std::ostream *outstr) const;
+
+/*! @name Hashes
+ * FNV-1a hashes of a step, written in the telemetry so that a run can be checked against a replay with another engine.
+ */
+///@{
+/*!
+ * Hash of the ids \p firing of the firing neurons
+ */
+	static uint64_t spike_hash(const std::vector<size_t>& firing);
+/*!
+ * Hash of the exact potential, recovery and current of the neurons of \p network, in the order of their ids
+ */
+	static uint64_t state_hash(const Network& network);
+///@}
+
+private:
+/*!
+ * Records the first difference between the networks at this step, if any
+ */
+	void compare(const std::vector<size_t>& expected, const std::vector<size_t>& firing);
+	void diverge(const size_t& neuron, const std::string& quantity, const double& expected, const double& value);
+
+	Network& optimized;
+	Network& reference;
+	Tolerances tolerances;
+	size_t steps = 0;
+	bool divergent = false;
+	Divergence first;
+};
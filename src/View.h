@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+
+/*! \class View
+ * A read-only view on \ref size contiguous elements owned by another object.
+ * It gives access to a part of a container without copying it, and stays valid
+ * as long as the owner is not modified.
+ */
+
+template<class T>
+class View {
+public:
+	View() : first(nullptr), count(0) {}
+	View(const T* data, size_t size) : first(data), count(size) {}
+
+	const T* begin() const { return first; }
+	const T* end() const { return first + count; }
+	const T* data() const { return first; }
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	const T& operator[](size_t k) const { return first[k]; }
+
+private:
+	const T* first;
+	size_t count;
+};
@@ -0,0 +1,136 @@
+#include "WorkPool.h"
+#include "Memory.h"
+#include <chrono>
+
+namespace {
+
+double since(const std::chrono::steady_clock::time_point& t)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+}
+
+}
+
+WorkPool::WorkPool(unsigned int threads)
+{
+	if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned int w(0); w<threads; ++w) {
+		workers.emplace_back(new Worker());
+		workers.back()->stats = {0.0, 0.0, 0, 0};
+		workers.back()->front = workers.back()->back = 0;
+	}
+	for (unsigned int w(1); w<threads; ++w) this->threads.push_back(std::thread(&WorkPool::loop, this, w));
+}
+
+WorkPool::~WorkPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		stopping = true;
+	}
+	start.notify_all();
+	for (auto& thread : threads) thread.join();
+}
+
+void WorkPool::loop(const unsigned int& w)
+{
+	size_t seen(0);
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> guard(mutex);
+			start.wait(guard, [&]{ return stopping or generation != seen; });
+			if (stopping) return;
+			seen = generation;
+		}
+		work(w);
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			if (--running == 0) finished.notify_one();
+		}
+	}
+}
+
+bool WorkPool::next(const unsigned int& w, size_t& task)
+{
+	{
+		std::lock_guard<std::mutex> guard(workers[w]->lock);
+		if (workers[w]->front < workers[w]->back) {
+			task = --workers[w]->back;
+			return true;
+		}
+	}
+	if (not stealing) return false;
+	for (unsigned int k(1); k<size(); ++k) {							// the victims are visited from the next thread on
+		Worker& victim = *workers[(w + k)%size()];
+		std::lock_guard<std::mutex> guard(victim.lock);
+		if (victim.front == victim.back) continue;
+		task = victim.front++;
+		++workers[w]->stats.steals;
+		return true;
+	}
+	return false;
+}
+
+void WorkPool::work(const unsigned int& w)
+{
+	Worker& worker = *workers[w];
+	size_t task;
+	while (next(w, task)) {
+		auto begin = std::chrono::steady_clock::now();
+		(*current)(task);
+		worker.busy += since(begin);
+		++worker.stats.tasks;
+	}
+}
+
+void WorkPool::run(const size_t& tasks, const std::function<void(const size_t&)>& task, const bool& stealing)
+{
+	auto begin = std::chrono::steady_clock::now();
+	for (unsigned int w(0); w<size(); ++w) {							// contiguous ranges: neighbouring rows stay on the same thread
+		Worker& worker = *workers[w];
+		std::lock_guard<std::mutex> guard(worker.lock);
+		worker.busy = 0.0;
+		worker.front = tasks*w/size();
+		worker.back = tasks*(w+1)/size();
+	}
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		current = &task;
+		this->stealing = stealing;
+		running = size() - 1;
+		++generation;
+	}
+	start.notify_all();
+	work(0);
+	{
+		std::unique_lock<std::mutex> guard(mutex);
+		finished.wait(guard, [&]{ return running == 0; });
+	}
+	double wall = since(begin);
+	for (auto& worker : workers) {
+		worker->stats.busy += worker->busy;
+		worker->stats.idle += wall - worker->busy;
+	}
+}
+
+bool WorkPool::pin(const std::vector<int>& cores)
+{
+	if (cores.empty()) return true;
+	std::atomic<bool> pinned(true);
+	run(size(), [&](const size_t& w) {									// without stealing, task w runs on thread w
+		if (not Memory::pin(cores[w % cores.size()])) pinned = false;
+	}, false);
+	return pinned;
+}
+
+std::vector<WorkPool::Statistics> WorkPool::statistics() const
+{
+	std::vector<Statistics> all;
+	for (const auto& worker : workers) all.push_back(worker->stats);
+	return all;
+}
+
+void WorkPool::reset_statistics()
+{
+	for (auto& worker : workers) worker->stats = {0.0, 0.0, 0, 0};
+}
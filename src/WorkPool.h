@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*! \class WorkPool
+ * Pool of threads running the tasks of a step, with work stealing.
+ *
+ * The tasks 0 to n-1 of a \ref run are dealt in contiguous ranges to the threads, each one keeping its remaining tasks
+ * as a deque (the range [front, back)). A thread takes its next task from the back of its deque; once it is empty,
+ * it steals from the front of the deque of another thread. Threads given heavier tasks therefore do not keep the others idle.
+ *
+ * The calling thread takes part in the work as thread 0. Each thread records the time it spent running tasks (busy)
+ * and waiting for the others to finish (idle).
+ */
+
+class WorkPool {
+public:
+	struct Statistics {double busy, idle;
+					   size_t tasks, steals;};
+
+/*!
+ * Starts \p threads -1 threads, 0 for one per core
+ */
+	explicit WorkPool(unsigned int threads);
+	~WorkPool();
+	WorkPool(const WorkPool&) = delete;
+	WorkPool& operator=(const WorkPool&) = delete;
+
+	unsigned int size() const { return (unsigned int)workers.size(); }
+/*!
+ * Runs \p task (i) for i from 0 to \p tasks -1 and returns once all of them are done.
+ * Without \p stealing, each thread only runs the range of tasks it is dealt (static partition).
+ */
+	void run(const size_t& tasks, const std::function<void(const size_t&)>& task, const bool& stealing = true);
+/*!
+ * Pins thread w (the calling thread being thread 0) to the core \p cores [w modulo their number].
+ * Returns false if a thread could not be pinned.
+ */
+	bool pin(const std::vector<int>& cores);
+/*!
+ * Statistics of each thread since the creation of the pool or the last \ref reset_statistics
+ */
+	std::vector<Statistics> statistics() const;
+	void reset_statistics();
+
+private:
+	struct Worker {std::mutex lock;
+				   size_t front, back;
+				   Statistics stats;
+				   double busy;};
+/*!
+ * Runs the tasks of thread \p w, then steals the tasks of the others
+ */
+	void work(const unsigned int& w);
+	bool next(const unsigned int& w, size_t& task);
+	void loop(const unsigned int& w);
+
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable start, finished;
+	size_t generation = 0;
+	unsigned int running = 0;
+	bool stopping = false;
+	bool stealing = true;
+	const std::function<void(const size_t&)> *current = nullptr;
+};
@@ -44,3 +44,18 @@ _SIMULERR_(OUTPUT_ERROR, 30)
 #define _Connectivity_ 30.
 #define _Intensity_ 20.
 #define _Discharge_Threshold_ 30
+#define _Time_Step_ 1.0
+#define _Adaptive_Margin_ -45.0
+#define _Adaptive_Step_ 0.125
+#define _Rewiring_ 0.1
+#define _Sigma_ 2.0
+#define _Stream_Memory_ 256.
+#define _STDP_Potentiation_ 1.0
+#define _STDP_Depression_ 1.05
+#define _STDP_Tau_ 20.
+#define _STDP_Max_Weight_ 40.
+#define _Tolerance_ 1e-9
+#define _Archive_Block_ 1000
+#define _Compaction_Edits_ 65536
+#define _Mean_Field_Samples_ 1000
+#define _Rate_Window_ 10.
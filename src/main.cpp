@@ -1,7 +1,5 @@
 #include "Simulation.h"
 
-RandomNumbers *_RNG;
-
 /*! \mainpage NeuronNetwork
  *
  * \section intro_sec What is the goal of this program ?
@@ -0,0 +1,118 @@
+#include "neuronnetwork.h"
+#include "Network.h"
+
+struct nn_network {
+	Network network;
+	std::vector<nn_spike> spikes;
+	uint64_t time;
+};
+
+namespace {
+
+thread_local std::string last_error;
+
+int fail(const std::string& message, int code)
+{
+	last_error = message;
+	return code;
+}
+
+}
+
+void nn_default_parameters(nn_parameters *params)
+{
+	params->number = (size_t)_Numbers_;
+	params->types = "";
+	params->delta = _Delta_;
+	params->connectivity = _Connectivity_;
+	params->model = "poisson";
+	params->intensity = _Intensity_;
+	params->dt = _Time_Step_;
+	params->integrator = "euler";
+	params->seed = 0;
+}
+
+nn_network *nn_create(const nn_parameters *params)
+{
+	try {
+		if (params == nullptr or params->number == 0 or params->delta < 0 or params->connectivity < 0 or params->intensity < 0)
+			throw std::runtime_error("Parameters are non valid.");
+		if (params->seed != 0 or _RNG == nullptr) {
+			delete _RNG;
+			_RNG = new RandomNumbers(params->seed);
+		}
+		nn_network *net = new nn_network{Network(params->number, params->types ? params->types : "", params->delta,
+												 params->connectivity, params->model ? params->model : "poisson", params->intensity),
+										 std::vector<nn_spike>(), 0};
+		try {
+			net->network.set_integrator(params->integrator ? params->integrator : "euler", params->dt);
+			net->network.finalize();
+		} catch (...) {
+			delete net;
+			throw;
+		}
+		return net;
+	} catch (std::out_of_range &e) {
+		fail("Unknown integrator.", NN_INVALID_PARAMETER);
+	} catch (std::exception &e) {
+		fail(e.what(), NN_INVALID_PARAMETER);
+	}
+	return nullptr;
+}
+
+void nn_destroy(nn_network *net)
+{
+	delete net;
+}
+
+size_t nn_size(const nn_network *net)
+{
+	return net->network.get_size();
+}
+
+uint64_t nn_time(const nn_network *net)
+{
+	return net->time;
+}
+
+int nn_step(nn_network *net, int steps)
+{
+	if (steps < 0) return fail("The number of steps must be positive.", NN_INVALID_PARAMETER);
+	net->spikes.clear();
+	for (int t(0); t<steps; ++t) {
+		++net->time;
+		for (const auto& n : net->network.update()) net->spikes.push_back({net->time, (uint32_t)n});
+	}
+	return 0;
+}
+
+size_t nn_spike_count(const nn_network *net)
+{
+	return net->spikes.size();
+}
+
+size_t nn_read_spikes(const nn_network *net, nn_spike *buffer, size_t capacity)
+{
+	size_t count = std::min(capacity, net->spikes.size());
+	std::copy(net->spikes.begin(), net->spikes.begin() + count, buffer);
+	return count;
+}
+
+nn_state_view nn_state(const nn_network *net)
+{
+	const std::vector<Neuron>& neurons = net->network.get_neurons();
+	if (neurons.empty()) return {nullptr, nullptr, nullptr, 0, sizeof(Neuron)};
+	return {&neurons[0].get_potential(), &neurons[0].get_recovery(), &neurons[0].get_current(), neurons.size(), sizeof(Neuron)};
+}
+
+int nn_set_potential(nn_network *net, size_t n, double potential)
+{
+	if (n >= net->network.get_size()) return fail("No such neuron.", NN_INVALID_PARAMETER);
+	net->network.set_neuron_potential(n, potential);
+	return 0;
+}
+
+const char *nn_last_error(void)
+{
+	return last_error.c_str();
+}
@@ -0,0 +1,116 @@
+/*!
+ * \file neuronnetwork.h
+ * C interface of the neuronnetwork library, for programs driving a simulation in-process.
+ *
+ * A network is created from a set of \ref nn_parameters, advanced with \ref nn_step, and observed
+ * without any file: the spikes are copied into a buffer owned by the caller with \ref nn_read_spikes,
+ * and the state of the neurons is read in place through the \ref nn_state_view returned by \ref nn_state.
+ *
+ * Functions returning an int return 0 on success and a non-zero error code otherwise;
+ * the corresponding message is available with \ref nn_last_error.
+ *
+ * The library uses one random generator per process: networks created with a non-zero seed reseed it.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Construction parameters of a network, with the same meaning as the command-line options
+ * of the NeuronNetwork program. Strings are copied by \ref nn_create.
+ */
+typedef struct {
+	size_t number;				/*!< total number of neurons (-n) */
+	const char *types;			/*!< proportions of each type of neuron, e.g. "FS:0.2,CH:0.2" (-T) */
+	double delta;				/*!< noise on the neuron parameters (-d) */
+	double connectivity;		/*!< average number of connections (-c) */
+	const char *model;			/*!< dispersion model of the number of connections (-M) */
+	double intensity;			/*!< average intensity of connections (-l) */
+	double dt;					/*!< length of a time step in ms (--dt) */
+	const char *integrator;		/*!< integration scheme (-I) */
+	unsigned long seed;			/*!< seed of the random generator, 0 keeps the current generator */
+} nn_parameters;
+
+/*!
+ * A spike: the neuron \p neuron was firing at step \p step
+ */
+typedef struct {
+	uint64_t step;
+	uint32_t neuron;
+} nn_spike;
+
+/*!
+ * Read-only view on the state of the neurons. The values of neuron k are found at
+ * byte offset k*stride from each pointer. The view stays valid until the network is destroyed.
+ */
+typedef struct {
+	const double *potential;
+	const double *recovery;
+	const double *current;
+	size_t size;
+	size_t stride;
+} nn_state_view;
+
+typedef struct nn_network nn_network;
+
+/*!
+ * Error codes returned by the functions of the library
+ */
+enum {
+	NN_OK = 0,
+	NN_INVALID_PARAMETER = 1
+};
+
+/*!
+ * Fills \p params with the default values of the NeuronNetwork program
+ */
+void nn_default_parameters(nn_parameters *params);
+/*!
+ * Creates a network, returns NULL on error
+ */
+nn_network *nn_create(const nn_parameters *params);
+void nn_destroy(nn_network *net);
+
+/*!
+ * Number of neurons of the network
+ */
+size_t nn_size(const nn_network *net);
+/*!
+ * Number of steps performed since the creation of the network
+ */
+uint64_t nn_time(const nn_network *net);
+/*!
+ * Performs \p steps simulation steps. The spikes of these steps replace the ones of the previous call.
+ */
+int nn_step(nn_network *net, int steps);
+/*!
+ * Number of spikes produced by the last call to \ref nn_step
+ */
+size_t nn_spike_count(const nn_network *net);
+/*!
+ * Copies at most \p capacity spikes of the last call to \ref nn_step into \p buffer, in chronological order.
+ * Returns the number of spikes copied.
+ */
+size_t nn_read_spikes(const nn_network *net, nn_spike *buffer, size_t capacity);
+/*!
+ * View on the potential, recovery and current of all the neurons
+ */
+nn_state_view nn_state(const nn_network *net);
+/*!
+ * Sets the potential of neuron \p n, e.g. to stimulate it from a closed-loop controller
+ */
+int nn_set_potential(nn_network *net, size_t n, double potential);
+
+/*!
+ * Message of the last error of the calling thread
+ */
+const char *nn_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
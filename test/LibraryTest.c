@@ -0,0 +1,33 @@
+/*
+ * Closed-loop use of the C interface, compiled as C to check that neuronnetwork.h is valid C.
+ * The controller advances the network one step at a time and, whenever no neuron fired,
+ * stimulates the first neuron. It returns the number of spikes seen, or -1 on error.
+ */
+#include "neuronnetwork.h"
+
+long closed_loop_controller(int steps)
+{
+	nn_parameters params;
+	nn_default_parameters(&params);
+	params.number = 100;
+	params.connectivity = 10;
+	params.seed = 42;
+
+	nn_network *net = nn_create(&params);
+	if (net == NULL) return -1;
+
+	nn_spike spikes[100];
+	long total = 0;
+	for (int t = 0; t < steps; ++t) {
+		if (nn_step(net, 1) != NN_OK) break;
+		size_t count = nn_read_spikes(net, spikes, 100);
+		for (size_t k = 0; k < count; ++k) {
+			if (spikes[k].step != nn_time(net) || spikes[k].neuron >= nn_size(net)) total = -1;
+		}
+		if (total < 0) break;
+		total += (long)count;
+		if (count == 0 && nn_set_potential(net, 0, 35.0) != NN_OK) total = -1;
+	}
+	nn_destroy(net);
+	return total;
+}
@@ -3,8 +3,25 @@
 #include "Neuron.h"
 #include "Network.h"
 #include "Simulation.h"
+#include "AllocationCounter.h"
+#include "neuronnetwork.h"
+#include "SpikeRing.h"
+#include "Trials.h"
+#include "Validation.h"
+#include "Server.h"
+#include <atomic>
+#include <numeric>
+#include <sstream>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
-RandomNumbers *_RNG = new RandomNumbers(23948710923);
+extern "C" long closed_loop_controller(int steps);
 
 TEST(Random, distributions) {
     double mean = 0;
@@ -130,6 +147,50 @@ TEST(Neuron, firing) {
 	EXPECT_EQ(n1.get_params().c, n1.get_potential());
 }
 
+TEST(Neuron, integrators) {
+	Neuron n1("RS", 0.);
+	n1.set_current(5.0);
+	double pot = n1.get_potential();
+	double rec = n1.get_recovery();
+	pot += 0.5*(0.04*pot*pot+5*pot+140-rec+5.0);
+	pot += 0.5*(0.04*pot*pot+5*pot+140-rec+5.0);
+	rec += n1.get_params().a*(n1.get_params().b*pot-rec);
+	n1.equation();
+	EXPECT_EQ(pot, n1.get_potential());
+	EXPECT_EQ(rec, n1.get_recovery());
+
+	// below threshold, every scheme converges to a fine-step reference
+	Neuron ref("RS", 0.);
+	ref.set_current(3.0);
+	for (int k(0); k<10000; ++k) ref.equation(0.001, Integrator::RK4);
+	for (const auto& method : Neuron::Integrators) {
+		Neuron n("RS", 0.);
+		n.set_current(3.0);
+		for (int k(0); k<40; ++k) n.equation(0.25, method.second);
+		double tolerance = (method.second == Integrator::Euler ? 0.5 : 0.05);
+		EXPECT_NEAR(ref.get_potential(), n.get_potential(), tolerance) << method.first;
+		EXPECT_NEAR(ref.get_recovery(), n.get_recovery(), tolerance) << method.first;
+	}
+
+	// close to the threshold, the adaptive scheme stops at the crossing instead of diverging
+	Neuron n2("RS", 0.);
+	n2.set_potential(25.0);
+	n2.equation(2.0, Integrator::Adaptive);
+	EXPECT_TRUE(n2.firing());
+	EXPECT_LT(n2.get_potential(), 100.0);
+	EXPECT_TRUE(std::isfinite(n2.get_recovery()));
+}
+
+TEST(Network, timestep) {
+	Network net(3, "FS:1", 0., 0, "", 1);
+	EXPECT_EQ(1.0, net.get_time_step());
+	net.set_integrator("rk4", 0.5);
+	EXPECT_EQ(0.5, net.get_time_step());
+	EXPECT_THROW(net.set_integrator("rk4", 0.), std::runtime_error);
+	net.update();
+	for (size_t n(0); n<net.get_size(); ++n) EXPECT_TRUE(std::isfinite(net.get_potential(n)));
+}
+
 TEST(Network, Parsing) {
 	Network net1(100, "", 0., 5, "constant", 1);
 	int count_RS = 0;
@@ -195,7 +256,1214 @@ TEST(Network, update) {
 	EXPECT_GE(max_ex_pot, net.get_potential(0));
 }
 
+TEST(Network, topology) {
+	Network net(4, "", 0., 0, "", 0);
+	net.add_link(0, 3, 2.);
+	net.add_link(0, 1, 1.);
+	net.add_link(2, 0, 3.);
+	const Topology& topo = net.get_topology();
+	EXPECT_EQ(4u, topo.size());
+	EXPECT_EQ(3u, topo.synapses());
+	EXPECT_EQ(2u, topo.degree(0));
+	EXPECT_EQ(0u, topo.degree(1));
+	EXPECT_EQ(1u, topo.inputs(0)[0]);
+	EXPECT_EQ(3u, topo.inputs(0)[1]);
+	EXPECT_EQ(2., topo.intensities(0)[1]);
+	EXPECT_EQ(0u, topo.inputs(2)[0]);
+	net.add_link(1, 2, 1.);
+	EXPECT_EQ(1u, net.get_topology().degree(1));
+}
+
+TEST(Generator, models) {
+	Wiring_parameters lattice;
+	lattice.rewiring = 0.0;
+	Network ring(100, "", 0., 4, "small-world", 1, lattice);
+	const Topology& ring_topo = ring.get_topology();
+	EXPECT_EQ(400u, ring_topo.synapses());
+	std::vector<uint32_t> expected {8, 9, 11, 12};
+	EXPECT_EQ(expected, std::vector<uint32_t>(ring_topo.inputs(10).begin(), ring_topo.inputs(10).end()));
+	expected = {0, 1, 97, 98};
+	EXPECT_EQ(expected, std::vector<uint32_t>(ring_topo.inputs(99).begin(), ring_topo.inputs(99).end()));
+
+	for (const auto& model : Generator::Models) {
+		Network net(2000, "", 0., 10, model, 1);
+		const Topology& topo = net.get_topology();
+		EXPECT_NEAR(10.0, (double)topo.synapses()/2000, 0.5) << model;
+		size_t max_degree = 0;
+		for (size_t n(0); n<topo.size(); ++n) {
+			max_degree = std::max(max_degree, topo.degree(n));
+			for (size_t k(0); k<topo.degree(n); ++k) {
+				EXPECT_NE(n, topo.inputs(n)[k]) << model;
+				if (k > 0) {
+					EXPECT_LT(topo.inputs(n)[k-1], topo.inputs(n)[k]) << model;
+				}
+				EXPECT_LE(topo.intensities(n)[k], 2.0);
+			}
+		}
+		if (model == "scale-free") {
+			EXPECT_GT(max_degree, 50u);										// hubs
+		}
+		else if (model == "types") EXPECT_GT(max_degree, 10u);				// a binomial number of inputs
+		else EXPECT_EQ(10u, max_degree);
+		EXPECT_EQ(topo.synapses(), net.get_links().size());			// the map is built on demand
+	}
+
+	// on the spatial grid, inputs come from close neurons
+	Network grid(2500, "", 0., 8, "spatial", 1);
+	double distance = 0.0;
+	const Topology& grid_topo = grid.get_topology();
+	for (const auto& m : grid_topo.inputs(1275)) distance += std::hypot((double)(m % 50) - 25., (double)(m / 50) - 25.);
+	EXPECT_LT(distance/8, 6.0);
+}
+
+TEST(Generator, threads) {
+	for (const auto& model : Generator::Models) {
+		Wiring_parameters one, four;
+		one.threads = 1;
+		four.threads = 4;
+		*_RNG = RandomNumbers(77);
+		Topology t1, t4;
+		Generator(10000, 12, 1, one).generate(model, t1);
+		*_RNG = RandomNumbers(77);
+		Generator(10000, 12, 1, four).generate(model, t4);
+		EXPECT_EQ(t1.to_links(), t4.to_links()) << model;
+	}
+	Network net(50, "", 0., 5, "small-world", 1);
+	EXPECT_TRUE(net.add_link(0, 49, 3.) or net.get_links().count({0, 49}));
+	EXPECT_EQ(net.get_links().size(), net.get_topology().synapses());
+}
+
+TEST(Generator, types) {
+	Wiring_parameters wiring;
+	wiring.matrix = Connectivity_matrix::parse("FS->RS:0.3:8,RS->FS:0:1,RS->RS:0.01:2");
+	Network net(2000, "FS:0.2", 0., 20, "types", 1, wiring);
+	const Topology& topo = net.get_topology();
+	ASSERT_EQ("RS", net.get_neurons()[1599].get_type());
+	ASSERT_EQ("FS", net.get_neurons()[1600].get_type());
+	double from_fs(0), fs_intensity(0), from_rs(0), fs_fs(0);
+	for (size_t n(0); n<topo.size(); ++n) {
+		for (size_t k(0); k<topo.degree(n); ++k) {
+			size_t m = topo.inputs(n)[k];
+			EXPECT_NE(n, m);
+			if (k > 0) {
+				EXPECT_LT(topo.inputs(n)[k-1], m);							// sorted, hence grouped by the type of the sender
+			}
+			if (n < 1600 and m >= 1600) {
+				++from_fs;
+				fs_intensity += topo.intensities(n)[k];
+			}
+			if (n < 1600 and m < 1600) ++from_rs;
+			if (n >= 1600) {
+				EXPECT_GE(m, 1600u);										// no RS->FS link
+				++fs_fs;
+			}
+		}
+	}
+	EXPECT_NEAR(0.3, from_fs/(1600*400), 0.01);
+	EXPECT_NEAR(8.0, fs_intensity/from_fs, 0.1);
+	EXPECT_NEAR(0.01, from_rs/(1600*1599), 0.001);
+	EXPECT_NEAR(20.0/1999, fs_fs/(400*399), 0.002);						// pairs not given: connectivity/(size-1)
+
+	std::string path = "matrix_test.txt";
+	std::ofstream(path) << "# pre->post probability intensity\nFS->RS 0.5 2\n\nLTS->CH 1 1\n";
+	Connectivity_matrix matrix = Connectivity_matrix::parse(path);
+	ASSERT_NE(nullptr, matrix.find("FS", "RS"));
+	EXPECT_EQ(0.5, matrix.find("FS", "RS")->probability);
+	EXPECT_EQ(nullptr, matrix.find("RS", "FS"));
+	std::remove(path.c_str());
+	EXPECT_THROW(Connectivity_matrix::parse("XX->RS:0.1:1"), std::runtime_error);
+	EXPECT_THROW(Connectivity_matrix::parse("FS->RS:1.5:1"), std::runtime_error);
+	EXPECT_THROW(Connectivity_matrix::parse("FS-RS:0.5:1"), std::runtime_error);
+}
+
+TEST(Network, editing) {
+	*_RNG = RandomNumbers(31);
+	Network delta(400, "FS:0.2", 0., 10, "poisson", 4);
+	*_RNG = RandomNumbers(31);
+	Network merged(400, "FS:0.2", 0., 10, "poisson", 4);
+	size_t links = delta.get_links().size();
+	delta.set_seed(5);
+	merged.set_seed(5);
+	for (int t(0); t<20; ++t) EXPECT_EQ(delta.update(), merged.update());
+
+	// the same edits, kept in the delta or merged at once
+	for (Network* net : {&delta, &merged}) {
+		const Link& existing = net->get_links();
+		auto first = existing.begin(), second = std::next(first, 7);
+		std::pair<size_t, size_t> removed_link = first->first, changed_link = second->first;
+		EXPECT_TRUE(net->remove_link(removed_link.first, removed_link.second));
+		EXPECT_FALSE(net->remove_link(removed_link.first, removed_link.second));
+		EXPECT_TRUE(net->set_intensity(changed_link.first, changed_link.second, 30.));
+		EXPECT_FALSE(net->add_link(changed_link.first, changed_link.second, 1.));
+		for (size_t n(0); n<40; ++n) net->add_link(n, 399 - n, 25.);
+		net->remove_neuron(7);
+		EXPECT_TRUE(net->is_removed(7));
+		EXPECT_FALSE(net->add_link(7, 100, 1.));
+	}
+	EXPECT_GT(delta.pending_edits(), 40u);
+	merged.compact();
+	EXPECT_EQ(0u, merged.pending_edits());
+	for (int t(0); t<50; ++t) {
+		EXPECT_EQ(delta.update(), merged.update()) << t;
+		EXPECT_NEAR(merged.get_potential(150), delta.get_potential(150), 1e-9);
+	}
+	EXPECT_GT(delta.pending_edits(), 40u);									// the steps used the delta
+	EXPECT_EQ(merged.get_links(), delta.get_links());						// merged when the map is needed
+	EXPECT_EQ(0u, delta.pending_edits());
+	EXPECT_EQ(0u, merged.get_topology().degree(7));
+	for (const auto& link : merged.get_links()) EXPECT_NE(7u, link.first.second);
+	EXPECT_LT(links, merged.get_links().size());
+
+	// growth, and a compaction in the background once there are enough edits
+	size_t n = delta.add_neuron("CH");
+	EXPECT_EQ(400u, n);
+	EXPECT_EQ(401u, delta.get_size());
+	delta.set_compaction_threshold(30);
+	for (size_t m(10); m<40; ++m) EXPECT_TRUE(delta.add_link(n, m, 40.));
+	EXPECT_TRUE(delta.compacting());
+	bool fired(false);
+	for (int t(0); t<200; ++t) {
+		const std::vector<size_t>& firing = delta.update();
+		fired = fired or std::binary_search(firing.begin(), firing.end(), n);
+		EXPECT_FALSE(std::binary_search(firing.begin(), firing.end(), 7u));
+		if (delta.compacting()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	EXPECT_FALSE(delta.compacting());
+	EXPECT_EQ(0u, delta.pending_edits());
+	EXPECT_TRUE(fired);
+	EXPECT_EQ(30u, delta.get_topology().degree(n));
+	EXPECT_THROW(delta.add_neuron("XX"), std::runtime_error);
+}
+
+TEST(Network, reorder) {
+	*_RNG = RandomNumbers(11);
+	Network reference(2000, "", 0.2, 10, "small-world", 4);
+	*_RNG = RandomNumbers(11);
+	Network reordered(2000, "", 0.2, 10, "small-world", 4);
+	Link links = reference.get_links();
+	reordered.reorder(Ordering::random(2000));
+	double scrambled = Ordering::lines_per_link(reordered.get_topology());
+	reordered.reorder("rcm");
+	EXPECT_LT(Ordering::lines_per_link(reordered.get_topology()), scrambled);
+	EXPECT_EQ(links, reordered.get_links());
+	EXPECT_NE(0u, reordered.internal_id(0) + reordered.internal_id(1));
+	for (size_t n(0); n<2000; ++n) EXPECT_EQ(n, reordered.external_id(reordered.internal_id(n)));
+
+	*_RNG = RandomNumbers(3);
+	std::vector<std::vector<size_t>> spikes;
+	for (int t(0); t<20; ++t) spikes.push_back(reference.update());
+	*_RNG = RandomNumbers(3);
+	for (int t(0); t<20; ++t) EXPECT_EQ(spikes[t], reordered.update()) << t;
+	for (size_t n(0); n<2000; n+=97) EXPECT_NEAR(reference.get_potential(n), reordered.get_potential(n), 1e-9);
+
+	std::vector<uint32_t> order = Ordering::partition(reordered.get_topology(), 256);
+	std::vector<bool> seen(2000, false);
+	for (const auto& i : order) seen[i] = true;
+	EXPECT_EQ(2000u, order.size());
+	EXPECT_EQ(seen.end(), std::find(seen.begin(), seen.end(), false));
+}
+
+TEST(Network, compression) {
+	*_RNG = RandomNumbers(5);
+	Network net(3000, "", 0.2, 10, "spatial", 4);
+	Topology plain = net.get_topology();
+	for (int bits : {8, 16}) {
+		CompressedTopology compressed(plain, bits);
+		EXPECT_EQ(plain.synapses(), compressed.synapses());
+		EXPECT_LT(compressed.bytes(), plain.bytes()/2);
+		Topology expanded = compressed.expand();
+		std::vector<double> drive(3000);
+		for (size_t n(0); n<3000; ++n) drive[n] = (n%3 == 0 ? 0.5 : (n%7 == 0 ? -1.0 : 0.0));
+		for (size_t n(0); n<3000; n+=31) {
+			ASSERT_EQ(plain.degree(n), expanded.degree(n));
+			double exact(0.0), tolerance(0.0);
+			for (size_t k(0); k<plain.degree(n); ++k) {
+				EXPECT_EQ(plain.inputs(n)[k], expanded.inputs(n)[k]);
+				EXPECT_NEAR(plain.intensities(n)[k], expanded.intensities(n)[k], 8.0/(bits == 8 ? 127 : 32767));
+				exact += plain.intensities(n)[k]*drive[plain.inputs(n)[k]];
+				tolerance += 8.0/(bits == 8 ? 127 : 32767);
+			}
+			EXPECT_NEAR(exact, compressed.row_sum(n, drive.data()), tolerance);
+		}
+	}
+
+	double valence = net.valence(42);
+	EXPECT_THROW(net.compress("16"), std::runtime_error);			// not a mode: nothing would be compressed
+	EXPECT_EQ(plain.bytes(), net.topology_bytes());
+	net.compress("q16");
+	EXPECT_NEAR(valence, net.valence(42), 0.01);
+	EXPECT_LT(net.topology_bytes(), plain.bytes()/2);
+	for (int t(0); t<10; ++t) net.update();
+	EXPECT_EQ(plain.synapses(), net.get_topology().synapses());
+}
+
+TEST(Network, streaming) {
+	*_RNG = RandomNumbers(8);
+	Network reference(2000, "", 0.2, 20, "poisson", 4);
+	*_RNG = RandomNumbers(8);
+	Network streamed(2000, "", 0.2, 20, "poisson", 4);
+	Link links = reference.get_links();
+	std::string path = "/tmp/nn_streaming_test." + std::to_string(getpid());
+	EXPECT_THROW(streamed.stream(path, 16), OUTPUT_ERROR);
+	streamed.stream(path, 64*1024);									// about 20 blocks
+	EXPECT_EQ(0, access(path.c_str(), F_OK));
+	EXPECT_LT(streamed.topology_bytes(), reference.topology_bytes()/4);
+	EXPECT_DOUBLE_EQ(reference.valence(7), streamed.valence(7));
+
+	*_RNG = RandomNumbers(4);
+	std::vector<std::vector<size_t>> spikes;
+	for (int t(0); t<20; ++t) spikes.push_back(reference.update());
+	*_RNG = RandomNumbers(4);
+	for (int t(0); t<20; ++t) EXPECT_EQ(spikes[t], streamed.update()) << t;
+	EXPECT_LE(0.0, streamed.get_io_wait());
+	if (AllocationCounter::enabled()) {
+		size_t before = AllocationCounter::count();
+		for (int t(0); t<5; ++t) streamed.update();
+		streamed.valence(7);
+		EXPECT_EQ(before, AllocationCounter::count());					// the blocks and rows are read into the same buffers
+	}
+	EXPECT_EQ(links, streamed.get_links());
+	EXPECT_NE(0, access(path.c_str(), F_OK));							// the links are back in memory
+}
+
+TEST(Network, streamed_build) {
+	std::string path = "/tmp/nn_streamed_build." + std::to_string(getpid());
+	for (const std::string model : {"poisson", "small-world", "scale-free", "spatial", "types"}) {
+		size_t size = (Generator::is_structured(model) ? 3*Generator::Chunk - 100 : 3000);
+		Wiring_parameters wiring;
+		wiring.threads = 2;
+		*_RNG = RandomNumbers(17);
+		Network built(size, "FS:0.2", 0.1, 10, model, 4, wiring);
+		wiring.stream = path;
+		wiring.stream_budget = 64*1024;									// a chunk generated at a time, blocks of about 270 rows
+		*_RNG = RandomNumbers(17);
+		Network streamed(size, "FS:0.2", 0.1, 10, model, 4, wiring);
+		EXPECT_EQ(0, access(path.c_str(), F_OK)) << model;
+		EXPECT_LT(streamed.topology_bytes(), built.topology_bytes()/3) << model;
+		*_RNG = RandomNumbers(4);
+		std::vector<std::vector<size_t>> spikes;
+		for (int t(0); t<5; ++t) spikes.push_back(built.update());
+		*_RNG = RandomNumbers(4);
+		for (int t(0); t<5; ++t) EXPECT_EQ(spikes[t], streamed.update()) << model << " " << t;
+		EXPECT_EQ(built.get_links(), streamed.get_links()) << model;	// read back into memory
+	}
+	const char* reordered[] = {"NeuronNetwork", "-n", "200", "--stream", path.c_str(), "--reorder", "rcm"};
+	EXPECT_EXIT(Simulation(7, const_cast<char**>(reordered)), testing::ExitedWithCode(EXIT_FAILURE), "");
+}
+
+TEST(Plasticity, pairs) {
+	Link links {{{1, 0}, 10.}, {{2, 1}, 10.}, {{0, 2}, 10.}};
+	Topology topology;
+	topology.build(links, 3);
+	Plasticity_parameters parameters;
+	parameters.max_weight = 11.;
+	Plasticity stdp(parameters, topology);
+	stdp.spike({0}, 10, 1., topology);								// 0 fires, then 1 five steps later
+	EXPECT_EQ(2u, stdp.updates());
+	EXPECT_DOUBLE_EQ(10., topology.intensities(1)[0]);
+	stdp.spike({1}, 15, 1., topology);
+	EXPECT_NEAR(10. + parameters.potentiation*std::exp(-5./parameters.tau_plus), topology.intensities(1)[0], 1e-12);	// 0 -> 1 strengthened
+	EXPECT_DOUBLE_EQ(10., topology.intensities(2)[0]);
+	stdp.spike({0}, 16, 1., topology);								// 0 fires after 2: 2 -> 0 unchanged, 0 -> 1 weakened
+	EXPECT_NEAR(10. + parameters.potentiation*std::exp(-5./parameters.tau_plus) - parameters.depression*std::exp(-1./parameters.tau_minus),
+				topology.intensities(1)[0], 1e-12);
+	for (int t(20); t<100; t+=2) stdp.spike({0, 1, 2}, t, 1., topology);
+	for (size_t n(0); n<3; ++n) {
+		EXPECT_LE(0., topology.intensities(n)[0]);
+		EXPECT_GE(11., topology.intensities(n)[0]);
+	}
+}
+
+TEST(Network, plasticity) {
+	Network net(500, "", 0.1, 20, "poisson", 4);
+	net.set_plasticity(Plasticity_parameters());
+	size_t expected(0);
+	const Topology& topology = net.get_topology();
+	std::vector<size_t> sent(500, 0);
+	for (size_t n(0); n<500; ++n) for (const auto& m : topology.inputs(n)) ++sent[m];
+	for (int t(0); t<50; ++t) {
+		for (const auto& n : net.update()) expected += topology.degree(n) + sent[n];
+	}
+	EXPECT_EQ(expected, net.plastic_updates());						// only the links of the firing neurons are visited
+	EXPECT_LT(0u, expected);
+	for (const auto& link : net.get_links()) {
+		EXPECT_LE(0., link.second);
+		EXPECT_GE(_STDP_Max_Weight_, link.second);
+	}
+	EXPECT_THROW(net.compress("q8"), std::runtime_error);
+}
+
+TEST(Trials, lanes) {
+	for (size_t lanes : {3, 70}) {
+		*_RNG = RandomNumbers(21);
+		Network net(400, "", 0.2, 15, "small-world", 6);
+		net.reorder("rcm");
+		Trials trials(net, lanes);
+		std::vector<std::vector<std::vector<size_t>>> spikes(lanes);
+		for (int t(0); t<30; ++t) {
+			const std::vector<std::vector<size_t>>& firing = trials.update();
+			for (size_t k(0); k<lanes; ++k) spikes[k].push_back(firing[k]);
+		}
+		for (size_t k : {(size_t)0, lanes - 1}) {						// each trial is the network run alone with its seed
+			*_RNG = RandomNumbers(21);
+			Network alone(400, "", 0.2, 15, "small-world", 6);
+			*_RNG = RandomNumbers(trials.get_seeds()[k]);
+			for (int t(0); t<30; ++t) EXPECT_EQ(spikes[k][t], alone.update()) << k << " " << t;
+			EXPECT_DOUBLE_EQ(alone.get_potential(17), trials.get_potential(17, k));
+		}
+		EXPECT_NE(spikes[0], spikes[1]);
+	}
+	const char* compressed[] = {"NeuronNetwork", "-n", "200", "--trials", "4", "--compress", "q8"};
+	EXPECT_EXIT(Simulation(7, const_cast<char**>(compressed)), testing::ExitedWithCode(EXIT_FAILURE), "");
+	const char* streamed[] = {"NeuronNetwork", "-n", "200", "--trials", "4", "--stream", "/tmp/nn_trials_links"};
+	EXPECT_EXIT(Simulation(7, const_cast<char**>(streamed)), testing::ExitedWithCode(EXIT_FAILURE), "");
+}
+
+TEST(WorkPool, stealing) {
+	WorkPool pool(4);
+	EXPECT_EQ(4u, pool.size());
+	for (bool stealing : {true, false}) {
+		std::vector<std::atomic<int>> runs(1000);
+		for (auto& r : runs) r = 0;
+		pool.reset_statistics();
+		pool.run(1000, [&](const size_t& t) {
+			if (t < 250) std::this_thread::sleep_for(std::chrono::microseconds(200));		// the tasks of the first thread are slow
+			++runs[t];
+		}, stealing);
+		for (const auto& r : runs) EXPECT_EQ(1, r);
+		size_t tasks(0), steals(0);
+		for (const auto& s : pool.statistics()) {
+			tasks += s.tasks;
+			steals += s.steals;
+		}
+		EXPECT_EQ(1000u, tasks);
+		if (stealing) EXPECT_LT(0u, steals);
+		else EXPECT_EQ(0u, steals);
+	}
+}
+
+TEST(Network, threads) {
+	*_RNG = RandomNumbers(9);
+	Network serial(3000, "", 0.2, 20, "over-dispersed", 4);
+	*_RNG = RandomNumbers(9);
+	Network parallel(3000, "", 0.2, 20, "over-dispersed", 4);
+	parallel.set_threads(4);
+	*_RNG = RandomNumbers(2);
+	std::vector<std::vector<size_t>> spikes;
+	for (int t(0); t<20; ++t) spikes.push_back(serial.update());
+	*_RNG = RandomNumbers(2);
+	for (int t(0); t<20; ++t) EXPECT_EQ(spikes[t], parallel.update()) << t;
+	std::vector<WorkPool::Statistics> statistics = parallel.thread_statistics();
+	ASSERT_EQ(4u, statistics.size());
+	size_t tasks(0);
+	for (const auto& s : statistics) tasks += s.tasks;
+	EXPECT_LE(20*Network::Chunks_per_thread*4, tasks + 20*4);			// about Chunks_per_thread chunks per thread at each step
+	EXPECT_TRUE(serial.thread_statistics().empty());
+}
+
+TEST(Memory, placement) {
+	EXPECT_EQ(std::vector<int>({0, 2, 4, 5, 6}), Memory::parse_cores("0,2,4-6"));
+	EXPECT_THROW(Memory::parse_cores("1,x"), std::runtime_error);
+	EXPECT_THROW(Memory::parse_cores("3-1"), std::runtime_error);
+
+	Array<double> array(Memory::Huge_page);								// 16 MB, mapped but not written
+	std::vector<size_t> nodes = Memory::pages_per_node(array.data(), array.size()*sizeof(double));
+	if (not nodes.empty()) {
+		EXPECT_EQ(0u, std::accumulate(nodes.begin(), nodes.end() - 1, (size_t)0));
+		std::fill(array.begin(), array.end(), 1.0);
+		nodes = Memory::pages_per_node(array.data(), array.size()*sizeof(double));
+		EXPECT_EQ(0u, nodes.back());
+	}
+
+	*_RNG = RandomNumbers(6);
+	Network reference(3000, "", 0.2, 20, "spatial", 4);
+	*_RNG = RandomNumbers(6);
+	Network placed(3000, "", 0.2, 20, "spatial", 4);
+	placed.set_threads(3);
+	cpu_set_t affinity;
+	sched_getaffinity(0, sizeof(affinity), &affinity);
+	EXPECT_TRUE(placed.pin_threads({0}));
+	placed.place();
+	sched_setaffinity(0, sizeof(affinity), &affinity);					// this thread runs the other tests
+	EXPECT_EQ(reference.get_links(), placed.get_links());
+	*_RNG = RandomNumbers(1);
+	std::vector<std::vector<size_t>> spikes;
+	for (int t(0); t<10; ++t) spikes.push_back(reference.update());
+	*_RNG = RandomNumbers(1);
+	for (int t(0); t<10; ++t) EXPECT_EQ(spikes[t], placed.update()) << t;
+	std::stringstream report;
+	placed.print_placement(&report);
+	EXPECT_EQ(0u, report.str().find("# partition 0"));
+}
+
+TEST(Validation, engines) {
+	for (const char* model : {"poisson", "spatial"}) {
+		*_RNG = RandomNumbers(14);
+		Network optimized(2000, "", 0.2, 20, model, 5);
+		*_RNG = RandomNumbers(14);
+		Network reference(2000, "", 0.2, 20, model, 5);
+		optimized.set_threads(3);
+		Validation same(optimized, reference, {0.0, 0.0, 0.0});
+		std::vector<uint64_t> hashes;
+		for (int t(0); t<25; ++t) {
+			same.update();
+			hashes.push_back(Validation::state_hash(optimized));
+			EXPECT_EQ(hashes.back(), Validation::state_hash(reference)) << model << " " << t;		// the sums are done in the same order
+		}
+		EXPECT_FALSE(same.diverged()) << model;
+		EXPECT_EQ(25u, same.agreed());
+
+		optimized.reorder("rcm");										// the order of the sums changes
+		Validation reordered(optimized, reference, {1e-9, 1e-9, 1e-9});
+		for (int t(0); t<25; ++t) reordered.update();
+		EXPECT_FALSE(reordered.diverged()) << model;
+
+		optimized.set_neuron_potential(123, optimized.get_potential(123) + 1e-3);
+		reordered.update();
+		ASSERT_TRUE(reordered.diverged());
+		EXPECT_EQ(26u, reordered.divergence().step);
+		EXPECT_EQ(123u, reordered.divergence().neuron);
+		optimized.set_neuron_potential(7, 40);							// fires at the next step in the optimized network only
+		Validation spikes(optimized, reference, {1.0, 1.0, 1e9});
+		spikes.update();
+		ASSERT_TRUE(spikes.diverged());
+		EXPECT_EQ("spike", spikes.divergence().quantity);
+		EXPECT_EQ(7u, spikes.divergence().neuron);
+		EXPECT_EQ(0.0, spikes.divergence().reference);
+	}
+	EXPECT_EQ(Validation::spike_hash({1, 2}), Validation::spike_hash({1, 2}));
+	EXPECT_NE(Validation::spike_hash({1, 2}), Validation::spike_hash({1, 3}));
+}
+
+TEST(Server, jobs) {
+	std::string path = "/tmp/nn_server_" + std::to_string(getpid());
+	Server server(path, 2);
+	std::thread serving([&server] { server.serve(); });
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	std::strcpy(address.sun_path, path.c_str());
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	ASSERT_EQ(0, connect(fd, (sockaddr*)&address, sizeof(address)));
+	std::string buffer;
+	auto request = [fd](const std::string& text) { ASSERT_EQ((ssize_t)text.size(), send(fd, text.data(), text.size(), 0)); };
+	auto line = [fd, &buffer]() {
+		char chunk[4096];
+		size_t end;
+		while ((end = buffer.find('\n')) == std::string::npos) {
+			ssize_t got = recv(fd, chunk, sizeof(chunk), 0);
+			if (got <= 0) return std::string();
+			buffer.append(chunk, got);
+		}
+		std::string text = buffer.substr(0, end);
+		buffer.erase(0, end + 1);
+		return text;
+	};
+
+	request("build small number=300 model=small-world seed=5\n");
+	EXPECT_EQ(0u, line().find("ok build small 300 "));
+	request("build other number=300 model=nothing\nrun missing\n");
+	EXPECT_EQ("error Unknown model nothing.", line());
+	EXPECT_EQ("1 error Unknown network missing.", line());
+	request("run small steps=20 seed=9 outputs=spikes,hash\nrun small steps=20 seed=9\n");
+	std::map<std::string, std::vector<std::string>> replies;						// the lines of each job, in order
+	while (replies["2"].size() < 41 or replies["3"].size() < 21) {
+		std::string text = line();
+		ASSERT_FALSE(text.empty());
+		replies[text.substr(0, text.find(' '))].push_back(text.substr(text.find(' ') + 1));
+	}
+	EXPECT_EQ(0u, replies["2"].back().find("done 20 "));
+	EXPECT_EQ(0u, replies["3"].back().find("done 20 "));
+
+	*_RNG = RandomNumbers(5);													// the same network and noise, run alone
+	Network alone(300, "", _Delta_, _Connectivity_, "small-world", _Intensity_);
+	alone.set_seed(9);
+	std::vector<std::string> spikes;
+	for (int t(1); t<=20; ++t) {
+		std::string text = "spikes " + std::to_string(t);
+		for (const auto& n : alone.update()) text += " " + std::to_string(n);
+		spikes.push_back(text);
+	}
+	for (int t(0); t<20; ++t) {													// each job starts again from the initial state
+		EXPECT_EQ(spikes[t], replies["3"][t]) << t;
+		EXPECT_EQ(spikes[t], replies["2"][2*t]) << t;
+		EXPECT_EQ(0u, replies["2"][2*t + 1].find("hash " + std::to_string(t + 1) + " "));
+	}
+
+	// jobs continuing the state of the previous one start their stimulus at their own first step
+	std::string pulse = path + ".stimulus";
+	std::ofstream(pulse) << "pulse 0-9 1 2 100\n";
+	request("build stimulated number=100 model=small-world seed=5\n");
+	EXPECT_EQ(0u, line().find("ok build stimulated 100 "));
+	*_RNG = RandomNumbers(5);
+	Network continued(100, "", _Delta_, _Connectivity_, "small-world", _Intensity_);
+	for (const std::string job : {"4", "5"}) {
+		request("run stimulated steps=5 seed=9 reset=0 stimulus=" + pulse + "\n");		// one after the other
+		continued.set_stimulus(Stimulus::read(pulse), continued.get_steps());
+		continued.set_seed(9);
+		for (int t(1); t<=5; ++t) {
+			std::string text = "spikes " + std::to_string(t);
+			for (const auto& n : continued.update()) text += " " + std::to_string(n);
+			EXPECT_EQ(job + " " + text, line()) << t;
+		}
+		EXPECT_EQ(0u, line().find(job + " done 5 "));
+	}
+	std::remove(pulse.c_str());
+	request("edit small op=remove-neuron neuron=4\nedit small op=add-link post=4 pre=9\nedit small op=add-neuron type=FS\n"
+			"edit small op=add-link post=300 pre=9 intensity=3\nedit small op=grow\n");
+	EXPECT_EQ("ok edit small 1 0", line());
+	EXPECT_EQ("ok edit small 0 0", line());
+	EXPECT_EQ("ok edit small 300 0", line());
+	EXPECT_EQ("ok edit small 1 1", line());
+	EXPECT_EQ("error Unknown edit grow.", line());
+	request("list\nshutdown\n");
+	EXPECT_EQ(0u, line().find("network small 301 "));
+	EXPECT_EQ(0u, line().find("network stimulated 100 "));
+	EXPECT_EQ("ok list", line());
+	EXPECT_EQ("ok shutdown", line());
+	serving.join();
+	close(fd);
+}
+
+TEST(Stimulus, schedule) {
+	std::string train = "/tmp/nn_train_" + std::to_string(getpid());
+	std::ofstream(train) << "1 5\n4 7 2.5\n\n4 8\n9 1\n";
+	Stimulus stimulus;
+	stimulus.pulse(0, 3, 3, 3, 10.0);
+	stimulus.ramp(10, 12, 2, 3, 0.0, 4.0);
+	stimulus.train(train, 1.5);
+	std::vector<std::map<size_t, double>> currents(1);
+	std::vector<size_t> active(1);
+	for (size_t t(1); t<=8; ++t) {
+		currents.push_back(std::map<size_t, double>());
+		stimulus.inject(t, [&](const size_t& n, const double& current) { currents[t][n] += current; });
+		active.push_back(stimulus.active_stimuli());
+	}
+	EXPECT_EQ((std::map<size_t, double>{{5, 1.5}}), currents[1]);
+	EXPECT_EQ((std::map<size_t, double>{{10, 0.0}, {11, 0.0}}), currents[2]);
+	EXPECT_EQ((std::map<size_t, double>{{0, 10.0}, {1, 10.0}, {2, 10.0}, {10, 2.0}, {11, 2.0}}), currents[3]);
+	EXPECT_EQ((std::map<size_t, double>{{0, 10.0}, {1, 10.0}, {2, 10.0}, {10, 4.0}, {11, 4.0}, {7, 2.5}, {8, 1.5}}), currents[4]);
+	EXPECT_EQ(3u, currents[5].size());
+	EXPECT_TRUE(currents[6].empty());
+	EXPECT_EQ((std::vector<size_t>{0, 0, 1, 2, 2, 1, 0, 0, 0}), active);
+	EXPECT_THROW(stimulus.inject(8, [](const size_t&, const double&) {}), std::runtime_error);
+	stimulus.rewind();
+	std::map<size_t, double> first;
+	stimulus.inject(1, [&](const size_t& n, const double& current) { first[n] += current; });
+	EXPECT_EQ(currents[1], first);
+
+	std::string schedule = "/tmp/nn_stimulus_" + std::to_string(getpid());
+	std::ofstream(schedule) << "# the first 50 neurons\npulse 0-49 5 10 40\n\ntrain " << train << " 100\n";
+	*_RNG = RandomNumbers(8);
+	Network quiet(400, "", 0.2, 10, "poisson", 2);
+	*_RNG = RandomNumbers(8);
+	Network stimulated(400, "", 0.2, 10, "poisson", 2);
+	stimulated.set_stimulus(Stimulus::read(schedule));
+	*_RNG = RandomNumbers(3);
+	std::vector<std::vector<size_t>> spikes;
+	for (int t(0); t<12; ++t) spikes.push_back(quiet.update());
+	*_RNG = RandomNumbers(3);
+	EXPECT_EQ(spikes[0], stimulated.update());
+	const std::vector<size_t>& second = stimulated.update();						// the neuron of the first spike train fires at step 2
+	EXPECT_TRUE(std::find(second.begin(), second.end(), 5) != second.end());
+	EXPECT_TRUE(std::find(spikes[1].begin(), spikes[1].end(), 5) == spikes[1].end());
+	size_t fired(0);
+	for (int t(2); t<12; ++t) for (const auto& n : stimulated.update()) fired += (n < 50);
+	EXPECT_GE(fired, 50u);															// every stimulated neuron fires
+	std::ofstream(schedule) << "pulse 0-400 1 1 1\n";
+	EXPECT_THROW(stimulated.set_stimulus(Stimulus::read(schedule)), CFILE_ERROR);
+	std::ofstream(schedule) << "ramp 0-10 1 1\n";
+	EXPECT_THROW(Stimulus::read(schedule), CFILE_ERROR);
+	std::remove(train.c_str());
+	std::remove(schedule.c_str());
+}
+
+TEST(SpikeArchive, windows) {
+	std::string path = "/tmp/nn_archive_" + std::to_string(getpid());
+	std::vector<std::pair<size_t, size_t>> spikes;								// (step, neuron) of every spike written
+	{
+		SpikeArchive archive = SpikeArchive::create(path, 5000, 100, 0.5, true);
+		SpikeArchive::Type rs = {"RS", 0, 4000}, fs = {"FS", 4000, 5000};
+		archive.set_types({rs, fs});
+		*_RNG = RandomNumbers(4);
+		for (size_t t(1); t<=1050; ++t) {
+			if (t % 7 == 0 or (t > 300 and t <= 400)) continue;					// steps not written, and a whole block
+			std::vector<size_t> firing;
+			for (size_t n(0); n<5000; n += 1 + _RNG->uniform_int(0, t < 10 ? 4000 : 300)) firing.push_back(n);
+			for (const auto& n : firing) spikes.push_back({t, n});
+			archive.write(t, firing);
+		}
+		EXPECT_THROW(archive.write(1000, {}), OUTPUT_ERROR);
+	}
+	SpikeArchive archive = SpikeArchive::open(path);
+	EXPECT_EQ(5000u, archive.neurons());
+	EXPECT_EQ(100u, archive.block_steps());
+	EXPECT_EQ(1049u, archive.steps());
+	ASSERT_EQ(10u, archive.blocks().size());
+	EXPECT_EQ(401u, archive.blocks()[3].first_step);
+	for (const auto& window : std::vector<std::pair<size_t, size_t>>{{1, 1050}, {0, 5}, {250, 260}, {280, 420}, {330, 370}, {1001, 2000}, {99, 101}}) {
+		std::vector<std::pair<size_t, size_t>> expected, read;
+		for (const auto& spike : spikes) if (spike.first >= window.first and spike.first <= window.second) expected.push_back(spike);
+		archive.read(window.first, window.second, [&read](const size_t& step, const size_t& neuron) { read.push_back({step, neuron}); });
+		EXPECT_EQ(expected, read) << window.first << "-" << window.second;
+		EXPECT_EQ(expected.size(), archive.count(window.first, window.second)) << window.first << "-" << window.second;
+		for (const size_t n : {0, 17, 4999}) {
+			std::vector<size_t> steps, posted;
+			for (const auto& spike : expected) if (spike.second == n) steps.push_back(spike.first);
+			archive.read_neuron(n, window.first, window.second, [&posted](const size_t& step) { posted.push_back(step); });
+			EXPECT_EQ(steps, posted) << n << " in " << window.first << "-" << window.second;
+		}
+	}
+	EXPECT_EQ(0.5, archive.time_step());
+	ASSERT_EQ(2u, archive.types().size());
+	EXPECT_STREQ("FS", archive.types()[1].name);
+	EXPECT_EQ(4000u, archive.types()[1].first);
+	EXPECT_TRUE(archive.has_postings());
+	EXPECT_GT(archive.window_bytes(1, 1050), archive.window_bytes(250, 260));
+	EXPECT_LT(archive.posting_bytes(17), archive.window_bytes(250, 260));
+	std::ofstream(path) << "1 0 1 0\n";
+	EXPECT_THROW(SpikeArchive::open(path), CFILE_ERROR);
+	std::remove(path.c_str());
+}
+
+TEST(SpikeArchive, types) {
+	std::string path = "/tmp/nn_archive_types_" + std::to_string(getpid());
+	const char* args[] = {"NeuronNetwork", "-n", "7", "-t", "20", "-o", "", "-s", "", "-p", "", "--archive", path.c_str()};
+	Simulation(13, const_cast<char**>(args)).run();
+	size_t size(0);
+	for (const auto& block : Network::type_blocks("", 7)) size += block.last - block.first;
+	ASSERT_LT(size, 7u);
+	SpikeArchive archive = SpikeArchive::open(path);
+	EXPECT_EQ(size, archive.neurons());								// the types round the 7 neurons down
+	ASSERT_FALSE(archive.types().empty());
+	EXPECT_EQ(0u, archive.types().front().first);
+	EXPECT_EQ(size, archive.types().back().last);
+	for (const auto& type : archive.types()) EXPECT_NE(0u, std::strlen(type.name));
+	std::remove(path.c_str());
+}
+
+namespace {
+/*!
+ * Runs nnquery with \p args: returns its exit code, and what it prints in \p printed
+ */
+int nnquery(const std::string& args, std::string& printed)
+{
+	FILE *pipe = popen((std::string(NNQUERY) + " " + args + " 2>/dev/null").c_str(), "r");
+	char buffer[256];
+	printed.clear();
+	while (size_t n = fread(buffer, 1, sizeof(buffer), pipe)) printed.append(buffer, n);
+	return WEXITSTATUS(pclose(pipe));
+}
+}
+
+TEST(SpikeArchive, query) {
+	std::string path = "/tmp/nn_query_" + std::to_string(getpid());
+	{
+		SpikeArchive archive = SpikeArchive::create(path, 500, 20, 0.5, true);
+		SpikeArchive::Type rs = {"RS", 0, 400}, fs = {"FS", 400, 500};
+		archive.set_types({rs, fs});
+		for (size_t t(1); t<=100; ++t) {									// each neuron fires twice
+			std::vector<size_t> firing;
+			for (size_t n((50 - t % 50) % 50); n<500; n += 50) firing.push_back(n);
+			archive.write(t, firing);
+		}
+	}
+	std::string printed;
+	EXPECT_EQ(0, nnquery("-a " + path + " --neurons 17", printed));
+	EXPECT_EQ("33 17\n83 17\n", printed);
+	EXPECT_EQ(0, nnquery("-a " + path + " --neurons 10-19 --count", printed));
+	EXPECT_EQ("20\n", printed);
+	EXPECT_EQ(0, nnquery("-a " + path + " --type FS --count", printed));
+	EXPECT_EQ("200\n", printed);
+	EXPECT_EQ(0, nnquery("-a " + path + " --neurons 450-600 --type FS --count", printed));
+	EXPECT_EQ("100\n", printed);
+	EXPECT_EQ(20, nnquery("-a " + path + " --neurons 600-700", printed));
+	EXPECT_EQ(20, nnquery("-a " + path + " --neurons 17+19", printed));
+	std::remove(path.c_str());
+}
+
+TEST(ShardedOutput, merge) {
+	const char* single[] = {"NeuronNetwork", "-n", "50", "-t", "40", "-o", "shard_single.txt", "-s", "shard_single_sample.txt", "-p", "shard_param.txt"};
+	const char* sharded[] = {"NeuronNetwork", "-n", "50", "-t", "40", "-o", "shard_set.txt", "-s", "shard_set_sample.txt", "-p", "shard_param.txt",
+							 "--shards", "3"};
+	*_RNG = RandomNumbers(12);
+	Simulation(11, const_cast<char**>(single)).run();
+	*_RNG = RandomNumbers(12);
+	Simulation(13, const_cast<char**>(sharded)).run();
+	for (const auto& name : std::vector<std::pair<std::string, std::string>>{{"shard_single.txt", "shard_set.txt"}, {"shard_single_sample.txt", "shard_set_sample.txt"}}) {
+		ShardReader expected(name.first), merged(name.second);
+		EXPECT_EQ(1u, expected.size());
+		EXPECT_EQ(3u, merged.size());
+		std::string a, b;
+		size_t lines(0);
+		while (expected.next(a)) {
+			ASSERT_TRUE(merged.next(b));
+			EXPECT_EQ(a, b) << name.second << " line " << lines;
+			++lines;
+		}
+		EXPECT_FALSE(merged.next(b));
+		EXPECT_GE(lines, 40u);
+	}
+	std::ofstream("shard_set.txt.shard1") << "#shard 1 3 16 33\n2 0 1\n";		// not aligned with shard 0
+	ShardReader broken("shard_set.txt");
+	std::string line;
+	EXPECT_THROW(broken.next(line), CFILE_ERROR);
+	std::ofstream("shard_set.txt.shard2") << "#shard 2 3 20 50\n";
+	EXPECT_THROW(ShardReader("shard_set.txt"), CFILE_ERROR);
+	for (const std::string name : {"shard_single.txt", "shard_single_sample.txt", "shard_param.txt"}) std::remove(name.c_str());
+	for (int k(0); k<3; ++k) {
+		std::remove(("shard_set.txt.shard" + std::to_string(k)).c_str());
+		std::remove(("shard_set_sample.txt.shard" + std::to_string(k)).c_str());
+	}
+}
+
+TEST(MeanField, rates) {
+	std::vector<Type_block> blocks = Network::type_blocks("FS:0.2", 1000);
+	ASSERT_EQ(2u, blocks.size());
+	EXPECT_EQ("FS", blocks[1].name);
+	EXPECT_EQ(800u, blocks[1].first);
+	EXPECT_EQ(1000u, blocks[1].last);
+	PopulationRates counted({{"RS", 0, 8}, {"FS", 8, 10}}, 5, 1.0);
+	std::ostringstream lines;
+	counted.header(&lines);
+	for (int t(1); t<=5; ++t) {
+		counted.add(std::vector<size_t>{1, 2, 9});
+		counted.step(t, &lines);
+	}
+	EXPECT_EQ("Time(ms)\tRS\tFS\n5\t250\t500\n", lines.str());
+
+	Wiring_parameters wiring;
+	MeanField poisson(2000, "FS:0.2", 0.2, 30, "poisson", 4, wiring, 500);
+	EXPECT_NEAR(6.0, poisson.inputs(0, 1), 1.0);
+	EXPECT_NEAR(24.0, poisson.inputs(1, 0), 2.0);
+	wiring.matrix = Connectivity_matrix::parse("FS->RS:0.05:8");
+	MeanField typed(2000, "FS:0.2", 0.2, 30, "types", 4, wiring, 500);
+	EXPECT_NEAR(20.0, typed.inputs(0, 1), 1.0);
+
+	// the rates of the mean field follow those of the network built with the same parameters
+	const size_t steps = 300;
+	Network net(2000, "FS:0.2", 0.2, 30, "poisson", 4);
+	MeanField field(2000, "FS:0.2", 0.2, 30, "poisson", 4);
+	PopulationRates full(Network::type_blocks("FS:0.2", 2000), steps, 1.0), approximate(field.get_types(), steps, 1.0);
+	for (size_t t(1); t<=steps; ++t) {
+		full.add(net.update());
+		const std::vector<double>& firing = field.update();
+		for (size_t k(0); k<firing.size(); ++k) approximate.add(k, firing[k]);
+		full.step((int)t, nullptr);
+		approximate.step((int)t, nullptr);
+	}
+	std::vector<double> exact = full.mean_rates(), rates = approximate.mean_rates();
+	EXPECT_GT(exact[0], 1.0);
+	EXPECT_NEAR(exact[0], rates[0], 0.25*exact[0]);
+
+	const char* network_run[] = {"NeuronNetwork", "-n", "100", "-t", "40", "-o", "", "-s", "", "-p", "", "--rates", "rates_network.txt"};
+	const char* field_run[] = {"NeuronNetwork", "-n", "100", "-t", "40", "--engine", "mean-field", "--rates", "rates_field.txt"};
+	Simulation(13, const_cast<char**>(network_run)).run();
+	Simulation(9, const_cast<char**>(field_run)).run();
+	std::ifstream network_rates("rates_network.txt"), field_rates("rates_field.txt");
+	std::string a, b;
+	size_t count(0);
+	while (std::getline(network_rates, a)) {
+		ASSERT_TRUE(std::getline(field_rates, b));
+		if (count == 0) EXPECT_EQ(a, b);									// same header
+		else EXPECT_EQ(a.substr(0, a.find('\t')), b.substr(0, b.find('\t')));	// same windows
+		++count;
+	}
+	EXPECT_FALSE(std::getline(field_rates, b));
+	EXPECT_EQ(5u, count);
+	std::remove("rates_network.txt");
+	std::remove("rates_field.txt");
+}
+
+TEST(Footprint, preflight) {
+	Footprint_parameters p;
+	p.neurons = 10000;
+	p.connectivity = 50;
+	EXPECT_DOUBLE_EQ(5e5, Footprint::expected_links(p));
+	Footprint map = Footprint::estimate(p);
+	p.wiring.rows = true;
+	Footprint rows = Footprint::estimate(p);
+	EXPECT_GT(map.building, 5e5*64);
+	EXPECT_LT(rows.peak(), map.peak()/4);
+	Footprint_parameters streamed(p);
+	streamed.stream_budget = 1 << 20;
+	EXPECT_LT(Footprint::estimate(streamed).peak(), rows.peak()/2);		// the links go to the file as they are drawn
+	p.bits = 8;
+	EXPECT_LT(Footprint::estimate(p).links, rows.links/2);
+	p.model = "types";
+	p.n_types = "FS:0.2";
+	p.wiring.matrix = Connectivity_matrix::parse("FS->RS:0.01:5");
+	EXPECT_NEAR(8000*2000*0.01 + (8000.0*8000 + 2000.0*2000 + 2000.0*8000)*50/9999, Footprint::expected_links(p), 1.0);
+	EXPECT_GT(Memory::peak_resident(), 0u);
+
+	// the links built as rows are those of the map
+	for (const std::string model : {"poisson", "over-dispersed", "constant"}) {
+		Wiring_parameters wiring;
+		*_RNG = RandomNumbers(31);
+		Network mapped(300, "FS:0.2", 0.1, 20, model, 5);
+		wiring.rows = true;
+		*_RNG = RandomNumbers(31);
+		Network direct(300, "FS:0.2", 0.1, 20, model, 5, wiring);
+		EXPECT_EQ(mapped.get_links(), direct.get_links()) << model;
+		EXPECT_EQ(mapped.update(), direct.update()) << model;
+	}
+
+	// a limit between the two builds selects the rows, a lower one is refused before building
+	const char* tight[] = {"NeuronNetwork", "-n", "2000", "-c", "100", "-t", "2", "-o", "", "-s", "", "-p", "", "--mem-limit", "8"};
+	testing::internal::CaptureStdout();
+	Simulation(15, const_cast<char**>(tight)).run();
+	std::string printed = testing::internal::GetCapturedStdout();
+	EXPECT_NE(std::string::npos, printed.find("built directly as rows")) << printed;
+	EXPECT_NE(std::string::npos, printed.find("measured peak")) << printed;
+	std::string telemetry = "/tmp/nn_footprint_" + std::to_string(getpid());
+	const char* quiet[] = {"NeuronNetwork", "-n", "200", "-t", "2", "-o", "", "-s", "", "-p", "", "-e", telemetry.c_str()};
+	testing::internal::CaptureStdout();
+	Simulation(13, const_cast<char**>(quiet)).run();
+	printed = testing::internal::GetCapturedStdout();
+	EXPECT_EQ(std::string::npos, printed.find("measured peak")) << printed;	// the calibration goes to the telemetry
+	std::ifstream written(telemetry);
+	std::string line, last;
+	while (std::getline(written, line)) last = line;
+	EXPECT_EQ(0u, last.find("# memory")) << last;
+	std::remove(telemetry.c_str());
+	const char* refused[] = {"NeuronNetwork", "-n", "2000", "-c", "100", "-t", "2", "-o", "", "-s", "", "-p", "", "--mem-limit", "2"};
+	EXPECT_EXIT(Simulation(15, const_cast<char**>(refused)), testing::ExitedWithCode(EXIT_FAILURE), "");
+	std::string links = "/tmp/nn_footprint_links_" + std::to_string(getpid());
+	const char* fitting[] = {"NeuronNetwork", "-n", "2000", "-c", "100", "-t", "2", "-o", "", "-s", "", "-p", "", "--mem-limit", "2",
+							 "--stream", links.c_str(), "--stream-memory", "1"};
+	testing::internal::CaptureStdout();
+	Simulation(19, const_cast<char**>(fitting)).run();					// the links streamed as they are drawn fit
+	printed = testing::internal::GetCapturedStdout();
+	EXPECT_NE(std::string::npos, printed.find("measured peak")) << printed;
+}
+
+TEST(Simulation, branches) {
+	// the burn-in is the beginning of the run, without output
+	const char* whole[] = {"NeuronNetwork", "-n", "100", "-t", "30", "-o", "burn_whole.txt", "-s", "", "-p", ""};
+	const char* burnt[] = {"NeuronNetwork", "-n", "100", "-t", "10", "-o", "burn_end.txt", "-s", "", "-p", "", "--burn-in", "20"};
+	*_RNG = RandomNumbers(12);
+	Simulation(11, const_cast<char**>(whole)).run();
+	*_RNG = RandomNumbers(12);
+	Simulation(13, const_cast<char**>(burnt)).run();
+	std::ifstream long_run("burn_whole.txt"), short_run("burn_end.txt");
+	std::string a, b;
+	for (int t(1); t<=20; ++t) std::getline(long_run, a);
+	for (int t(1); t<=10; ++t) {
+		ASSERT_TRUE(std::getline(long_run, a) and std::getline(short_run, b));
+		EXPECT_EQ(a.substr(a.find(' ')), b.substr(b.find(' '))) << "step " << t;
+		EXPECT_EQ(std::to_string(t), b.substr(0, b.find(' ')));
+	}
+	EXPECT_FALSE(std::getline(short_run, b));
+
+	// each branch continues the burn-in with its own seed and stimulus, the steps of the stimulus counting from the burn-in
+	std::string strong = "/tmp/nn_branch_strong_" + std::to_string(getpid()), none = "/tmp/nn_branch_none_" + std::to_string(getpid());
+	std::ofstream(strong) << "pulse 0-199 1 20 100\n";
+	std::ofstream(none) << "pulse 0-0 1 1 0\n";
+	std::string stimuli = strong + "," + none;
+	const char* branched[] = {"NeuronNetwork", "-n", "200", "-t", "20", "-o", "branch_out.txt", "-s", "branch_sample.txt", "-p", "",
+							  "--burn-in", "50", "--branches", "2", "--stimulus", stimuli.c_str()};
+	Simulation(17, const_cast<char**>(branched)).run();
+	std::ifstream missing("branch_out.txt");
+	EXPECT_FALSE(missing.is_open());
+	std::vector<size_t> spikes;
+	for (int k(0); k<2; ++k) {
+		std::ifstream raster("branch_out.txt.branch" + std::to_string(k)), sample("branch_sample.txt.branch" + std::to_string(k));
+		size_t lines(0), ones(0);
+		while (std::getline(raster, a)) {
+			++lines;
+			ones += std::count(a.begin() + a.find(' '), a.end(), '1');
+		}
+		EXPECT_EQ(20u, lines);
+		spikes.push_back(ones);
+		lines = 0;
+		while (std::getline(sample, a)) ++lines;
+		EXPECT_EQ(21u, lines);
+		std::remove(("branch_out.txt.branch" + std::to_string(k)).c_str());
+		std::remove(("branch_sample.txt.branch" + std::to_string(k)).c_str());
+	}
+	EXPECT_GT(spikes[0], 2*spikes[1]);
+	const char* mismatched[] = {"NeuronNetwork", "-n", "200", "--branches", "3", "--stimulus", stimuli.c_str()};
+	EXPECT_EXIT(Simulation(7, const_cast<char**>(mismatched)), testing::ExitedWithCode(EXIT_FAILURE), "");
+	const char* missing_stimulus[] = {"NeuronNetwork", "-n", "200", "--burn-in", "50", "--stimulus", "/tmp/nn_no_stimulus"};	// refused before the burn-in
+	EXPECT_EXIT(Simulation(7, const_cast<char**>(missing_stimulus)), testing::ExitedWithCode(EXIT_FAILURE), "");
+	for (const std::string name : {"burn_whole.txt", "burn_end.txt", strong.c_str(), none.c_str()}) std::remove(name.c_str());
+}
+
+TEST(Autotuner, choice) {
+	// the push engine makes the same sums as the pull engine, with the edits and reordered neurons too
+	*_RNG = RandomNumbers(23);
+	Network pulled(1500, "FS:0.2", 0.2, 40, "poisson", 5);
+	*_RNG = RandomNumbers(23);
+	Network pushed(1500, "FS:0.2", 0.2, 40, "poisson", 5);
+	pushed.set_engine("push");
+	pulled.set_seed(5);
+	pushed.set_seed(5);
+	for (int t(0); t<60; ++t) {
+		if (t == 20) {
+			for (Network* net : {&pulled, &pushed}) {
+				net->set_intensity(10, net->find_neighbours(10)[0].first, 30);
+				net->remove_neuron(11);
+				net->add_link(12, 400, 20);
+			}
+		}
+		if (t == 40) {
+			pulled.reorder("rcm");
+			pushed.reorder("rcm");
+		}
+		EXPECT_EQ(pulled.update(), pushed.update()) << t;
+		EXPECT_EQ(Validation::state_hash(pulled), Validation::state_hash(pushed)) << t;
+	}
+	EXPECT_GT(pushed.topology_bytes(), pulled.topology_bytes());
+
+	// the tuner leaves the network in its initial state, with the fastest configuration equivalent to the baseline
+	*_RNG = RandomNumbers(24);
+	Network tuned(2000, "FS:0.2", 0.2, 30, "poisson", 5);
+	*_RNG = RandomNumbers(24);
+	Network twin(2000, "FS:0.2", 0.2, 30, "poisson", 5);
+	for (int t(0); t<5; ++t) tuned.update();
+	RandomNumbers before(*_RNG);
+	Autotuner tuner(0.5, {0.0, 0.0, 0.0}, 2);
+	Configuration chosen = tuner.tune(tuned);
+	EXPECT_EQ(before.uniform_int(0, 1000000), _RNG->uniform_int(0, 1000000));	// the trials draw their own noise
+	EXPECT_EQ(0u, tuned.get_steps());
+	const std::vector<Autotuner::Trial>& trials = tuner.get_trials();
+	ASSERT_GE(trials.size(), 4u);
+	EXPECT_EQ("pull 1 stealing none", trials[0].configuration.to_string());
+	bool found(false), reordered(false);
+	for (const auto& trial : trials) {
+		EXPECT_GE(trial.steps, Autotuner::Min_steps);
+		EXPECT_EQ(trials[0].steps, trial.steps);
+		if (trial.configuration.layout == "none") EXPECT_TRUE(trial.equivalent) << trial.configuration.to_string();
+		else reordered = reordered or not trial.equivalent;			// the sums are made in another order
+		if (trial.configuration.to_string() == chosen.to_string()) found = trial.equivalent;
+	}
+	EXPECT_TRUE(found);
+	EXPECT_TRUE(reordered);
+	Validation same(tuned, twin, {1e-9, 1e-9, 1e-9});
+	for (int t(0); t<30; ++t) same.update();
+	EXPECT_FALSE(same.diverged());
+
+	// the choices are kept by signature, the last one read
+	std::string cache = "/tmp/nn_autotune_" + std::to_string(getpid());
+	Configuration read;
+	EXPECT_FALSE(Autotuner::lookup(cache, "n=10", read));
+	EXPECT_TRUE(Autotuner::store(cache, "n=10", {"push", 1, true, "none"}));
+	EXPECT_TRUE(Autotuner::store(cache, "n=100", {"pull", 4, false, "rcm"}));
+	EXPECT_TRUE(Autotuner::store(cache, "n=10", {"pull", 2, true, "degree"}));
+	ASSERT_TRUE(Autotuner::lookup(cache, "n=100", read));
+	EXPECT_EQ("pull 4 static rcm", read.to_string());
+	ASSERT_TRUE(Autotuner::lookup(cache, "n=10", read));
+	EXPECT_EQ("pull 2 stealing degree", read.to_string());
+	EXPECT_FALSE(Autotuner::lookup(cache, "n=1", read));
+	EXPECT_THROW(Configuration::parse("pull 0 stealing none"), std::runtime_error);
+	std::remove(cache.c_str());
+
+	// the run tunes the network once, then reads the choice
+	const char* autotuned[] = {"NeuronNetwork", "-n", "500", "-t", "5", "-o", "", "-s", "", "-p", "", "--autotune", "0.2", "--autotune-cache", cache.c_str()};
+	testing::internal::CaptureStdout();
+	Simulation(15, const_cast<char**>(autotuned)).run();
+	Simulation(15, const_cast<char**>(autotuned)).run();
+	std::string printed = testing::internal::GetCapturedStdout();
+	EXPECT_NE(std::string::npos, printed.find("ms a step")) << printed;
+	EXPECT_NE(std::string::npos, printed.find("read from " + cache)) << printed;
+	const char* compressed[] = {"NeuronNetwork", "-n", "500", "--autotune", "1", "--compress", "q8"};
+	EXPECT_EXIT(Simulation(7, const_cast<char**>(compressed)), testing::ExitedWithCode(EXIT_FAILURE), "");
+	std::remove(cache.c_str());
+}
+
+TEST(Counters, phases) {
+	Counters counters;
+	Counts first = counters.read();
+	volatile double sum(0.0);
+	for (int k(0); k<1000000; ++k) sum = sum + k;
+	Counts spent = counters.read() - first;
+	EXPECT_GT(spent.seconds, 0.0);
+	if (counters.available()) {
+		EXPECT_GT(spent.instructions, 1000000u);
+		EXPECT_GT(spent.cycles, 0u);
+	}
+	else {															// e.g. in a container: the wall time only
+		EXPECT_FALSE(counters.why().empty());
+		EXPECT_EQ(0u, spent.instructions);
+	}
+
+	Network net(1000, "FS:0.2", 0.1, 30, "poisson", 5);
+	EXPECT_TRUE(net.get_phase_counts().empty());
+	net.measure_phases(true);
+	for (int t(0); t<10; ++t) {
+		auto begin = std::chrono::steady_clock::now();
+		net.update();
+		double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		ASSERT_EQ(Network::Phases.size(), net.get_phase_counts().size());
+		double phases(0.0);
+		for (const auto& counts : net.get_phase_counts()) {
+			EXPECT_GE(counts.seconds, 0.0);
+			phases += counts.seconds;
+		}
+		EXPECT_LE(phases, wall);
+	}
+	net.measure_phases(false);
+	EXPECT_TRUE(net.get_phase_counts().empty());
+
+	// a column per phase (and per event, with counters) in the telemetry, and their sums at the end
+	const char* measured[] = {"NeuronNetwork", "-n", "200", "-t", "20", "-o", "", "-s", "", "-p", "", "-e", "counters_telemetry.txt", "--counters"};
+	Simulation(14, const_cast<char**>(measured)).run();
+	std::ifstream telemetry("counters_telemetry.txt");
+	std::string line, header;
+	size_t steps(0), totals(0), columns = 3 + Network::Phases.size()*(counters.available() ? 5 : 1);
+	while (std::getline(telemetry, line)) {
+		if (line.compare(0, 8, "# phase ") == 0) ++totals;
+		else if (line.compare(0, 4, "Step") == 0) header = line;
+		else if (line[0] != '#') {
+			++steps;
+			EXPECT_EQ(columns, (size_t)std::count(line.begin(), line.end(), '\t') + 1) << line;
+		}
+	}
+	EXPECT_EQ(20u, steps);
+	EXPECT_EQ(Network::Phases.size(), totals);
+	EXPECT_NE(std::string::npos, header.find("integrate(ms)")) << header;
+	EXPECT_EQ(counters.available(), header.find("integrate instructions") != std::string::npos) << header;
+	std::remove("counters_telemetry.txt");
+	const char* untold[] = {"NeuronNetwork", "-n", "200", "--counters"};
+	EXPECT_EXIT(Simulation(4, const_cast<char**>(untold)), testing::ExitedWithCode(EXIT_FAILURE), "");
+}
+
+TEST(Network, allocations) {
+	if (not AllocationCounter::enabled()) GTEST_SKIP() << "allocations are only counted in debug builds";
+	Network net(200, "FS:0.3", 0.1, 20, "poisson", 5);
+	for (int t(0); t<5; ++t) net.update();								// warm-up
+	size_t before = AllocationCounter::count();
+	size_t spikes = 0;
+	for (int t(0); t<100; ++t) spikes += net.update().size();
+	EXPECT_EQ(before, AllocationCounter::count());
+	EXPECT_GT(spikes, 0u);
+}
+
+TEST(Simulation, allocations) {
+	if (not AllocationCounter::enabled()) GTEST_SKIP() << "allocations are only counted in debug builds";
+	std::string raster = "/tmp/nn_alloc_" + std::to_string(getpid());
+	const char* args[] = {"NeuronNetwork", "-n", "200", "-t", "100", "-o", raster.c_str(), "-s", "", "-p", ""};
+	{
+		Simulation sim(11, const_cast<char**>(args));
+		for (int t(1); t<=5; ++t) sim.step(t);							// warm-up
+		size_t before = AllocationCounter::count();
+		for (int t(6); t<=100; ++t) sim.step(t);
+		EXPECT_EQ(before, AllocationCounter::count());
+	}
+	std::remove(raster.c_str());
+}
+
+TEST(Library, interface) {
+	nn_parameters params;
+	nn_default_parameters(&params);
+	params.number = 50;
+	params.model = "constant";
+	params.connectivity = 5;
+	nn_network *net = nn_create(&params);
+	ASSERT_NE(nullptr, net);
+	EXPECT_EQ(50u, nn_size(net));
+
+	nn_state_view state = nn_state(net);
+	EXPECT_EQ(50u, state.size);
+	EXPECT_EQ(NN_OK, nn_set_potential(net, 3, 35.0));
+	EXPECT_EQ(35.0, *(const double*)((const char*)state.potential + 3*state.stride));
+	EXPECT_NE(NN_OK, nn_set_potential(net, 50, 35.0));
+
+	EXPECT_EQ(NN_OK, nn_step(net, 20));
+	EXPECT_EQ(20u, nn_time(net));
+	std::vector<nn_spike> spikes(nn_spike_count(net));
+	EXPECT_EQ(spikes.size(), nn_read_spikes(net, spikes.data(), spikes.size()));
+	ASSERT_FALSE(spikes.empty());
+	EXPECT_EQ(3u, spikes[0].neuron);									// neuron 3 fires at the first step
+	EXPECT_EQ(1u, spikes[0].step);
+	for (size_t k(1); k<spikes.size(); ++k) EXPECT_LE(spikes[k-1].step, spikes[k].step);
+	EXPECT_EQ(1u, nn_read_spikes(net, spikes.data(), 1));
+	nn_destroy(net);
+
+	params.integrator = "unknown";
+	EXPECT_EQ(nullptr, nn_create(&params));
+	EXPECT_STRNE("", nn_last_error());
+
+	EXPECT_GT(closed_loop_controller(50), 0);
+}
+
+TEST(SpikeRing, publish) {
+	std::string name = "/nn_test_ring_" + std::to_string(getpid());
+	SpikeRing producer = SpikeRing::create(name, 4, 10, 2);
+	SpikeRing consumer = SpikeRing::attach(name);
+	EXPECT_EQ(4u, consumer.slots());
+	EXPECT_EQ(10u, consumer.neurons());
+
+	SpikeRing::Message message;
+	EXPECT_FALSE(consumer.peek(message));
+	producer.publish(1, {2, 7}, {-65., -13., 1., -60., -12., 2.});
+	ASSERT_TRUE(consumer.peek(message));
+	EXPECT_EQ(1u, message.step);
+	ASSERT_EQ(2u, message.spikes.size());
+	EXPECT_EQ(7u, message.spikes[1]);
+	ASSERT_EQ(6u, message.state.size());
+	EXPECT_EQ(-60., message.state[3]);
+	EXPECT_TRUE(consumer.valid(message));
+	consumer.advance();
+
+	for (uint64_t t(2); t<=8; ++t) producer.publish(t, {(size_t)t}, {});	// more steps than slots: 3 are lost
+	ASSERT_TRUE(consumer.peek(message));
+	EXPECT_EQ(5u, message.step);
+	EXPECT_EQ(3u, consumer.overruns());
+	producer.publish(9, {}, {});										// overwrites the message being read
+	EXPECT_FALSE(consumer.valid(message));
+	EXPECT_EQ(4u, consumer.overruns());
+	EXPECT_FALSE(consumer.closed());
+}
+
+TEST(SpikeRing, processes) {
+	std::string name = "/nn_test_ring_proc_" + std::to_string(getpid());
+	const uint64_t steps = 20000;
+	SpikeRing* producer = new SpikeRing(SpikeRing::create(name, 64, 100, 1));
+	int ready[2];
+	ASSERT_EQ(0, pipe(ready));
+	pid_t child = fork();
+	ASSERT_GE(child, 0);
+	if (child == 0) {
+		// consumer process: every message read must be consistent, and read + lost must cover all the steps
+		SpikeRing consumer = SpikeRing::attach(name);
+		char c = 1;
+		if (write(ready[1], &c, 1) != 1) _exit(2);						// the producer starts once the consumer is attached
+		SpikeRing::Message message;
+		uint64_t read = 0, last = 0;
+		bool ok = true;
+		while (true) {
+			if (not consumer.peek(message)) {
+				if (consumer.closed() and not consumer.peek(message)) break;
+				continue;
+			}
+			uint64_t step = message.step;
+			bool consistent = (message.spikes.size() == step % 100 and (message.spikes.empty() or message.spikes[0] == step % 100));
+			if (consumer.valid(message)) {
+				ok = ok and consistent and step > last;
+				last = step;
+				++read;
+			}
+			consumer.advance();
+		}
+		_exit((ok and read > 0 and read + consumer.overruns() == steps) ? 0 : 1);
+	}
+	char c;
+	ASSERT_EQ(1, read(ready[0], &c, 1));
+	std::vector<size_t> spikes;
+	spikes.reserve(100);
+	for (uint64_t t(1); t<=steps; ++t) {
+		spikes.assign(t % 100, t % 100);
+		producer->publish(t, spikes, {0., 0., 0.});
+	}
+	delete producer;													// closes the stream
+	int status = 0;
+	waitpid(child, &status, 0);
+	EXPECT_TRUE(WIFEXITED(status));
+	EXPECT_EQ(0, WEXITSTATUS(status));
+}
+
 int main(int argc, char **argv) {
+    _RNG = new RandomNumbers(23948710923);
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
 }
@@ -0,0 +1,40 @@
+#include "Shards.h"
+#include "constants.h"
+#include <iostream>
+
+/*
+ * Merges the shards written by NeuronNetwork --shards K (outfile.txt.shard0, outfile.txt.shard1...) into the single file
+ * the simulation writes without shards. The lines of the shards are read together and glued, step by step.
+ */
+int main(int argc, char **argv) {
+	try {
+		TCLAP::CmdLine cmd("Merger of the NeuronNetwork output shards");
+		TCLAP::ValueArg<std::string> input("i", "input", "name of the sharded file, without .shardK", true, "", "string");
+		cmd.add(input);
+		TCLAP::ValueArg<std::string> output("o", "output", "merged file, the standard output by default", false, "", "string");
+		cmd.add(output);
+		cmd.parse(argc, argv);
+
+		ShardReader reader(input.getValue());
+		std::ofstream file;
+		if (output.getValue().length()) {
+			file.open(output.getValue());
+			if (not file.is_open()) throw OUTPUT_ERROR("Cannot create " + output.getValue() + ".");
+		}
+		std::ostream& out = (file.is_open() ? file : std::cout);
+		std::string line;
+		while (reader.next(line)) {
+			out.write(line.data(), line.size());
+			out.put('\n');
+		}
+		out.flush();
+		if (not out) throw OUTPUT_ERROR("Cannot write the merged file.");
+	} catch (TCLAP::ArgException &e) {
+		std::cerr << e.error() << " for argument " << e.argId() << std::endl;
+		return 10;
+	} catch (SimulError &e) {
+		std::cerr << e.what() << std::endl;
+		return e.value();
+	}
+	return 0;
+}
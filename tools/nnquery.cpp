@@ -0,0 +1,156 @@
+#include "SpikeArchive.h"
+#include "constants.h"
+#include <iostream>
+#include <sstream>
+
+/*
+ * Queries on the spike archive written by NeuronNetwork --archive FILE, reading only the parts of the file they need.
+ * The neurons are selected by a range of ids (--neurons 1000-1999) and/or a type (--type FS), the steps by --from and --to.
+ * Prints the spikes ("step neuron" lines), or their number (--count), the mean firing rate of the neurons (--rate),
+ * or the number of spikes of each neuron (--per-neuron). --info describes the archive.
+ *
+ * The spikes of a few neurons are read from their postings (--archive-postings), those of many neurons from the blocks of
+ * the window; the number of spikes of all the neurons is taken from the index, except for the blocks cut by the window.
+ */
+
+namespace {
+typedef std::vector<std::pair<size_t, size_t>> Ranges;
+
+Ranges parse_range(const std::string& text, const size_t& neurons)
+{
+	if (text.empty()) return Ranges{{0, neurons}};
+	std::istringstream range(text);
+	size_t first, last;
+	char dash;
+	if (not (range >> first)) throw CFILE_ERROR("Invalid range of neurons " + text + ".");
+	if (not (range >> dash >> last)) last = first;
+	else if (dash != '-' or last < first) throw CFILE_ERROR("Invalid range of neurons " + text + ".");
+	if (first >= neurons) throw CFILE_ERROR("The range of neurons " + text + " is beyond the " + std::to_string(neurons) + " neurons of the archive.");
+	return Ranges{{first, std::min(last + 1, neurons)}};
+}
+
+/*!
+ * Ranges of neurons both in \p a and \p b, both sorted
+ */
+Ranges intersect(const Ranges& a, const Ranges& b)
+{
+	Ranges both;
+	for (const auto& x : a) {
+		for (const auto& y : b) {
+			size_t first = std::max(x.first, y.first), last = std::min(x.second, y.second);
+			if (first < last) both.push_back({first, last});
+		}
+	}
+	return both;
+}
+}
+
+int main(int argc, char **argv) {
+	try {
+		TCLAP::CmdLine cmd("Queries on a NeuronNetwork spike archive");
+		TCLAP::ValueArg<std::string> file("a", "archive", "spike archive written by NeuronNetwork --archive", true, "", "string");
+		cmd.add(file);
+		TCLAP::SwitchArg info("", "info", "describes the archive", false);
+		cmd.add(info);
+		TCLAP::ValueArg<long> from("", "from", "first step of the window", false, 1, "int");
+		cmd.add(from);
+		TCLAP::ValueArg<long> to("", "to", "last step of the window, the last step of the run by default", false, 0, "int");
+		cmd.add(to);
+		TCLAP::ValueArg<std::string> neurons("", "neurons", "range of neuron ids, e.g. 1000-1999", false, "", "string");
+		cmd.add(neurons);
+		TCLAP::ValueArg<std::string> type("", "type", "type of the neurons (RS, IB, FS, LTS, CH)", false, "", "string");
+		cmd.add(type);
+		TCLAP::SwitchArg count("", "count", "prints the number of spikes", false);
+		cmd.add(count);
+		TCLAP::SwitchArg rate("", "rate", "prints the mean firing rate of the neurons (Hz)", false);
+		cmd.add(rate);
+		TCLAP::SwitchArg per_neuron("", "per-neuron", "prints the number of spikes of each neuron", false);
+		cmd.add(per_neuron);
+		TCLAP::SwitchArg verbose("v", "verbose", "tells how the query was answered and how many bytes it read", false);
+		cmd.add(verbose);
+		cmd.parse(argc, argv);
+
+		const SpikeArchive archive = SpikeArchive::open(file.getValue());
+		if (info.getValue()) {
+			std::cout << "neurons\t" << archive.neurons() << "\nsteps\t" << archive.steps() << "\ntime step(ms)\t" << archive.time_step()
+					  << "\nblocks\t" << archive.blocks().size() << " of " << archive.block_steps() << " steps"
+					  << "\nspikes\t" << archive.count(1, archive.steps()) << "\npostings\t" << (archive.has_postings() ? "yes" : "no") << '\n';
+			for (const auto& t : archive.types()) std::cout << "type\t" << t.name << '\t' << t.first << '-' << t.last - 1 << '\n';
+			return 0;
+		}
+
+		size_t first = std::max<long>(from.getValue(), 1), last = (to.getValue() > 0 ? (size_t)to.getValue() : archive.steps());
+		Ranges selected = parse_range(neurons.getValue(), archive.neurons());
+		if (type.getValue().length()) {
+			Ranges typed;
+			for (const auto& t : archive.types()) if (type.getValue() == t.name) typed.push_back({t.first, t.last});
+			if (archive.types().empty()) throw CFILE_ERROR("The archive does not record the types of the neurons.");
+			selected = intersect(selected, typed);
+		}
+		size_t chosen(0);
+		for (const auto& range : selected) chosen += range.second - range.first;
+		bool all = (chosen == archive.neurons());
+
+		std::string method;
+		size_t bytes(0), spikes(0);
+		std::vector<size_t> counts(archive.neurons(), 0);
+		std::vector<std::pair<size_t, size_t>> listed;
+		bool aggregate = count.getValue() or rate.getValue();
+		if (all and aggregate and not per_neuron.getValue()) {				// whole blocks are counted from the index
+			method = "index";
+			spikes = archive.count(first, last);
+			bytes = archive.blocks().size()*sizeof(SpikeArchive::Block);
+			for (const auto& b : archive.blocks()) {									// blocks cut by the window are decoded
+				size_t end = b.first_step + b.steps - 1;
+				if ((b.first_step < first and end >= first) or (b.first_step <= last and end > last)) bytes += archive.window_bytes(b.first_step, end);
+			}
+		}
+		else {
+			size_t posting_bytes(0), window_bytes = archive.window_bytes(first, last);
+			for (const auto& range : selected) for (size_t n(range.first); n<range.second; ++n) posting_bytes += archive.posting_bytes(n);
+			if (archive.has_postings() and posting_bytes + (chosen + 1)*sizeof(uint64_t) < window_bytes) {
+				method = "postings";
+				bytes = posting_bytes + (chosen + 1)*sizeof(uint64_t);
+				for (const auto& range : selected) {
+					for (size_t n(range.first); n<range.second; ++n) {
+						archive.read_neuron(n, first, last, [&](const size_t& step) {
+							++counts[n];
+							if (not aggregate and not per_neuron.getValue()) listed.push_back({step, n});
+						});
+					}
+				}
+				std::sort(listed.begin(), listed.end());
+			}
+			else {
+				method = "blocks";
+				bytes = window_bytes;
+				std::vector<char> mask(archive.neurons(), 0);
+				for (const auto& range : selected) std::fill(mask.begin() + range.first, mask.begin() + range.second, 1);
+				archive.read(first, last, [&](const size_t& step, const size_t& n) {
+					if (not mask[n]) return;
+					++counts[n];
+					if (not aggregate and not per_neuron.getValue()) listed.push_back({step, n});
+				});
+			}
+			for (const auto& c : counts) spikes += c;
+		}
+
+		if (per_neuron.getValue()) {
+			for (const auto& range : selected) for (size_t n(range.first); n<range.second; ++n) std::cout << n << '\t' << counts[n] << '\n';
+		}
+		else if (count.getValue()) std::cout << spikes << '\n';
+		else if (rate.getValue()) {
+			double seconds = (last >= first ? last - first + 1 : 0)*archive.time_step()/1000.0;
+			std::cout << (chosen and seconds > 0 ? spikes/(chosen*seconds) : 0.0) << '\n';
+		}
+		else for (const auto& spike : listed) std::cout << spike.first << ' ' << spike.second << '\n';
+		if (verbose.getValue()) std::cerr << "answered from the " << method << ", " << bytes << " bytes read" << std::endl;
+	} catch (TCLAP::ArgException &e) {
+		std::cerr << e.error() << " for argument " << e.argId() << std::endl;
+		return 10;
+	} catch (SimulError &e) {
+		std::cerr << e.what() << std::endl;
+		return e.value();
+	}
+	return 0;
+}
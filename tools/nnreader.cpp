@@ -0,0 +1,47 @@
+#include "SpikeRing.h"
+#include "constants.h"
+#include <chrono>
+#include <thread>
+
+/*
+ * Live consumer of the shared memory ring published by NeuronNetwork --shm NAME.
+ * Prints one line per step: the step number followed by the firing neurons, and optionally
+ * the state of the sample neurons. Runs until the simulation closes the stream.
+ */
+int main(int argc, char **argv) {
+	try {
+		TCLAP::CmdLine cmd("Reader of the NeuronNetwork shared memory ring");
+		TCLAP::ValueArg<std::string> name("r", "ring", "name of the shared memory ring", true, "", "string");
+		cmd.add(name);
+		TCLAP::SwitchArg state("", "state", "also print the state of the sample neurons", false);
+		cmd.add(state);
+		cmd.parse(argc, argv);
+
+		SpikeRing ring = SpikeRing::attach(name.getValue());
+		SpikeRing::Message message;
+		for (;;) {
+			if (not ring.peek(message)) {
+				if (ring.closed()) break;
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+				continue;
+			}
+			std::string line = std::to_string(message.step);
+			for (const auto& n : message.spikes) line += " " + std::to_string(n);
+			if (state.getValue()) {
+				line += "\t|";
+				for (const auto& v : message.state) line += " " + std::to_string(v);
+			}
+			if (ring.valid(message)) std::cout << line << '\n';		// the line is only printed if the slot was not overwritten
+			ring.advance();
+		}
+		std::cout.flush();
+		std::cerr << "overruns: " << ring.overruns() << std::endl;
+	} catch (TCLAP::ArgException &e) {
+		std::cerr << e.error() << " for argument " << e.argId() << std::endl;
+		return 10;
+	} catch (SimulError &e) {
+		std::cerr << e.what() << std::endl;
+		return e.value();
+	}
+	return 0;
+}